@@ -0,0 +1,77 @@
+/*
+* Signal-to-signal chain benchmarks: recursive emission through private_invoke of every
+* connected signal compared with flattened emission (signal::set_flattening).
+*/
+
+#include "harness.hpp"
+#include "slib/signals.hpp"
+#include <vector>
+#include <memory>
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    int SINK = 0;
+
+    int consume(int a)
+    {
+        return SINK += a;
+    }
+
+    typedef slib::signal<int(int)> signal_type;
+    typedef slib::slot<int(int)> slot_type;
+
+    const unsigned int DEPTHS[] = {1, 3, 5};
+    const unsigned int SLOTS_PER_SIGNAL = 4;
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+void benchmark_chain()
+{
+    bench::print_group("chain");
+
+    char name[64];
+
+    for (auto depth : DEPTHS)
+    {
+        for (int flat = 0; flat < 2; ++flat)
+        {
+            // root -> signal -> ... -> signal, every signal has SLOTS_PER_SIGNAL slots
+            std::vector<std::unique_ptr<signal_type> > signals;
+            std::vector<std::unique_ptr<slot_type> > slots;
+            for (unsigned int i = 0; i < depth; ++i)
+            {
+                signals.emplace_back(new signal_type());
+                if (i != 0)
+                {
+                    slib::connect(*signals[i - 1], *signals[i]);
+                }
+
+                for (unsigned int j = 0; j < SLOTS_PER_SIGNAL; ++j)
+                {
+                    slots.emplace_back(new slot_type());
+                    slots.back()->bind<consume>();
+                    signals[i]->connect(*slots.back());
+                }
+            }
+
+            signals.front()->set_flattening(flat != 0);
+
+            const unsigned long long emits = 2000000ULL * bench::global_options().scale;
+            const signal_type& root = *signals.front();
+
+            snprintf(name, sizeof(name), "chain/%s/%u", flat != 0 ? "flat" : "recursive", depth);
+            bench::measure(name, emits, slots.size(), [&]()
+            {
+                for (unsigned long long i = 0; i < emits; ++i)
+                {
+                    root(static_cast<int>(i));
+                }
+            });
+        }
+    }
+}
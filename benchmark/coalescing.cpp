@@ -0,0 +1,81 @@
+/*
+* Coalescing benchmarks: a burst of emissions per frame delivered to every slot (plain signal)
+* compared with the same burst stored by coalescing_signal and delivered once by flush().
+*/
+
+#include "harness.hpp"
+#include "slib/coalescing_signal.hpp"
+#include <vector>
+#include <memory>
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    unsigned long long SINK = 0;
+
+    void refresh(double _value)
+    {
+        SINK += static_cast<unsigned long long>(_value);
+    }
+
+    typedef slib::signal<void(double)> signal_type;
+    typedef slib::coalescing_signal<void(double)> coalescing_type;
+    typedef slib::slot<void(double)> slot_type;
+
+    const unsigned int SLOTS = 16;
+    const unsigned int BURSTS[] = {1, 10, 100, 1000};
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+void benchmark_coalescing()
+{
+    bench::print_group("coalescing");
+
+    signal_type plain;
+    coalescing_type coalescing;
+    std::vector<std::unique_ptr<slot_type> > slots;
+    for (unsigned int i = 0; i < SLOTS; ++i)
+    {
+        slots.emplace_back(new slot_type());
+        slots.back()->bind<refresh>();
+        plain.connect(*slots.back());
+        coalescing.connect(*slots.back());
+    }
+
+    char name[64];
+
+    for (auto burst : BURSTS)
+    {
+        const unsigned long long frames = 2000000ULL * bench::global_options().scale / burst;
+
+        snprintf(name, sizeof(name), "coalescing/plain/burst%u", burst);
+        bench::measure(name, frames * burst, 1, [&]()
+        {
+            for (unsigned long long f = 0; f < frames; ++f)
+            {
+                for (unsigned int i = 0; i < burst; ++i)
+                {
+                    plain(static_cast<double>(i));
+                }
+            }
+        });
+
+        snprintf(name, sizeof(name), "coalescing/flush/burst%u", burst);
+        bench::measure(name, frames * burst, 1, [&]()
+        {
+            for (unsigned long long f = 0; f < frames; ++f)
+            {
+                for (unsigned int i = 0; i < burst; ++i)
+                {
+                    coalescing(static_cast<double>(i));
+                }
+
+                coalescing.flush();
+            }
+        });
+    }
+}
@@ -0,0 +1,78 @@
+/*
+* Connection benchmarks: wiring of many slots to a thread-safe signal by sequential
+* connect()/disconnect() calls compared with bulk range connect()/disconnect().
+*/
+
+#include "harness.hpp"
+#include "slib/signals.hpp"
+#include <vector>
+#include <memory>
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    int SINK = 0;
+
+    int consume(int a)
+    {
+        return SINK += a;
+    }
+
+    typedef slib::signal<int(int)> signal_type;
+    typedef slib::slot<int(int)> slot_type;
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+void benchmark_connect()
+{
+    bench::print_group("connect");
+
+    const unsigned int number = 100000 * bench::global_options().scale;
+
+    std::vector<std::unique_ptr<slot_type> > slots;
+    std::vector<slot_type*> pointers;
+    for (unsigned int i = 0; i < number; ++i)
+    {
+        slots.emplace_back(new slot_type(true));
+        slots.back()->bind<consume>();
+        pointers.push_back(slots.back().get());
+    }
+
+    signal_type sgnl;
+    sgnl.set_threadsafe(true);
+
+    bench::measure("connect/sequential", number, 1, [&]()
+    {
+        for (auto slt : pointers)
+        {
+            sgnl.connect(*slt);
+        }
+
+        sgnl.disconnect();
+    });
+
+    bench::measure("connect/bulk", number, 1, [&]()
+    {
+        sgnl.connect(pointers.begin(), pointers.end());
+        sgnl.disconnect();
+    });
+
+    bench::measure("disconnect/sequential", number, 1, [&]()
+    {
+        sgnl.connect(pointers.begin(), pointers.end());
+        for (auto slt : pointers)
+        {
+            sgnl.disconnect(*slt);
+        }
+    });
+
+    bench::measure("disconnect/bulk", number, 1, [&]()
+    {
+        sgnl.connect(pointers.begin(), pointers.end());
+        sgnl.disconnect(pointers.begin(), pointers.end());
+    });
+}
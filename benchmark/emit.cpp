@@ -0,0 +1,118 @@
+/*
+* Emission benchmarks: intrusive subscriber list of slib::signal at different fan-outs
+* compared with contiguous array of delegates (the best possible memory layout).
+*/
+
+#include "harness.hpp"
+#include "slib/signals.hpp"
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <random>
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    int SINK = 0;
+
+    int consume(int a)
+    {
+        return SINK += a;
+    }
+
+    typedef slib::signal<int(int)> signal_type;
+    typedef slib::slot<int(int)> slot_type;
+    typedef slib::delegate<int(int)> delegate_type;
+
+    const unsigned int FAN_OUTS[] = {1, 8, 64, 512, 4096};
+
+    unsigned long long emits_number(unsigned int _fan_out)
+    {
+        const unsigned long long calls = 4000000ULL * bench::global_options().scale;
+        return calls > _fan_out ? calls / _fan_out : 1;
+    }
+
+    void emit_signal(const signal_type& _signal, unsigned long long _emits)
+    {
+        for (unsigned long long i = 0; i < _emits; ++i)
+        {
+            _signal(static_cast<int>(i));
+        }
+    }
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+void benchmark_emit()
+{
+    printf("\nsubscriber node size: %u bytes", static_cast<unsigned int>(sizeof(slib::util::subscriber<slot_type, signal_type>)));
+    bench::print_group("emit");
+
+    char name[64];
+
+    for (auto fan_out : FAN_OUTS)
+    {
+        const unsigned long long emits = emits_number(fan_out);
+
+        // Slots connected in order of their creation
+        {
+            std::vector<std::unique_ptr<slot_type> > slots;
+            signal_type sgnl;
+            for (unsigned int i = 0; i < fan_out; ++i)
+            {
+                slots.emplace_back(new slot_type());
+                slots.back()->bind<consume>();
+                sgnl.connect(*slots.back());
+            }
+
+            snprintf(name, sizeof(name), "list/ordered/%u", fan_out);
+            bench::measure(name, emits, fan_out, [&]() { emit_signal(sgnl, emits); });
+        }
+
+        // Slots connected in random order (list traversal jumps over memory)
+        {
+            std::vector<std::unique_ptr<slot_type> > slots;
+            for (unsigned int i = 0; i < fan_out; ++i)
+            {
+                slots.emplace_back(new slot_type());
+                slots.back()->bind<consume>();
+            }
+
+            std::vector<slot_type*> order;
+            for (auto& slt : slots)
+            {
+                order.push_back(slt.get());
+            }
+            std::shuffle(order.begin(), order.end(), std::mt19937(fan_out));
+
+            signal_type sgnl;
+            for (auto slt : order)
+            {
+                sgnl.connect(*slt);
+            }
+
+            snprintf(name, sizeof(name), "list/shuffled/%u", fan_out);
+            bench::measure(name, emits, fan_out, [&]() { emit_signal(sgnl, emits); });
+        }
+
+        // Contiguous array of delegates
+        {
+            std::vector<delegate_type> delegates(fan_out, delegate_type::from_function<consume>());
+
+            snprintf(name, sizeof(name), "array/%u", fan_out);
+            bench::measure(name, emits, fan_out, [&]()
+            {
+                for (unsigned long long i = 0; i < emits; ++i)
+                {
+                    for (const auto& d : delegates)
+                    {
+                        d(static_cast<int>(i));
+                    }
+                }
+            });
+        }
+    }
+}
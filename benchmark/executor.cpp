@@ -0,0 +1,314 @@
+/*
+* Executor benchmarks: slib::util::thread_pool (Chase-Lev deques, pooled {delegate, args_list} tasks)
+* compared with a simple executor which keeps std::function closures in one queue protected by
+* mutex and condition_variable.
+*
+*   executor/<pool>/external   tasks are posted by non-worker thread
+*   executor/<pool>/spawn      every task posts two child tasks from worker thread (binary tree)
+*   executor/pool/future       tasks with results: slot::post returns slib::future (pooled shared state)
+*   executor/mutex_cv/promise  the same with std::promise / std::future (shared state is allocated per task)
+*   latency/<pool>/pN          percentile of time between post and start of execution (ns),
+*                              tasks are posted one by one with small pauses
+*/
+
+#include "harness.hpp"
+#include "slib/executors.hpp"
+#include <vector>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    typedef std::chrono::steady_clock clock_type;
+
+    /** \brief Simple executor: one queue, one mutex, one condition variable. */
+    class mutex_executor final
+    {
+        std::deque<std::function<void()> > m_queue;
+        std::mutex                         m_mutex;
+        std::condition_variable             m_cond;
+        std::vector<std::thread>         m_threads;
+        bool                                m_stop;
+
+    public:
+
+        explicit mutex_executor(unsigned int _threads) : m_stop(false)
+        {
+            for (unsigned int i = 0; i < _threads; ++i)
+            {
+                m_threads.emplace_back([this]() { work(); });
+            }
+        }
+
+        ~mutex_executor()
+        {
+            {
+                std::lock_guard<std::mutex> lg(m_mutex);
+                m_stop = true;
+            }
+
+            m_cond.notify_all();
+            for (auto& thread : m_threads)
+            {
+                thread.join();
+            }
+        }
+
+        void post(std::function<void()> _task)
+        {
+            {
+                std::lock_guard<std::mutex> lg(m_mutex);
+                m_queue.push_back(std::move(_task));
+            }
+
+            m_cond.notify_one();
+        }
+
+    private:
+
+        void work()
+        {
+            while (true)
+            {
+                std::function<void()> task;
+
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cond.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+                    if (m_queue.empty())
+                    {
+                        return;
+                    }
+
+                    task = std::move(m_queue.front());
+                    m_queue.pop_front();
+                }
+
+                task();
+            }
+        }
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+
+    std::atomic<unsigned long long> DONE(0);
+    std::vector<unsigned long long> LATENCIES;
+
+    slib::util::thread_pool* POOL = nullptr;
+    mutex_executor*     EXECUTOR = nullptr;
+
+    inline unsigned long long now_ns()
+    {
+        return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count());
+    }
+
+    void count_task(unsigned int)
+    {
+        DONE.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void latency_task(unsigned int _index, unsigned long long _posted)
+    {
+        LATENCIES[_index] = now_ns() - _posted;
+        DONE.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    unsigned int square_task(unsigned int _value)
+    {
+        return _value * _value;
+    }
+
+    void pool_spawn(unsigned int _depth)
+    {
+        DONE.fetch_add(1, std::memory_order_relaxed);
+        if (_depth != 0)
+        {
+            slib::delegate<void(unsigned int)> child;
+            child.bind<pool_spawn>();
+            POOL->post(child, _depth - 1);
+            POOL->post(child, _depth - 1);
+        }
+    }
+
+    void mutex_spawn(unsigned int _depth)
+    {
+        DONE.fetch_add(1, std::memory_order_relaxed);
+        if (_depth != 0)
+        {
+            EXECUTOR->post([_depth]() { mutex_spawn(_depth - 1); });
+            EXECUTOR->post([_depth]() { mutex_spawn(_depth - 1); });
+        }
+    }
+
+    void wait_done(unsigned long long _number)
+    {
+        while (DONE.load(std::memory_order_relaxed) < _number)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    void print_latency(const char* _pool, const slib::util::latency_histogram& _histogram)
+    {
+        const double percentiles[] = {50.0, 99.0, 99.9};
+        for (auto p : percentiles)
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "latency/%s/p%g", _pool, p);
+            if (bench::enabled(name))
+            {
+                printf("%-40s %12llu %12s\n", name, _histogram.percentile(p), "-");
+            }
+        }
+        fflush(stdout);
+    }
+
+    const unsigned int SPAWN_DEPTH = 16; // 2^17 - 1 tasks
+    const unsigned int LATENCY_TASKS = 20000;
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+void benchmark_executor()
+{
+    bench::print_group("executor");
+
+    const unsigned int hardware = std::thread::hardware_concurrency();
+    const unsigned int threads = hardware > 1 ? hardware - 1 : 1;
+    const unsigned long long tasks = 200000ULL * bench::global_options().scale;
+    const unsigned long long spawned = (2ULL << SPAWN_DEPTH) - 1;
+
+    slib::util::thread_pool pool(threads);
+    mutex_executor executor(threads);
+    POOL = &pool;
+    EXECUTOR = &executor;
+
+    slib::delegate<void(unsigned int)> counter;
+    counter.bind<count_task>();
+
+    bench::measure("executor/pool/external", tasks, 1, [&]()
+    {
+        DONE = 0;
+        for (unsigned long long i = 0; i < tasks; ++i)
+        {
+            pool.post(counter, static_cast<unsigned int>(i));
+        }
+        wait_done(tasks);
+    });
+
+    bench::measure("executor/mutex_cv/external", tasks, 1, [&]()
+    {
+        DONE = 0;
+        for (unsigned long long i = 0; i < tasks; ++i)
+        {
+            executor.post([i]() { count_task(static_cast<unsigned int>(i)); });
+        }
+        wait_done(tasks);
+    });
+
+    slib::slot<unsigned int(unsigned int)> square;
+    square.bind<square_task>();
+
+    std::vector<slib::future<unsigned int> > futures(tasks);
+    std::vector<std::future<unsigned int> > std_futures(tasks);
+
+    bench::measure("executor/pool/future", tasks, 1, [&]()
+    {
+        for (unsigned long long i = 0; i < tasks; ++i)
+        {
+            futures[i] = square.post(pool, static_cast<unsigned int>(i));
+        }
+
+        unsigned int sum = 0;
+        for (auto& result : futures)
+        {
+            sum += result.get();
+        }
+
+        DONE = sum;
+    });
+
+    bench::measure("executor/mutex_cv/promise", tasks, 1, [&]()
+    {
+        for (unsigned long long i = 0; i < tasks; ++i)
+        {
+            std::shared_ptr<std::promise<unsigned int> > promise = std::make_shared<std::promise<unsigned int> >();
+            std_futures[i] = promise->get_future();
+            executor.post([promise, i]() { promise->set_value(square_task(static_cast<unsigned int>(i))); });
+        }
+
+        unsigned int sum = 0;
+        for (auto& result : std_futures)
+        {
+            sum += result.get();
+        }
+
+        DONE = sum;
+    });
+
+    futures.clear();
+    std_futures.clear();
+
+    bench::measure("executor/pool/spawn", spawned, 1, [&]()
+    {
+        DONE = 0;
+        slib::delegate<void(unsigned int)> root;
+        root.bind<pool_spawn>();
+        pool.post(root, SPAWN_DEPTH);
+        wait_done(spawned);
+    });
+
+    bench::measure("executor/mutex_cv/spawn", spawned, 1, [&]()
+    {
+        DONE = 0;
+        executor.post([]() { mutex_spawn(SPAWN_DEPTH); });
+        wait_done(spawned);
+    });
+
+    // Tail latency: tasks are posted with pauses, so workers are parked or spinning between them
+    LATENCIES.assign(LATENCY_TASKS, 0);
+    slib::delegate<void(unsigned int, unsigned long long)> latency;
+    latency.bind<latency_task>();
+
+    for (int kind = 0; kind < 2; ++kind)
+    {
+        DONE = 0;
+        for (unsigned int i = 0; i < LATENCY_TASKS; ++i)
+        {
+            if (kind == 0)
+            {
+                pool.post(latency, i, now_ns());
+            }
+            else
+            {
+                const unsigned long long posted = now_ns();
+                executor.post([i, posted]() { latency_task(i, posted); });
+            }
+
+            if ((i & 15) == 0)
+            {
+                wait_done(i + 1);
+            }
+        }
+        wait_done(LATENCY_TASKS);
+
+        slib::util::latency_histogram histogram;
+        for (auto value : LATENCIES)
+        {
+            histogram.record(value);
+        }
+
+        print_latency(kind == 0 ? "pool" : "mutex_cv", histogram);
+    }
+}
@@ -0,0 +1,158 @@
+/***************************************************************************************
+* file        : harness.hpp
+*             :
+* description : This header contains simple benchmark harness used by SignalsLibrary benchmarks.
+*             : Every measured region is repeated several times and the fastest run is reported
+*             : as time (and optionally hardware counters) per operation (for example, per emit)
+*             : and per item (for example, per invoked slot).
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__BENCHMARK__HARNESS__HPP_
+#define SIGNALS_LIBRARY__BENCHMARK__HARNESS__HPP_
+
+#include "perf_counters.hpp"
+#include <chrono>
+#include <string>
+#include <stdio.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace bench {
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Command line options of benchmark executable. */
+    struct options final
+    {
+        ::std::string filter; ///< Only benchmarks which names contain this string are run
+        unsigned int repeats; ///< Number of runs of every measured region (the fastest run is reported)
+        unsigned int   scale; ///< Multiplier for number of operations
+        bool            perf; ///< Read hardware performance counters
+
+        options() : repeats(5), scale(1), perf(false)
+        {
+        }
+    };
+
+    /** \brief Returns global benchmark options. */
+    inline options& global_options()
+    {
+        static options s_options;
+        return s_options;
+    }
+
+    /** \brief Returns true if benchmark with specified name must be run. */
+    inline bool enabled(const char* _name)
+    {
+        const options& opts = global_options();
+        return opts.filter.empty() || ::std::string(_name).find(opts.filter) != ::std::string::npos;
+    }
+
+    /** \brief Prints name of benchmarks group and columns header. */
+    inline void print_group(const char* _group)
+    {
+        printf("\n== %s ==\n", _group);
+        printf("%-40s %12s %12s", "benchmark", "ns/op", "ns/item");
+        if (global_options().perf)
+        {
+            for (unsigned int i = 0; i < perf_events_number; ++i)
+            {
+                printf(" %15s", perf_event_name(i));
+            }
+        }
+        printf("\n");
+    }
+
+    /** \brief Measures specified region.
+
+    \param _name Name of the benchmark.
+    \param _operations Number of operations made by one call of _region (for example, number of emits).
+    \param _items Number of items processed by one operation (for example, number of invoked slots per emit).
+    \param _region Measured function. It is called options::repeats times.
+
+    \retval Time of the fastest run in nanoseconds per operation. */
+    template <class TRegion>
+    double measure(const char* _name, unsigned long long _operations, unsigned long long _items, TRegion&& _region)
+    {
+        typedef ::std::chrono::steady_clock clock_type;
+
+        const options& opts = global_options();
+        if (!enabled(_name))
+        {
+            return 0;
+        }
+
+        perf_counters counters(opts.perf);
+
+        double best_time = -1;
+        perf_values best_values;
+
+        for (unsigned int run = 0; run < opts.repeats; ++run)
+        {
+            counters.start();
+            const auto start = clock_type::now();
+            _region();
+            const auto finish = clock_type::now();
+            const perf_values values = counters.stop();
+
+            const double time = static_cast<double>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(finish - start).count());
+            if (best_time < 0 || time < best_time)
+            {
+                best_time = time;
+                best_values = values;
+            }
+        }
+
+        const double operations = static_cast<double>(_operations == 0 ? 1 : _operations);
+        const double items = static_cast<double>(_items == 0 ? 1 : _items) * operations;
+
+        printf("%-40s %12.2f %12.3f", _name, best_time / operations, best_time / items);
+        if (opts.perf)
+        {
+            for (unsigned int i = 0; i < perf_events_number; ++i)
+            {
+                if (best_values.available[i])
+                {
+                    // per operation and per item
+                    char text[64];
+                    snprintf(text, sizeof(text), "%.1f/%.2f", best_values.values[i] / operations, best_values.values[i] / items);
+                    printf(" %15s", text);
+                }
+                else
+                {
+                    printf(" %15s", "n/a");
+                }
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+
+        return best_time / operations;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace bench.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__BENCHMARK__HARNESS__HPP_
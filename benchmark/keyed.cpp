@@ -0,0 +1,99 @@
+/*
+* Keyed dispatch benchmarks: one signal whose slots filter emitted key by themselves
+* compared with keyed_signal which invokes only slots of emitted key.
+*/
+
+#include "harness.hpp"
+#include "slib/keyed_signal.hpp"
+#include <vector>
+#include <memory>
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    int SINK = 0;
+
+    struct filtering_receiver
+    {
+        int key;
+
+        void receive(int _key, int _value)
+        {
+            if (_key == key)
+            {
+                SINK += _value;
+            }
+        }
+    };
+
+    void consume(int, int _value)
+    {
+        SINK += _value;
+    }
+
+    typedef slib::slot<void(int, int)> slot_type;
+
+    const unsigned int KEYS[] = {16, 256, 4096};
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+void benchmark_keyed()
+{
+    bench::print_group("keyed");
+
+    char name[64];
+
+    for (auto keys : KEYS)
+    {
+        const unsigned long long emits = 20000000ULL * bench::global_options().scale / keys;
+
+        // Every slot is invoked and compares key
+        {
+            std::vector<filtering_receiver> receivers(keys);
+            std::vector<std::unique_ptr<slot_type> > slots;
+            slib::signal<void(int, int)> sgnl;
+            for (unsigned int i = 0; i < keys; ++i)
+            {
+                receivers[i].key = static_cast<int>(i);
+                slots.emplace_back(new slot_type());
+                slots.back()->BIND(filtering_receiver, &receivers[i], receive);
+                sgnl.connect(*slots.back());
+            }
+
+            snprintf(name, sizeof(name), "filter/%u", keys);
+            bench::measure(name, emits, 1, [&]()
+            {
+                for (unsigned long long i = 0; i < emits; ++i)
+                {
+                    sgnl(static_cast<int>(i % keys), 1);
+                }
+            });
+        }
+
+        // Only slot of emitted key is invoked
+        {
+            std::vector<std::unique_ptr<slot_type> > slots;
+            slib::keyed_signal<int, void(int, int)> sgnl;
+            for (unsigned int i = 0; i < keys; ++i)
+            {
+                slots.emplace_back(new slot_type());
+                slots.back()->bind<consume>();
+                sgnl.connect(static_cast<int>(i), *slots.back());
+            }
+
+            snprintf(name, sizeof(name), "keyed/%u", keys);
+            bench::measure(name, emits, 1, [&]()
+            {
+                for (unsigned long long i = 0; i < emits; ++i)
+                {
+                    const int key = static_cast<int>(i % keys);
+                    sgnl(key, key, 1);
+                }
+            });
+        }
+    }
+}
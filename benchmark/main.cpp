@@ -0,0 +1,83 @@
+/*
+* SignalsLibrary benchmarks.
+*
+* Usage: signals_benchmark [--perf] [--filter <substring>] [--repeats <N>] [--scale <N>]
+*
+*   --perf      read hardware performance counters (Linux perf_event_open)
+*   --filter    run only benchmarks which names contain specified substring
+*   --repeats   number of runs of every measured region, the fastest is reported (default is 5)
+*   --scale     multiplier for number of operations (default is 1)
+*/
+
+#include "harness.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+void benchmark_emit();
+void benchmark_connect();
+void benchmark_keyed();
+void benchmark_chain();
+void benchmark_parallel();
+void benchmark_executor();
+void benchmark_coalescing();
+void benchmark_timers();
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    bench::options& opts = bench::global_options();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--perf") == 0)
+        {
+            opts.perf = true;
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            opts.filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc)
+        {
+            opts.repeats = static_cast<unsigned int>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+        {
+            opts.scale = static_cast<unsigned int>(atoi(argv[++i]));
+        }
+        else
+        {
+            printf("Usage: %s [--perf] [--filter <substring>] [--repeats <N>] [--scale <N>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (opts.repeats == 0)
+    {
+        opts.repeats = 1;
+    }
+
+    if (opts.scale == 0)
+    {
+        opts.scale = 1;
+    }
+
+    if (opts.perf && !bench::perf_counters().available())
+    {
+        printf("hardware performance counters are not available (check /proc/sys/kernel/perf_event_paranoid)\n");
+    }
+
+    benchmark_emit();
+    benchmark_connect();
+    benchmark_keyed();
+    benchmark_chain();
+    benchmark_parallel();
+    benchmark_executor();
+    benchmark_coalescing();
+    benchmark_timers();
+
+    return 0;
+}
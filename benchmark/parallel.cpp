@@ -0,0 +1,91 @@
+/*
+* Parallel emission benchmarks: serial emit_ compared with emit_parallel on a thread pool
+* for different numbers of slots and different amount of work done by one slot.
+* Work is measured in iterations of a dependent arithmetic loop (about 1 ns per iteration).
+*/
+
+#include "harness.hpp"
+#include "slib/executors.hpp"
+#include <vector>
+#include <memory>
+#include <atomic>
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    std::atomic<unsigned int> SINK(0);
+    unsigned int WORK = 0;
+
+    void work(unsigned int a)
+    {
+        for (unsigned int i = 0; i < WORK; ++i)
+        {
+            a = a * 1664525U + 1013904223U;
+        }
+
+        SINK.fetch_add(a & 1, std::memory_order_relaxed);
+    }
+
+    typedef slib::signal<void(unsigned int)> signal_type;
+    typedef slib::slot<void(unsigned int)> slot_type;
+
+    const unsigned int SLOTS[] = {16, 256, 4096};
+    const unsigned int WORKS[] = {0, 100, 1000, 10000};
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+void benchmark_parallel()
+{
+    bench::print_group("parallel");
+
+    slib::util::thread_pool pool;
+
+    char name[64];
+
+    for (auto work_amount : WORKS)
+    {
+        WORK = work_amount;
+
+        for (auto number : SLOTS)
+        {
+            signal_type sgnl(true);
+            std::vector<std::unique_ptr<slot_type> > slots;
+            for (unsigned int i = 0; i < number; ++i)
+            {
+                slots.emplace_back(new slot_type(true));
+                slots.back()->bind<work>();
+                sgnl.connect(*slots.back());
+            }
+
+            // keep total work per measurement roughly constant
+            const unsigned long long total = 20000000ULL * bench::global_options().scale;
+            unsigned long long emits = total / (static_cast<unsigned long long>(number) * (work_amount + 10));
+            if (emits == 0)
+            {
+                emits = 1;
+            }
+
+            snprintf(name, sizeof(name), "parallel/serial/%u/work%u", number, work_amount);
+            bench::measure(name, emits, number, [&]()
+            {
+                for (unsigned long long i = 0; i < emits; ++i)
+                {
+                    sgnl(static_cast<unsigned int>(i));
+                }
+            });
+
+            snprintf(name, sizeof(name), "parallel/pool%u/%u/work%u", pool.size() + 1, number, work_amount);
+            bench::measure(name, emits, number, [&]()
+            {
+                for (unsigned long long i = 0; i < emits; ++i)
+                {
+                    sgnl.emit_parallel(pool, static_cast<unsigned int>(i));
+                }
+            });
+        }
+    }
+}
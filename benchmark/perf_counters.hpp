@@ -0,0 +1,249 @@
+/***************************************************************************************
+* file        : perf_counters.hpp
+*             :
+* description : This header contains declaration and definition of perf_counters class
+*             : which reads hardware performance counters (cycles, instructions, L1 data cache
+*             : misses, last level cache misses and branch misses) around measured region
+*             : using Linux perf_event_open system call.
+*             :
+*             : On other platforms (or if perf events are not permitted, see
+*             : /proc/sys/kernel/perf_event_paranoid) counters are reported as unavailable
+*             : and benchmarks report wall-clock time only.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__BENCHMARK__PERF_COUNTERS__HPP_
+#define SIGNALS_LIBRARY__BENCHMARK__PERF_COUNTERS__HPP_
+
+#if defined(__linux__)
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# include <string.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace bench {
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Hardware events measured by perf_counters. */
+    enum perf_event : unsigned int
+    {
+        perf_cycles = 0,
+        perf_instructions,
+        perf_l1d_misses,
+        perf_llc_misses,
+        perf_branch_misses,
+
+        perf_events_number
+    };
+
+    /** \brief Returns short name of hardware event. */
+    inline const char* perf_event_name(unsigned int _event)
+    {
+        static const char* const names[perf_events_number] = {"cycles", "instructions", "l1d-misses", "llc-misses", "branch-misses"};
+        return _event < perf_events_number ? names[_event] : "";
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Values of hardware counters for one measured region. */
+    struct perf_values final
+    {
+        unsigned long long values[perf_events_number]; ///< Counter values
+        bool            available[perf_events_number]; ///< Availability flags (false if event could not be opened)
+
+        perf_values()
+        {
+            for (unsigned int i = 0; i < perf_events_number; ++i)
+            {
+                values[i] = 0;
+                available[i] = false;
+            }
+        }
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Set of hardware performance counters of current thread.
+
+    Usage:
+    \code
+    bench::perf_counters counters;
+    counters.start();
+    // measured region
+    bench::perf_values values = counters.stop();
+    \endcode */
+    class perf_counters final
+    {
+        int m_descriptors[perf_events_number]; ///< perf_event_open file descriptors (-1 if event is unavailable)
+
+        perf_counters(const perf_counters&) = delete;
+        perf_counters& operator = (const perf_counters&) = delete;
+
+    public:
+
+        /** \brief Opens counters.
+
+        \param _enabled If false then no counters are opened (all values are reported as unavailable). */
+        explicit perf_counters(bool _enabled = true)
+        {
+            for (unsigned int i = 0; i < perf_events_number; ++i)
+            {
+                m_descriptors[i] = _enabled ? open_event(i) : -1;
+            }
+        }
+
+        ~perf_counters()
+        {
+#if defined(__linux__)
+            for (unsigned int i = 0; i < perf_events_number; ++i)
+            {
+                if (m_descriptors[i] >= 0)
+                {
+                    close(m_descriptors[i]);
+                }
+            }
+#endif
+        }
+
+        /** \brief Returns true if at least one counter is available. */
+        bool available() const
+        {
+            for (unsigned int i = 0; i < perf_events_number; ++i)
+            {
+                if (m_descriptors[i] >= 0)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /** \brief Resets and starts all counters. */
+        inline void start()
+        {
+#if defined(__linux__)
+            for (unsigned int i = 0; i < perf_events_number; ++i)
+            {
+                if (m_descriptors[i] >= 0)
+                {
+                    ioctl(m_descriptors[i], PERF_EVENT_IOC_RESET, 0);
+                    ioctl(m_descriptors[i], PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        /** \brief Stops all counters and returns their values. */
+        inline perf_values stop()
+        {
+            perf_values result;
+
+#if defined(__linux__)
+            for (unsigned int i = 0; i < perf_events_number; ++i)
+            {
+                if (m_descriptors[i] >= 0)
+                {
+                    ioctl(m_descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+                }
+            }
+
+            for (unsigned int i = 0; i < perf_events_number; ++i)
+            {
+                unsigned long long value = 0;
+                if (m_descriptors[i] >= 0 && read(m_descriptors[i], &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value)))
+                {
+                    result.values[i] = value;
+                    result.available[i] = true;
+                }
+            }
+#endif
+
+            return result;
+        }
+
+    private:
+
+        /** \brief Opens one event for current thread on any CPU. */
+        static int open_event(unsigned int _event)
+        {
+#if defined(__linux__)
+            perf_event_attr attributes;
+            memset(&attributes, 0, sizeof(attributes));
+            attributes.size = sizeof(attributes);
+            attributes.disabled = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+
+            switch (_event)
+            {
+                case perf_cycles:
+                    attributes.type = PERF_TYPE_HARDWARE;
+                    attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+                    break;
+
+                case perf_instructions:
+                    attributes.type = PERF_TYPE_HARDWARE;
+                    attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+                    break;
+
+                case perf_l1d_misses:
+                    attributes.type = PERF_TYPE_HW_CACHE;
+                    attributes.config = PERF_COUNT_HW_CACHE_L1D
+                        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                    break;
+
+                case perf_llc_misses:
+                    attributes.type = PERF_TYPE_HARDWARE;
+                    attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+                    break;
+
+                case perf_branch_misses:
+                    attributes.type = PERF_TYPE_HARDWARE;
+                    attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+                    break;
+
+                default:
+                    return -1;
+            }
+
+            return static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+#else
+            (void)_event;
+            return -1;
+#endif
+        }
+
+    }; // END class perf_counters.
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace bench.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__BENCHMARK__PERF_COUNTERS__HPP_
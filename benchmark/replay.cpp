@@ -0,0 +1,154 @@
+/*
+* Replay driver for emission traces written by slib::util::trace_recorder.
+*
+* Usage: signals_replay <trace file> [--paced] [--loops <N>] [--perf]
+*
+*   --paced     reproduce original pacing of the trace (by default trace is replayed at full speed)
+*   --loops     number of replays (signal graph is rebuilt for every replay, default is 1)
+*   --perf      read hardware performance counters (Linux perf_event_open)
+*
+* Signal graph is reconstructed from the trace by slib::trace_player: connections which existed
+* when recording started, links between recorded signals, priorities and connection churn are
+* replayed in original order. Ordinary slots are replaced by synthetic slots which read all
+* argument bytes of the emission.
+*/
+
+#include "perf_counters.hpp"
+#include "slib/trace_player.hpp"
+#include <chrono>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    typedef slib::trace_player::recorder_type recorder_type;
+
+    unsigned long long CHECKSUM = 0;
+    unsigned long long INVOCATIONS = 0;
+
+    void consume(const unsigned char* _bytes, unsigned int _size)
+    {
+        ++INVOCATIONS;
+        for (unsigned int i = 0; i < _size; ++i)
+        {
+            CHECKSUM += _bytes[i];
+        }
+    }
+
+    void wait_until(std::chrono::steady_clock::time_point _time)
+    {
+        while (std::chrono::steady_clock::now() < _time)
+        {
+        }
+    }
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    const char* filename = nullptr;
+    bool paced = false, perf = false;
+    unsigned int loops = 1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--paced") == 0)
+        {
+            paced = true;
+        }
+        else if (strcmp(argv[i], "--perf") == 0)
+        {
+            perf = true;
+        }
+        else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc)
+        {
+            loops = static_cast<unsigned int>(atoi(argv[++i]));
+        }
+        else if (filename == nullptr && argv[i][0] != '-')
+        {
+            filename = argv[i];
+        }
+        else
+        {
+            filename = nullptr;
+            break;
+        }
+    }
+
+    if (filename == nullptr)
+    {
+        printf("Usage: %s <trace file> [--paced] [--loops <N>] [--perf]\n", argv[0]);
+        return 1;
+    }
+
+    slib::trace_player player(slib::trace_player::delegate_type::from_function<consume>());
+    if (!player.load(filename))
+    {
+        printf("%s\n", player.error().c_str());
+        return 1;
+    }
+
+    const std::vector<slib::trace_player::event>& events = player.events();
+    printf("trace: %u signals, %u records, %.3f ms\n", static_cast<unsigned int>(player.signals().size()),
+           static_cast<unsigned int>(events.size()), events.empty() ? 0.0 : events.back().time * 1e-6);
+
+    for (size_t i = 0; i < player.signals().size(); ++i)
+    {
+        const slib::trace_player::signal_info& info = player.signals()[i];
+        printf("  signal %u \"%s\": %u bytes of arguments, %llu emits\n",
+               static_cast<unsigned int>(i + 1), info.name.c_str(), info.arguments, info.emits);
+    }
+
+    bench::perf_counters counters(perf);
+
+    for (unsigned int loop = 0; loop < std::max(loops, 1U); ++loop)
+    {
+        unsigned long long emits = 0;
+        INVOCATIONS = 0;
+        player.reset();
+
+        counters.start();
+        const auto start = std::chrono::steady_clock::now();
+
+        for (const slib::trace_player::event& e : events)
+        {
+            if (paced)
+            {
+                wait_until(start + std::chrono::nanoseconds(e.time));
+            }
+
+            player.play(e);
+            if (e.type == recorder_type::record_emit)
+            {
+                ++emits;
+            }
+        }
+
+        const bench::perf_values values = counters.stop();
+        const double elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+        printf("replay %u: %llu emits, %llu slot invocations, %.3f ms, %.2f ns/emit", loop + 1, emits, INVOCATIONS,
+               elapsed * 1e-6, emits == 0 ? 0.0 : elapsed / emits);
+
+        for (unsigned int i = 0; i < bench::perf_events_number; ++i)
+        {
+            if (values.available[i] && emits != 0)
+            {
+                printf(", %.1f %s/emit", static_cast<double>(values.values[i]) / emits, bench::perf_event_name(i));
+            }
+        }
+
+        printf("\n");
+    }
+
+    printf("checksum: %llu\n", CHECKSUM);
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+* Timer benchmarks: 1M concurrent timers of slib::util::timer_wheel compared with a binary heap
+* (std::priority_queue) of deadlines, and start/stop of timer_signal objects.
+*
+*   timers/wheel/schedule_cancel   schedule and cancel of 1M timers with deadlines up to one minute
+*   timers/wheel/expire            schedule of 1M timers with deadlines up to 10 seconds and their
+*                                  expiration by advancing wheel tick by tick (1 ms)
+*   timers/heap/expire             the same with std::priority_queue (cancel is not supported by heap)
+*   timers/timer_signal/start_stop start and stop of timer_signal objects
+*
+* Time of wheels is advanced manually, so benchmarks do not wait for real deadlines.
+*/
+
+#include "harness.hpp"
+#include "slib/timer_signal.hpp"
+#include <vector>
+#include <queue>
+#include <memory>
+#include <utility>
+#include <functional>
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    typedef slib::util::timer_wheel::clock_type clock_type;
+
+    unsigned long long SINK = 0;
+
+    void expire(slib::util::timer_node*)
+    {
+        ++SINK;
+    }
+
+    void tick()
+    {
+        ++SINK;
+    }
+
+    const unsigned int TIMERS = 1000000;
+    const unsigned int SIGNALS = 65536;
+
+    /** \brief Pseudo-random delays in milliseconds from 1 to _range. */
+    std::vector<unsigned int> make_delays(unsigned int _number, unsigned int _range)
+    {
+        std::vector<unsigned int> delays(_number);
+        unsigned int seed = 12345;
+        for (auto& delay : delays)
+        {
+            seed = seed * 1664525U + 1013904223U;
+            delay = 1 + (seed >> 8) % _range;
+        }
+
+        return delays;
+    }
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+void benchmark_timers()
+{
+    bench::print_group("timers");
+
+    const unsigned int number = TIMERS * bench::global_options().scale;
+    std::vector<slib::util::timer_node> timers(number, slib::util::timer_node(&expire));
+
+    {
+        const std::vector<unsigned int> delays = make_delays(number, 60000);
+        bench::measure("timers/wheel/schedule_cancel/1M", 2ULL * number, 1, [&]()
+        {
+            slib::util::timer_wheel wheel(std::chrono::milliseconds(1));
+            const clock_type::time_point start = wheel.time();
+
+            for (unsigned int i = 0; i < number; ++i)
+            {
+                wheel.schedule(&timers[i], start + std::chrono::milliseconds(delays[i]));
+            }
+
+            for (unsigned int i = 0; i < number; ++i)
+            {
+                wheel.cancel(&timers[i]);
+            }
+        });
+    }
+
+    const unsigned int range = 10000;
+    const std::vector<unsigned int> delays = make_delays(number, range);
+
+    bench::measure("timers/wheel/expire/1M", number, 1, [&]()
+    {
+        slib::util::timer_wheel wheel(std::chrono::milliseconds(1));
+        const clock_type::time_point start = wheel.time();
+
+        for (unsigned int i = 0; i < number; ++i)
+        {
+            wheel.schedule(&timers[i], start + std::chrono::milliseconds(delays[i]));
+        }
+
+        for (unsigned int t = 1; t <= range; ++t)
+        {
+            wheel.advance(start + std::chrono::milliseconds(t));
+        }
+    });
+
+    bench::measure("timers/heap/expire/1M", number, 1, [&]()
+    {
+        typedef std::pair<unsigned long long, slib::util::timer_node*> entry_type;
+        std::priority_queue<entry_type, std::vector<entry_type>, std::greater<entry_type> > heap;
+
+        for (unsigned int i = 0; i < number; ++i)
+        {
+            heap.push(entry_type(delays[i], &timers[i]));
+        }
+
+        for (unsigned long long t = 1; t <= range; ++t)
+        {
+            while (!heap.empty() && heap.top().first <= t)
+            {
+                slib::util::timer_node* timer = heap.top().second;
+                heap.pop();
+                timer->function(timer);
+            }
+        }
+    });
+
+    {
+        slib::timer_scheduler scheduler(std::chrono::milliseconds(1));
+        slib::slot<void()> slt;
+        slt.bind<tick>();
+
+        std::vector<std::unique_ptr<slib::timer_signal<> > > signals;
+        signals.reserve(SIGNALS);
+        for (unsigned int i = 0; i < SIGNALS; ++i)
+        {
+            signals.emplace_back(new slib::timer_signal<>(scheduler));
+            signals.back()->connect(slt);
+        }
+
+        bench::measure("timers/timer_signal/start_stop/64K", 2ULL * SIGNALS, 1, [&]()
+        {
+            for (unsigned int i = 0; i < SIGNALS; ++i)
+            {
+                signals[i]->start(std::chrono::milliseconds(1 + i % 5000));
+            }
+
+            for (unsigned int i = 0; i < SIGNALS; ++i)
+            {
+                signals[i]->stop();
+            }
+        });
+    }
+}
@@ -94,7 +94,7 @@ namespace slib {
         {
         }
 
-        args_list(real_args_list&& _args) : m_args(_args)
+        args_list(real_args_list&& _args) : m_args(::std::move(_args))
         {
         }
 
@@ -0,0 +1,330 @@
+/***************************************************************************************
+* file        : coalescing_signal.hpp
+*             :
+* description : This header contains description of coalescing_signal class.
+*             : Coalescing signal stores arguments of the latest emission instead of invoking slots,
+*             : and delivers them (emits it's target signal once) on flush: by explicit flush() call,
+*             : on the next iteration of dispatcher's event loop or when time window expires.
+*             :
+*             : So N emissions between two deliveries cost N assignments of arguments plus
+*             : one real emission. Arguments storage is constructed by the first emission
+*             : and then it is reused, so coalescing does not allocate.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__COALESCING_SIGNAL__HPP_
+#define SIGNALS_LIBRARY__COALESCING_SIGNAL__HPP_
+
+#include "slib/executors.hpp"
+#include <chrono>
+#include <tuple>
+#include <type_traits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    template <typename function_signature> class coalescing_signal;
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Signal which delivers only arguments of the latest emission once per flush.
+
+    Usage example:
+    \code
+    slib::coalescing_signal<void(const model_state&)> state_changed;
+    state_changed.connect(view.on_state); // view is refreshed once per frame
+    state_changed.set_dispatcher(&gui);
+    // ... thousands of state_changed(state) between two frames
+    gui.process(); // view.on_state is invoked once with the latest state
+    \endcode
+
+    Delivery happens:
+    - on flush() call;
+    - on the next process() of dispatcher set by set_dispatcher() (the first emission after delivery queues one flush);
+    - on emission or poll() when time window set by set_window() has expired since the first coalesced emission.
+
+    Arguments are stored by value (decayed types), so slots must not take non-const lvalue references.
+
+    \ingroup slib */
+    template <typename return_type, typename ... Args>
+    class coalescing_signal < return_type(Args...) >
+    {
+    public:
+
+        typedef ::slib::slot< return_type(Args...) >           slot_type;
+        typedef ::slib::signal< return_type(Args...) >       signal_type;
+        typedef ::std::chrono::steady_clock                   clock_type;
+
+    private:
+
+        typedef ::slib::util::dynamic_mutex                                                    dynamic_mutex;
+        typedef ::slib::util::lock_guard<dynamic_mutex>                                           lock_guard;
+        typedef ::slib::args_list< return_type(typename ::std::decay<Args>::type...) >        arguments_type;
+        typedef ::std::tuple<typename ::std::decay<Args>::type...>                                tuple_type;
+        typedef typename ::std::aligned_storage<sizeof(arguments_type), alignof(arguments_type)>::type storage_type;
+
+        /** \brief Flush queued into dispatcher. */
+        struct flush_task final : public ::slib::util::pool_task
+        {
+            coalescing_signal* owner; ///< Flushed signal
+
+            explicit flush_task(coalescing_signal* _owner) : ::slib::util::pool_task(&coalescing_signal::run_flush), owner(_owner)
+            {
+            }
+        };
+
+        signal_type                    m_target; ///< Signal which delivers coalesced emissions
+        storage_type                  m_storage; ///< Arguments of the latest emission
+        flush_task                       m_task; ///< Flush queued into m_dispatcher
+        ::slib::util::dispatcher*  m_dispatcher; ///< Dispatcher which flushes on every iteration (nullptr if none)
+        clock_type::duration           m_window; ///< Maximum delay of delivery (zero if window is not used)
+        clock_type::time_point          m_since; ///< Time of the first coalesced emission
+        unsigned long long          m_coalesced; ///< Number of emissions which have not been delivered separately
+        dynamic_mutex                   m_mutex; ///< Mutex for multithreading protection (it is not multithreated by default)
+        bool                      m_constructed; ///< True if m_storage contains arguments object
+        bool                          m_pending; ///< True if m_storage contains arguments which have not been delivered
+        bool                        m_scheduled; ///< True if m_task is queued into m_dispatcher
+
+        coalescing_signal(const coalescing_signal&) = delete;
+        coalescing_signal& operator = (const coalescing_signal&) = delete;
+
+    public:
+
+        /** \brief Constructs coalescing signal.
+
+        \param _is_threadsafe Thread-safety flag (target signal gets the same flag). */
+        explicit coalescing_signal(bool _is_threadsafe = false)
+            : m_target(_is_threadsafe)
+            , m_task(this)
+            , m_dispatcher(nullptr)
+            , m_window(clock_type::duration::zero())
+            , m_coalesced(0)
+            , m_mutex(_is_threadsafe)
+            , m_constructed(false)
+            , m_pending(false)
+            , m_scheduled(false)
+        {
+        }
+
+        /** \brief Destructor.
+
+        \warning Flush queued into dispatcher must be processed before destruction. */
+        ~coalescing_signal()
+        {
+            if (m_constructed)
+            {
+                arguments()->~arguments_type();
+            }
+        }
+
+        /** \brief Returns signal which delivers coalesced emissions.
+
+        Use it to connect another signal or to emit immediately. */
+        inline signal_type& target()
+        {
+            return m_target;
+        }
+
+        /** \brief Connects slot to target signal (see signal::connect). */
+        inline connection connect(slot_type& _slot, int _priority = 0) const
+        {
+            return m_target.connect(_slot, _priority);
+        }
+
+        /** \brief Disconnects slot from target signal. */
+        inline void disconnect(slot_type& _slot) const
+        {
+            m_target.disconnect(_slot);
+        }
+
+        /** \brief Sets dispatcher which delivers pending emission on it's next process() call.
+
+        \warning This method is NOT thread-safe. Use this on initialization.
+
+        \param _dispatcher Pointer to dispatcher (nullptr means only flush() and window deliver emissions). */
+        inline void set_dispatcher(::slib::util::dispatcher* _dispatcher)
+        {
+            m_dispatcher = _dispatcher;
+        }
+
+        /** \brief Sets time window: pending emission is delivered by emit_() or poll() when it waits longer than window.
+
+        \warning This method is NOT thread-safe. Use this on initialization.
+
+        \param _window Maximum delay of delivery (zero turns window off). */
+        template <class rep_type, class period_type>
+        inline void set_window(const ::std::chrono::duration<rep_type, period_type>& _window)
+        {
+            m_window = ::std::chrono::duration_cast<clock_type::duration>(_window);
+        }
+
+        /** \brief Stores arguments for the next delivery (replacing not delivered ones).
+
+        \note This method is thread-safe if threadsafe flag is true. */
+        void emit_(Args... _args)
+        {
+            m_mutex.lock();
+
+            if (m_constructed)
+            {
+                arguments()->args() = tuple_type(::std::forward<Args>(_args)...);
+            }
+            else
+            {
+                new (arguments()) arguments_type(tuple_type(::std::forward<Args>(_args)...));
+                m_constructed = true;
+            }
+
+            if (m_pending)
+            {
+                ++m_coalesced;
+                if (m_window != clock_type::duration::zero() && clock_type::now() - m_since >= m_window)
+                {
+                    deliver(); // unlocks m_mutex
+                    return;
+                }
+
+                m_mutex.unlock();
+                return;
+            }
+
+            m_pending = true;
+            if (m_window != clock_type::duration::zero())
+            {
+                m_since = clock_type::now();
+            }
+
+            const bool schedule = m_dispatcher != nullptr && !m_scheduled;
+            m_scheduled = m_scheduled || schedule;
+            m_mutex.unlock();
+
+            if (schedule)
+            {
+                m_dispatcher->submit(&m_task);
+            }
+        }
+
+        /** \brief Stores arguments for the next delivery (replacing not delivered ones). */
+        inline void operator()(Args... _args)
+        {
+            emit_(::std::forward<Args>(_args)...);
+        }
+
+        /** \brief Delivers pending emission (emits target signal with the latest arguments).
+
+        \note This method is thread-safe if threadsafe flag is true.
+
+        \retval true if there was pending emission. */
+        bool flush()
+        {
+            m_mutex.lock();
+
+            if (!m_pending)
+            {
+                m_mutex.unlock();
+                return false;
+            }
+
+            deliver(); // unlocks m_mutex
+            return true;
+        }
+
+        /** \brief Delivers pending emission if time window has expired.
+
+        \note This method is thread-safe if threadsafe flag is true.
+
+        \retval true if emission has been delivered. */
+        bool poll()
+        {
+            m_mutex.lock();
+
+            if (!m_pending || m_window == clock_type::duration::zero() || clock_type::now() - m_since < m_window)
+            {
+                m_mutex.unlock();
+                return false;
+            }
+
+            deliver(); // unlocks m_mutex
+            return true;
+        }
+
+        /** \brief Returns true if there is an emission which has not been delivered yet. */
+        inline bool pending() const
+        {
+            lock_guard lg(m_mutex);
+            return m_pending;
+        }
+
+        /** \brief Returns number of emissions which were replaced by later ones (were not delivered separately). */
+        inline unsigned long long coalesced() const
+        {
+            lock_guard lg(m_mutex);
+            return m_coalesced;
+        }
+
+    private:
+
+        inline arguments_type* arguments()
+        {
+            return reinterpret_cast<arguments_type*>(&m_storage);
+        }
+
+        /** \brief Moves pending arguments out, unlocks m_mutex and emits target signal.
+
+        \note Must be called under locked m_mutex. */
+        void deliver()
+        {
+            arguments_type delivered(::std::move(arguments()->args()));
+            m_pending = false;
+            m_mutex.unlock();
+
+            private_deliver(delivered.args(), typename ::slib::util::args_sequence_generator<sizeof...(Args)>::type());
+        }
+
+        template <int ... S>
+        inline void private_deliver(tuple_type& _arguments, ::slib::util::args_sequence<S...>) const
+        {
+            // delivered arguments are a local copy: they can be moved into slots
+            m_target.emit_(static_cast<Args&&>(::std::get<S>(_arguments))...);
+        }
+
+        /** \brief Function of flush task queued into dispatcher. */
+        static void run_flush(::slib::util::pool_task* _task)
+        {
+            coalescing_signal* that = static_cast<flush_task*>(_task)->owner;
+
+            that->m_mutex.lock();
+            that->m_scheduled = false;
+            that->m_mutex.unlock();
+
+            that->flush();
+        }
+
+    }; // END class coalescing_signal.
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__COALESCING_SIGNAL__HPP_
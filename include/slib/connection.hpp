@@ -0,0 +1,305 @@
+/***************************************************************************************
+* file        : connection.hpp
+*             :
+* description : This header contains description of connection and scoped_connection classes.
+*             : Connection is a lightweight handle to one signal-slot connection which is returned
+*             : by connect methods. It is used to disconnect exactly this connection in O(1)
+*             : (without searching for the signal in slot's list of connections).
+*             :
+*             : Connection does not depend on function signature of signal and slot, so connections
+*             : of different signals can be stored in one container.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__CONNECTION__HPP_
+#define SIGNALS_LIBRARY__CONNECTION__HPP_
+
+#include <atomic>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    class connection;
+    class connection_group;
+
+    namespace util {
+
+        /** \brief Intrusive link of subscriber object in connection_group's list.
+
+        It does not depend on function signature, so one group can contain connections of different signals. */
+        struct group_node
+        {
+            group_node*                       group_prev; ///< Previous element in group's list
+            group_node*                       group_next; ///< Next element in group's list
+            ::std::atomic<connection_group*>       group; ///< Group which contains this element (nullptr if none)
+            const struct connection_operations* operations; ///< Functions of concrete slot type (used by group)
+
+            group_node() : group_prev(nullptr), group_next(nullptr), group(nullptr), operations(nullptr)
+            {
+            }
+        };
+
+        /** \brief Table of functions used by connection to manage subscriber of concrete slot type.
+
+        Each slot type has one static instance of this table. */
+        struct connection_operations final
+        {
+            bool (*connected)(const void* _subscriber, unsigned int _id); ///< Returns true if subscriber still represents connection _id
+            void (*disconnect)(void* _subscriber, unsigned int _id);      ///< Disconnects subscriber if it still represents connection _id
+            void (*block)(void* _subscriber, unsigned int _id, bool _blocked); ///< Blocks/unblocks subscriber if it still represents connection _id
+            bool (*blocked)(const void* _subscriber, unsigned int _id);   ///< Returns true if subscriber represents connection _id and it is blocked
+            bool (*join)(void* _subscriber, unsigned int _id, connection_group* _group); ///< Adds subscriber into group if it still represents connection _id
+            connection (*connection_of)(group_node* _node);               ///< Returns connection represented by group element (must be called under locked group)
+        };
+
+        /** \brief Returns new connection id.
+
+        Ids are unique among all slots (not only among connections of one slot), because memory of subscriber
+        objects is reused by other slots after destruction of their slot (see subscriber_allocator).
+
+        \note Id is 32-bit and it wraps after 2^32 connections, so a handle kept that long may match a new connection
+        which reuses the same subscriber object. Id is not widened to keep subscriber within one cache line. */
+        inline unsigned int next_connection_id()
+        {
+            static ::std::atomic<unsigned int> s_last_id(0);
+
+            unsigned int id = ++s_last_id;
+            while (id == 0)
+            {
+                id = ++s_last_id; // 0 is the id of empty connection
+            }
+
+            return id;
+        }
+
+    } // END namespace util.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Handle to one signal-slot connection.
+
+    It keeps pointer to the subscriber object which links slot and signal and an id of the connection.
+    Subscriber objects are reused after disconnection, but they get new id on every connect,
+    so handle of an old connection can not disconnect new one.
+
+    \note disconnect() is O(1).
+
+    \note It is totally safe to disconnect an empty connection or connection which has been already disconnected.
+
+    \note Connection can be used after destruction of it's slot (for example, scoped_connection declared before
+    the slot it owns): memory of subscriber objects is never released, so the handle only finds out that it's id is invalid.
+
+    \note Connection of thread-safe slot can be used concurrently with destruction of the slot by another thread:
+    id is validated under the lock of subscriber's pool, which outlives every slot.
+
+    \ingroup slib */
+    class connection
+    {
+        void*                                     m_subscriber; ///< Pointer to subscriber object
+        const ::slib::util::connection_operations* m_operations; ///< Functions of concrete slot type
+        unsigned int                                      m_id; ///< Id of the connection (0 for empty connection)
+
+    public:
+
+        /** \brief Constructs an empty connection. */
+        connection() : m_subscriber(nullptr), m_operations(nullptr), m_id(0)
+        {
+        }
+
+        /** \brief Constructs connection handle.
+
+        \note Used by slot. */
+        connection(void* _subscriber, unsigned int _id, const ::slib::util::connection_operations* _operations)
+            : m_subscriber(_subscriber)
+            , m_operations(_operations)
+            , m_id(_id)
+        {
+        }
+
+        /** \brief Tests if connection still exists.
+
+        \note This method is thread-safe if slot is thread-safe. */
+        inline bool connected() const
+        {
+            return m_id != 0 && m_operations->connected(m_subscriber, m_id);
+        }
+
+        /** \brief Disconnects slot from signal.
+
+        \note This method is thread-safe if slot is thread-safe. */
+        inline void disconnect()
+        {
+            if (m_id != 0)
+            {
+                m_operations->disconnect(m_subscriber, m_id);
+                m_id = 0;
+            }
+        }
+
+        /** \brief Blocks connection: slot stays connected but it is not invoked on signal emission.
+
+        \note This method is thread-safe if slot is thread-safe. */
+        inline void block()
+        {
+            if (m_id != 0)
+            {
+                m_operations->block(m_subscriber, m_id, true);
+            }
+        }
+
+        /** \brief Unblocks connection.
+
+        \note This method is thread-safe if slot is thread-safe. */
+        inline void unblock()
+        {
+            if (m_id != 0)
+            {
+                m_operations->block(m_subscriber, m_id, false);
+            }
+        }
+
+        /** \brief Tests if connection exists and it is blocked.
+
+        \note This method is thread-safe if slot is thread-safe. */
+        inline bool blocked() const
+        {
+            return m_id != 0 && m_operations->blocked(m_subscriber, m_id);
+        }
+
+        /** \brief Returns pointer to subscriber object which represents this connection.
+
+        \note Used by signal. */
+        inline void* subscriber() const
+        {
+            return m_subscriber;
+        }
+
+        /** \brief Tests if this handle is not empty (but connection may be already disconnected).
+
+        \sa connected */
+        inline bool empty() const
+        {
+            return m_id == 0;
+        }
+
+        inline bool operator == (const connection& _other) const
+        {
+            return m_subscriber == _other.m_subscriber && m_id == _other.m_id;
+        }
+
+        inline bool operator != (const connection& _other) const
+        {
+            return m_subscriber != _other.m_subscriber || m_id != _other.m_id;
+        }
+
+        friend class connection_group;
+
+    }; // END class connection.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Connection which automatically disconnects on destructor.
+
+    It can be moved, but can not be copied.
+
+    \ingroup slib */
+    class scoped_connection final
+    {
+        connection m_connection; ///< Owned connection
+
+        scoped_connection(const scoped_connection&) = delete;
+        scoped_connection& operator = (const scoped_connection&) = delete;
+
+    public:
+
+        scoped_connection()
+        {
+        }
+
+        scoped_connection(const connection& _connection) : m_connection(_connection)
+        {
+        }
+
+        scoped_connection(scoped_connection&& _other) : m_connection(_other.m_connection)
+        {
+            _other.m_connection = connection();
+        }
+
+        ~scoped_connection()
+        {
+            m_connection.disconnect();
+        }
+
+        scoped_connection& operator = (scoped_connection&& _other)
+        {
+            if (this != &_other)
+            {
+                m_connection.disconnect();
+                m_connection = _other.m_connection;
+                _other.m_connection = connection();
+            }
+
+            return *this;
+        }
+
+        scoped_connection& operator = (const connection& _connection)
+        {
+            m_connection.disconnect();
+            m_connection = _connection;
+            return *this;
+        }
+
+        /** \brief Tests if connection still exists. */
+        inline bool connected() const
+        {
+            return m_connection.connected();
+        }
+
+        /** \brief Disconnects slot from signal. */
+        inline void disconnect()
+        {
+            m_connection.disconnect();
+        }
+
+        /** \brief Returns owned connection and stops owning it (connection will not be disconnected on destructor). */
+        inline connection release()
+        {
+            const connection result = m_connection;
+            m_connection = connection();
+            return result;
+        }
+
+        /** \brief Returns owned connection. */
+        inline const connection& get() const
+        {
+            return m_connection;
+        }
+
+    }; // END class scoped_connection.
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__CONNECTION__HPP_
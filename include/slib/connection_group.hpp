@@ -0,0 +1,336 @@
+/***************************************************************************************
+* file        : connection_group.hpp
+*             :
+* description : This header contains description of connection_group class.
+*             : Connection group collects connections of any signals and slots (for example, all
+*             : connections made by one plugin) and disconnects or blocks all of them at once.
+*             :
+*             : Group does not own any container: subscriber objects (which represent connections)
+*             : are linked into group's intrusive list by their group_node links, so adding
+*             : a connection never allocates and disconnection of whole group is one linear walk.
+*             : Subscriber removes itself from the group when it's connection is destroyed in any way.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__SIGNALS__HPP_
+
+#error connection_group.hpp must be included only from signals.hpp!
+
+#elif !defined(SIGNALS_LIBRARY__CONNECTION_GROUP__HPP_)
+
+#define SIGNALS_LIBRARY__CONNECTION_GROUP__HPP_
+
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    /** \brief Group of connections which can be disconnected or blocked at once.
+
+    Usage example:
+    \code
+    slib::connection_group plugin_connections;
+    plugin_connections.connect(app.started, plugin.on_start);
+    plugin_connections.add(slib::connect(app.closed, plugin.on_close));
+    // ... on plugin unload:
+    plugin_connections.disconnect();
+    \endcode
+
+    Every connection may be a member of only one group (adding it into another group moves it).
+    Connections which are disconnected by other means (by slot, signal or connection handle)
+    leave the group automatically.
+
+    \note Group's mutex is always locked after mutexes of slots and signals, so group never
+    invokes slot methods under locked group mutex. disconnect(), block() and unblock() take
+    handles of up to batch_size connections at once into stack buffer, and process them
+    after the mutex is unlocked (neither of them allocates memory).
+
+    \warning Group must be destroyed (or disconnected) before destruction of any slot which
+    has connections in this group is started from another thread.
+
+    \ingroup slib */
+    class connection_group final
+    {
+        typedef ::slib::util::dynamic_mutex              dynamic_mutex;
+        typedef ::slib::util::lock_guard<dynamic_mutex>     lock_guard;
+        typedef ::slib::util::group_node                    node_type;
+
+        /** \brief Position of block() or unblock() in progress.
+
+        Every cursor is registered in group's list of cursors, so private_remove() can move it forward
+        if the next element is removed while group's mutex is unlocked. */
+        struct group_cursor final
+        {
+            node_type*           next; ///< The next element to process
+            group_cursor*       outer; ///< Previously registered cursor
+        };
+
+        node_type*          m_first; ///< First element of group's list
+        group_cursor*     m_cursors; ///< List of block() and unblock() calls in progress
+        size_t               m_size; ///< Number of connections in group
+        dynamic_mutex       m_mutex; ///< Mutex for multithreading protection (it is not multithreated by default)
+
+        connection_group(const connection_group&) = delete;
+        connection_group& operator = (const connection_group&) = delete;
+
+    public:
+
+        /** \brief Number of connections processed under one acquisition of group's mutex. */
+        static const size_t batch_size = 16;
+
+        /** \brief Constructs an empty group.
+
+        \param _is_threadsafe Thread-safety flag. */
+        explicit connection_group(bool _is_threadsafe = false) : m_first(nullptr), m_cursors(nullptr), m_size(0), m_mutex(_is_threadsafe)
+        {
+        }
+
+        /** \brief Disconnects all connections of the group. */
+        ~connection_group()
+        {
+            disconnect();
+        }
+
+        /** \brief Adds existing connection into group.
+
+        \note This method is thread-safe if both group and slot are thread-safe.
+
+        \retval true if connection is still connected and it has been added. */
+        inline bool add(const connection& _connection)
+        {
+            return _connection.m_id != 0 && _connection.m_operations->join(_connection.m_subscriber, _connection.m_id, this);
+        }
+
+        /** \brief Connects slot to signal and adds new connection into group.
+
+        \param _signal Reference to the signal.
+        \param _slot Reference to the slot (or to another signal).
+        \param _priority Emission priority (see signal::connect).
+
+        \retval Handle of the new connection. */
+        template <class signal_type, class slot_type>
+        inline connection connect(signal_type& _signal, slot_type& _slot, int _priority = 0)
+        {
+            const connection result = _signal.connect(_slot, _priority);
+            add(result);
+            return result;
+        }
+
+        /** \brief Disconnects all connections of the group.
+
+        Complexity is linear in number of group connections.
+
+        \note This method is thread-safe if both group and slots are thread-safe. */
+        void disconnect()
+        {
+            connection batch[batch_size];
+            size_t number;
+
+            do
+            {
+                number = 0;
+
+                m_mutex.lock();
+                for (; m_first != nullptr && number < batch_size; ++number)
+                {
+                    batch[number] = m_first->operations->connection_of(m_first);
+                    private_remove(m_first);
+                }
+                m_mutex.unlock();
+
+                // slot's mutex must not be locked under group's mutex
+                for (size_t i = 0; i < number; ++i)
+                {
+                    batch[i].disconnect();
+                }
+            }
+            while (number == batch_size);
+        }
+
+        /** \brief Blocks all connections of the group (see connection::block).
+
+        \note This method is thread-safe if both group and slots are thread-safe. */
+        inline void block()
+        {
+            set_blocked(true);
+        }
+
+        /** \brief Unblocks all connections of the group.
+
+        \note This method is thread-safe if both group and slots are thread-safe. */
+        inline void unblock()
+        {
+            set_blocked(false);
+        }
+
+        /** \brief Returns handles of all connections of the group. */
+        ::std::vector<connection> connections() const
+        {
+            ::std::vector<connection> result;
+
+            lock_guard lg(m_mutex);
+            result.reserve(m_size);
+            for (const node_type* current = m_first; current != nullptr; current = current->group_next)
+            {
+                result.push_back(current->operations->connection_of(const_cast<node_type*>(current)));
+            }
+
+            return result;
+        }
+
+        /** \brief Returns number of connections in the group. */
+        inline size_t size() const
+        {
+            lock_guard lg(m_mutex);
+            return m_size;
+        }
+
+        /** \brief Returns true if group has no connections. */
+        inline bool empty() const
+        {
+            return size() == 0;
+        }
+
+        /** \brief Links subscriber into group's list.
+
+        \note Used by slot under locked slot's mutex. */
+        inline void insert(node_type* _node)
+        {
+            lock_guard lg(m_mutex);
+
+            _node->group = this;
+            _node->group_prev = nullptr;
+            _node->group_next = m_first;
+            if (m_first != nullptr)
+            {
+                m_first->group_prev = _node;
+            }
+            m_first = _node;
+            ++m_size;
+        }
+
+        /** \brief Unlinks subscriber from group's list (if it is still there).
+
+        \note Used by slot under locked slot's mutex. */
+        inline void remove(node_type* _node)
+        {
+            lock_guard lg(m_mutex);
+            if (_node->group == this)
+            {
+                private_remove(_node);
+            }
+        }
+
+    private:
+
+        /** \brief Blocks or unblocks all connections of the group walking group's list by batches. */
+        void set_blocked(bool _blocked)
+        {
+            connection batch[batch_size];
+            group_cursor cursor;
+
+            m_mutex.lock();
+
+            cursor.next = m_first;
+            cursor.outer = m_cursors;
+            m_cursors = &cursor;
+
+            for (;;)
+            {
+                size_t number = 0;
+                for (; cursor.next != nullptr && number < batch_size; cursor.next = cursor.next->group_next)
+                {
+                    batch[number++] = cursor.next->operations->connection_of(cursor.next);
+                }
+
+                if (number == 0)
+                {
+                    break;
+                }
+
+                // slot's mutex must not be locked under group's mutex
+                m_mutex.unlock();
+                for (size_t i = 0; i < number; ++i)
+                {
+                    if (_blocked)
+                    {
+                        batch[i].block();
+                    }
+                    else
+                    {
+                        batch[i].unblock();
+                    }
+                }
+                m_mutex.lock();
+            }
+
+            // cursors of other threads may have been registered after this one
+            group_cursor** position = &m_cursors;
+            while (*position != &cursor)
+            {
+                position = &(*position)->outer;
+            }
+            *position = cursor.outer;
+
+            m_mutex.unlock();
+        }
+
+        /** \brief Unlinks subscriber from group's list. Must be called under locked m_mutex. */
+        inline void private_remove(node_type* _node)
+        {
+            for (group_cursor* cursor = m_cursors; cursor != nullptr; cursor = cursor->outer)
+            {
+                if (cursor->next == _node)
+                {
+                    cursor->next = _node->group_next;
+                }
+            }
+
+            if (_node->group_prev != nullptr)
+            {
+                _node->group_prev->group_next = _node->group_next;
+            }
+            else
+            {
+                m_first = _node->group_next;
+            }
+
+            if (_node->group_next != nullptr)
+            {
+                _node->group_next->group_prev = _node->group_prev;
+            }
+
+            _node->group_prev = nullptr;
+            _node->group_next = nullptr;
+            _node->group = nullptr;
+            --m_size;
+        }
+
+    }; // END class connection_group.
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // ifdef SIGNALS_LIBRARY__SIGNALS__HPP_ && !defined(SIGNALS_LIBRARY__CONNECTION_GROUP__HPP_)
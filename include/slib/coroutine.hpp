@@ -0,0 +1,552 @@
+/***************************************************************************************
+* file        : coroutine.hpp
+*             :
+* description : This header contains description of C++20 coroutine support:
+*             :
+*             : awaitable_signal class is a signal which may be awaited by coroutines:
+*             : co_await sig.next() returns arguments of the next emission.
+*             :
+*             : emission_stream class is an asynchronous generator of emissions of a signal:
+*             : emissions are buffered by the stream and consumer coroutine takes them
+*             : one by one by co_await stream.next().
+*             :
+*             : This header is opt-in: it requires C++20 coroutines, while the rest of
+*             : the library stays C++11. Plain slib::signal does not know about coroutines.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__COROUTINE__HPP_
+#define SIGNALS_LIBRARY__COROUTINE__HPP_
+
+#if !defined(__cpp_impl_coroutine)
+# error slib/coroutine.hpp requires C++20 coroutines (compile with -std=c++20 or /std:c++20)
+#endif
+
+#include "slib/signals.hpp"
+#include <coroutine>
+#include <optional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    template <typename function_signature> class awaitable_signal;
+    template <typename function_signature> class emission_stream;
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Signal which may be awaited by C++20 coroutines.
+
+    Usage example:
+    \code
+    slib::awaitable_signal<void(int, double)> price_changed;
+    // ...
+    auto [id, price] = co_await price_changed.next();
+    \endcode
+
+    awaitable_signal is an ordinary signal with one internal slot connected by the constructor. That slot resumes
+    coroutines which await the next emission, so awaiters are resumed by every emission (including flattened emissions
+    of upstream signals, parallel and asynchronous ones) by emitting thread, under locked signal's mutex (as connected
+    slot would be). Awaiter lives in coroutine frame and it is linked into intrusive list, so awaiting does not allocate.
+    Arguments are copied (stored by decayed types). Awaiters are resumed in order of awaiting.
+
+    Internal slot is not disconnected by disconnect(), so connected() is always true.
+
+    \warning Signal must outlive awaiting coroutines (or their frames must be destroyed first). Coroutine which is
+    suspended when signal is destroyed is never resumed.
+
+    \ingroup slib */
+    template <typename return_type, typename ... Args>
+    class awaitable_signal < return_type(Args...) > final : public signal< return_type(Args...) >
+    {
+    public:
+
+        typedef ::slib::signal< return_type(Args...) >                signal_type;
+        typedef ::slib::slot< return_type(Args...) >                    slot_type;
+        typedef ::std::tuple<typename ::std::decay<Args>::type...>     tuple_type;
+
+    private:
+
+        typedef awaitable_signal< return_type(Args...) >      this_type;
+        typedef ::slib::delegate< return_type(Args...) >  delegate_type;
+        typedef ::slib::util::dynamic_mutex               dynamic_mutex;
+        typedef ::slib::util::lock_guard<dynamic_mutex>      lock_guard;
+
+        /** \brief Link of circular intrusive list of awaiters.
+
+        Not linked awaiter (and empty list) points to itself, so awaiter can be unlinked in O(1) from any list it belongs to. */
+        struct awaiter_link
+        {
+            awaiter_link* prev; ///< Previous element
+            awaiter_link* next; ///< Next element
+
+            awaiter_link() : prev(this), next(this)
+            {
+            }
+
+            /** \brief Returns true if element is linked (or if list is not empty). */
+            inline bool linked() const
+            {
+                return next != this;
+            }
+
+            /** \brief Inserts element at the end of list _head. */
+            inline void link_before(awaiter_link* _head)
+            {
+                prev = _head->prev;
+                next = _head;
+                prev->next = this;
+                _head->prev = this;
+            }
+
+            inline void unlink()
+            {
+                prev->next = next;
+                next->prev = prev;
+                prev = this;
+                next = this;
+            }
+
+            /** \brief Moves all elements of list _head into this empty list. */
+            inline void take(awaiter_link& _head)
+            {
+                if (_head.linked())
+                {
+                    prev = _head.prev;
+                    next = _head.next;
+                    prev->next = this;
+                    next->prev = this;
+                    _head.prev = &_head;
+                    _head.next = &_head;
+                }
+            }
+
+        private:
+
+            awaiter_link(const awaiter_link&) = delete;
+            awaiter_link& operator = (const awaiter_link&) = delete;
+        };
+
+        mutable slot_type                  m_wake; ///< Internal slot which resumes awaiters
+        mutable dynamic_mutex   m_awaiters_mutex; ///< Mutex of the list of awaiters (it is not multithreated by default)
+        mutable awaiter_link          m_awaiters; ///< Head of list of coroutines awaiting the next emission
+
+    public:
+
+        /** \brief Awaitable object returned by next(). */
+        class awaiter final : private awaiter_link
+        {
+            friend this_type;
+
+            const this_type*                 m_signal; ///< Awaited signal (nullptr if signal has been destroyed)
+            ::std::coroutine_handle<>        m_handle; ///< Suspended coroutine (null if it is not suspended)
+            ::std::optional<tuple_type>   m_arguments; ///< Arguments of emission which resumed coroutine
+
+            awaiter(const awaiter&) = delete;
+            awaiter& operator = (const awaiter&) = delete;
+
+        public:
+
+            explicit awaiter(const this_type& _signal) : m_signal(&_signal)
+            {
+            }
+
+            /** \brief Unlinks awaiter of destroyed coroutine frame from the signal. */
+            ~awaiter()
+            {
+                if (m_signal != nullptr)
+                {
+                    lock_guard lg(m_signal->m_awaiters_mutex);
+                    if (m_handle)
+                    {
+                        awaiter_link::unlink();
+                    }
+                }
+            }
+
+            /** \brief Awaiting always suspends coroutine (emission has not happened yet). */
+            inline bool await_ready() const
+            {
+                return false;
+            }
+
+            /** \brief Links awaiter into signal's list of awaiters.
+
+            \note Coroutine may be resumed by another thread before this method returns, so awaiter is not used after linking. */
+            inline void await_suspend(::std::coroutine_handle<> _handle)
+            {
+                lock_guard lg(m_signal->m_awaiters_mutex);
+                m_handle = _handle;
+                awaiter_link::link_before(&m_signal->m_awaiters);
+            }
+
+            /** \brief Returns arguments of emission which resumed coroutine. */
+            inline tuple_type await_resume()
+            {
+                return ::std::move(*m_arguments);
+            }
+        };
+
+        /** \brief Creates signal and connects internal slot which resumes awaiters.
+
+        \param _is_threadsafe Thread-safety flag (see signal::set_threadsafe). */
+        explicit awaitable_signal(bool _is_threadsafe = false) : signal_type(_is_threadsafe), m_wake(_is_threadsafe), m_awaiters_mutex(_is_threadsafe)
+        {
+            m_wake.bind(delegate_type::template from_method<this_type, &this_type::wake>(this));
+            signal_type::connect(m_wake);
+        }
+
+        /** \brief Disconnects internal slot. Suspended coroutines are never resumed. */
+        ~awaitable_signal()
+        {
+            m_wake.disconnect();
+
+            lock_guard lg(m_awaiters_mutex);
+            while (m_awaiters.linked())
+            {
+                awaiter* current = static_cast<awaiter*>(m_awaiters.next);
+                current->unlink();
+                current->m_signal = nullptr;
+            }
+        }
+
+        /** \brief Sets thread-safety flag of the signal, it's internal slot and list of awaiters. */
+        inline void set_threadsafe(bool _is_threadsafe)
+        {
+            signal_type::set_threadsafe(_is_threadsafe);
+            m_wake.set_threadsafe(_is_threadsafe);
+            m_awaiters_mutex.set_threadsafe(_is_threadsafe);
+        }
+
+        using signal_type::disconnect;
+
+        /** \brief Disconnects all slots except internal one (awaiters are still resumed by emissions). */
+        void disconnect() const
+        {
+            signal_type::disconnect();
+            signal_type::connect(m_wake);
+        }
+
+        /** \brief Returns awaitable object: co_await returns arguments of the next emission as a tuple.
+
+        \note This method is thread-safe if set_threadsafe(true). */
+        inline awaiter next() const
+        {
+            return awaiter(*this);
+        }
+
+    private:
+
+        /** \brief Resumes all awaiters linked before this call with copies of emission arguments (invoked by emitting thread).
+
+        Coroutines which await again are linked into the signal's list (they are resumed by the next emission). */
+        return_type wake(Args... _args)
+        {
+            awaiter_link waking; // awaiters of this emission (they can be unlinked from this list by destroyed frames)
+
+            m_awaiters_mutex.lock();
+            waking.take(m_awaiters);
+
+            while (waking.linked())
+            {
+                awaiter* current = static_cast<awaiter*>(waking.next);
+                current->unlink();
+                const ::std::coroutine_handle<> handle = current->m_handle;
+                current->m_handle = nullptr;
+                m_awaiters_mutex.unlock();
+
+                current->m_arguments.emplace(_args...);
+                handle.resume(); // coroutine may await again, destroy other awaiters or emit this signal
+
+                m_awaiters_mutex.lock();
+            }
+
+            m_awaiters_mutex.unlock();
+
+            return ::slib::util::default_constructor<return_type>();
+        }
+
+    }; // END class awaitable_signal.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Asynchronous generator of emissions of a signal.
+
+    Usage example:
+    \code
+    slib::emission_stream<void(int, double)> quotes(feed.price_changed, 256);
+    while (auto quote = co_await quotes.next())
+    {
+        auto [id, price] = *quote;
+        // ...
+    }
+    // the loop ends when quotes.close() is called
+    \endcode
+
+    Stream is connected to the signal like an ordinary slot, so it receives every emission (including
+    flattened, parallel and asynchronous ones). Emissions are kept in a ring of _capacity elements which
+    is allocated once by the constructor, so neither emission nor awaiting allocates. When consumer does
+    not keep up and the ring is full, overflow policy decides which emission is lost (drop_newest,
+    drop_oldest or coalesce; block is not supported, because consumer may run on the emitting thread).
+
+    Suspended consumer is resumed by emitting thread (under locked signal's mutex, as connected slot would be).
+    Stream has one consumer.
+
+    \ingroup slib */
+    template <typename return_type, typename ... Args>
+    class emission_stream < return_type(Args...) > final
+    {
+    public:
+
+        typedef ::slib::slot< return_type(Args...) >                    slot_type;
+        typedef ::slib::signal< return_type(Args...) >                signal_type;
+        typedef ::std::tuple<typename ::std::decay<Args>::type...>     tuple_type;
+
+    private:
+
+        typedef emission_stream< return_type(Args...) >                                          this_type;
+        typedef ::slib::delegate< return_type(Args...) >                                     delegate_type;
+        typedef ::slib::util::dynamic_mutex                                                  dynamic_mutex;
+        typedef ::slib::util::lock_guard<dynamic_mutex>                                         lock_guard;
+        typedef typename ::std::aligned_storage<sizeof(tuple_type), alignof(tuple_type)>::type storage_type;
+
+        slot_type                         m_input; ///< Slot connected to the signal
+        ::std::unique_ptr<storage_type[]> m_storage; ///< Preallocated ring elements
+        ::std::coroutine_handle<>      m_consumer; ///< Suspended consumer (null if consumer is not suspended)
+        const size_t                   m_capacity; ///< Number of ring elements
+        size_t                             m_head; ///< Index of the oldest buffered emission
+        size_t                             m_size; ///< Number of buffered emissions
+        unsigned long long              m_dropped; ///< Number of lost emissions
+        dynamic_mutex                     m_mutex; ///< Mutex for multithreading protection (it is not multithreated by default)
+        const overflow_policy            m_policy; ///< What happens when ring is full
+        bool                             m_closed; ///< True if stream has been closed
+
+        emission_stream(const emission_stream&) = delete;
+        emission_stream& operator = (const emission_stream&) = delete;
+
+    public:
+
+        /** \brief Awaitable object returned by next(). */
+        class awaiter final
+        {
+            this_type& m_stream; ///< Awaited stream
+
+        public:
+
+            explicit awaiter(this_type& _stream) : m_stream(_stream)
+            {
+            }
+
+            inline bool await_ready() const
+            {
+                lock_guard lg(m_stream.m_mutex);
+                return m_stream.m_size != 0 || m_stream.m_closed;
+            }
+
+            /** \retval false if emission has arrived meanwhile (coroutine is not suspended). */
+            inline bool await_suspend(::std::coroutine_handle<> _handle)
+            {
+                lock_guard lg(m_stream.m_mutex);
+                if (m_stream.m_size != 0 || m_stream.m_closed)
+                {
+                    return false;
+                }
+
+                m_stream.m_consumer = _handle;
+                return true;
+            }
+
+            /** \brief Returns the oldest buffered emission (std::nullopt if stream has been closed and it is empty). */
+            inline ::std::optional<tuple_type> await_resume()
+            {
+                return m_stream.pop();
+            }
+        };
+
+        /** \brief Connects stream to signal.
+
+        \param _signal Signal which emissions are generated by the stream.
+        \param _capacity Maximum number of buffered emissions.
+        \param _policy What happens when ring is full.
+        \param _is_threadsafe Thread-safety flag (must be true if signal is emitted by other threads). */
+        explicit emission_stream(const signal_type& _signal, size_t _capacity = 64, overflow_policy _policy = overflow_policy::drop_oldest, bool _is_threadsafe = false)
+            : m_input(_is_threadsafe)
+            , m_storage(new storage_type[_capacity == 0 ? 1 : _capacity])
+            , m_capacity(_capacity == 0 ? 1 : _capacity)
+            , m_head(0)
+            , m_size(0)
+            , m_dropped(0)
+            , m_mutex(_is_threadsafe)
+            , m_policy(_policy == overflow_policy::block ? overflow_policy::drop_oldest : _policy)
+            , m_closed(false)
+        {
+            assert(_policy != overflow_policy::block && "emission_stream does not support overflow_policy::block");
+
+            m_input.bind(delegate_type::template from_method<this_type, &this_type::private_invoke>(this));
+            m_input.connect(_signal);
+        }
+
+        /** \brief Disconnects stream and destroys buffered emissions.
+
+        \warning Consumer must not be suspended on destruction (use close() to finish consumer's loop). */
+        ~emission_stream()
+        {
+            m_input.disconnect();
+
+            for (; m_size != 0; --m_size)
+            {
+                item(m_head)->~tuple_type();
+                m_head = next_index(m_head);
+            }
+        }
+
+        /** \brief Returns awaitable object: co_await returns the next emission (std::nullopt after close()). */
+        inline awaiter next()
+        {
+            return awaiter(*this);
+        }
+
+        /** \brief Disconnects stream from the signal. Consumer gets buffered emissions and then std::nullopt.
+
+        Suspended consumer is resumed by calling thread.
+
+        \note This method is thread-safe if threadsafe flag is true. */
+        void close()
+        {
+            m_input.disconnect();
+
+            m_mutex.lock();
+            m_closed = true;
+            const ::std::coroutine_handle<> consumer = m_consumer;
+            m_consumer = nullptr;
+            m_mutex.unlock();
+
+            if (consumer)
+            {
+                consumer.resume();
+            }
+        }
+
+        /** \brief Returns true if close() has been called. */
+        inline bool closed() const
+        {
+            lock_guard lg(m_mutex);
+            return m_closed;
+        }
+
+        /** \brief Returns number of buffered emissions. */
+        inline size_t size() const
+        {
+            lock_guard lg(m_mutex);
+            return m_size;
+        }
+
+        /** \brief Returns number of emissions lost because ring was full (drop_newest, drop_oldest or coalesce policy). */
+        inline unsigned long long dropped() const
+        {
+            lock_guard lg(m_mutex);
+            return m_dropped;
+        }
+
+    private:
+
+        inline tuple_type* item(size_t _index)
+        {
+            return reinterpret_cast<tuple_type*>(&m_storage[_index]);
+        }
+
+        inline size_t next_index(size_t _index) const
+        {
+            return _index + 1 == m_capacity ? 0 : _index + 1;
+        }
+
+        /** \brief Buffers emission and resumes suspended consumer (invoked by emitting thread). */
+        return_type private_invoke(Args... _args)
+        {
+            m_mutex.lock();
+
+            if (m_size == m_capacity)
+            {
+                ++m_dropped;
+                switch (m_policy)
+                {
+                    case overflow_policy::drop_newest:
+                        m_mutex.unlock();
+                        return ::slib::util::default_constructor<return_type>();
+
+                    case overflow_policy::coalesce:
+                        *item((m_head + m_size - 1) % m_capacity) = tuple_type(::std::forward<Args>(_args)...);
+                        m_mutex.unlock();
+                        return ::slib::util::default_constructor<return_type>();
+
+                    default:
+                        item(m_head)->~tuple_type();
+                        m_head = next_index(m_head);
+                        --m_size;
+                        break;
+                }
+            }
+
+            new (item((m_head + m_size) % m_capacity)) tuple_type(::std::forward<Args>(_args)...);
+            ++m_size;
+
+            const ::std::coroutine_handle<> consumer = m_consumer;
+            m_consumer = nullptr;
+            m_mutex.unlock();
+
+            if (consumer)
+            {
+                consumer.resume();
+            }
+
+            return ::slib::util::default_constructor<return_type>();
+        }
+
+        ::std::optional<tuple_type> pop()
+        {
+            lock_guard lg(m_mutex);
+
+            if (m_size == 0)
+            {
+                return ::std::nullopt;
+            }
+
+            tuple_type* front = item(m_head);
+            ::std::optional<tuple_type> result(::std::move(*front));
+            front->~tuple_type();
+            m_head = next_index(m_head);
+            --m_size;
+
+            return result;
+        }
+
+    }; // END class emission_stream.
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__COROUTINE__HPP_
@@ -37,6 +37,7 @@
 #define SIGNALS_LIBRARY__DELEGATE__HPP_
 
 #include <stdlib.h>
+#include <utility>
 #include "slib/util/default_constructor.hpp"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -267,6 +268,16 @@ namespace slib {
             bind<this_type::empty_method>();
         }
 
+        /** \brief Returns hash value of binded method/function and class instance.
+
+        \note Equal delegates have equal hash values. */
+        inline size_t hash() const
+        {
+            const size_t method = reinterpret_cast<size_t>(m_method);
+            const size_t instance = reinterpret_cast<size_t>(m_instance_ptr);
+            return method ^ (instance + static_cast<size_t>(0x9e3779b97f4a7c15ULL) + (method << 6) + (method >> 2));
+        }
+
         /** \brief Tests two Delegates for identity.
 
         \param _other reference to another delegate */
@@ -36,31 +36,40 @@ namespace slib {
     /** \brief Connects signal and slot.
 
     \param _signal Reference to the signal.
-    \param _slot Reference to the slot. */
+    \param _slot Reference to the slot.
+    \param _priority Emission priority (greater priority slots are invoked first).
+
+    \retval Handle of the new connection. */
     template <typename function_signature>
-    inline void connect(const ::slib::signal<function_signature>& _signal, ::slib::slot<function_signature>& _slot)
+    inline connection connect(const ::slib::signal<function_signature>& _signal, ::slib::slot<function_signature>& _slot, int _priority = 0)
     {
-        _signal.connect(_slot);
+        return _signal.connect(_slot, _priority);
     }
 
     /** \brief Connects signal and slot.
 
     \param _signal Reference to the signal.
-    \param _slot Reference to the slot. */
+    \param _slot Reference to the slot.
+    \param _priority Emission priority (greater priority slots are invoked first).
+
+    \retval Handle of the new connection. */
     template <typename function_signature>
-    inline void connect(::slib::slot<function_signature>& _slot, const ::slib::signal<function_signature>& _signal)
+    inline connection connect(::slib::slot<function_signature>& _slot, const ::slib::signal<function_signature>& _signal, int _priority = 0)
     {
-        _signal.connect(_slot);
+        return _signal.connect(_slot, _priority);
     }
 
     /** \brief Connects two signals.
 
     \param _signal Reference to the first signal (which would be emitted).
-    \param _slot Reference to the second signal (which would receive first signal's emittion and would emit itself after that). */
+    \param _slot Reference to the second signal (which would receive first signal's emittion and would emit itself after that).
+    \param _priority Emission priority (greater priority slots are invoked first).
+
+    \retval Handle of the new connection. */
     template <typename function_signature>
-    inline void connect(const ::slib::signal<function_signature>& _signal, ::slib::signal<function_signature>& _slot)
+    inline connection connect(const ::slib::signal<function_signature>& _signal, ::slib::signal<function_signature>& _slot, int _priority = 0)
     {
-        _signal.connect(_slot.to_slot());
+        return _signal.connect(_slot.to_slot(), _priority);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -95,6 +104,64 @@ namespace slib {
         _slot.to_slot().disconnect(_signal);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Connects several slots to signal under one lock of the signal.
+
+    \param _signal Reference to the signal.
+    \param _slot Reference to the first slot.
+    \param _rest References to other slots.
+
+    \retval Number of connected slots. */
+    template <typename function_signature, class ... TSlots>
+    inline size_t connect_all(const ::slib::signal<function_signature>& _signal, ::slib::slot<function_signature>& _slot, TSlots&... _rest)
+    {
+        ::slib::slot<function_signature>* slots[] = {&_slot, &_rest...};
+        return _signal.connect(slots, slots + 1 + sizeof...(TSlots));
+    }
+
+    /** \brief Connects range of slots to signal under one lock of the signal.
+
+    \param _signal Reference to the signal.
+    \param _first Iterator to the first slot (elements of range may be slots or pointers to slots).
+    \param _last Iterator after the last slot.
+    \param _connections Pointer to array of handles of new connections (may be nullptr).
+    \param _priority Emission priority of new connections (greater priority slots are invoked first).
+
+    \retval Number of connected slots. */
+    template <typename function_signature, class slot_iterator>
+    inline size_t connect_range(const ::slib::signal<function_signature>& _signal, slot_iterator _first, slot_iterator _last, connection* _connections = nullptr, int _priority = 0)
+    {
+        return _signal.connect(_first, _last, _connections, _priority);
+    }
+
+    /** \brief Disconnects several slots from signal under one lock of the signal.
+
+    \param _signal Reference to the signal.
+    \param _slot Reference to the first slot.
+    \param _rest References to other slots.
+
+    \retval Number of removed connections. */
+    template <typename function_signature, class ... TSlots>
+    inline size_t disconnect_all(const ::slib::signal<function_signature>& _signal, ::slib::slot<function_signature>& _slot, TSlots&... _rest)
+    {
+        ::slib::slot<function_signature>* slots[] = {&_slot, &_rest...};
+        return _signal.disconnect(slots, slots + 1 + sizeof...(TSlots));
+    }
+
+    /** \brief Disconnects range of slots from signal under one lock of the signal.
+
+    \param _signal Reference to the signal.
+    \param _first Iterator to the first slot (elements of range may be slots or pointers to slots).
+    \param _last Iterator after the last slot.
+
+    \retval Number of removed connections. */
+    template <typename function_signature, class slot_iterator>
+    inline size_t disconnect_range(const ::slib::signal<function_signature>& _signal, slot_iterator _first, slot_iterator _last)
+    {
+        return _signal.disconnect(_first, _last);
+    }
+
 } // END namespace slib.
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
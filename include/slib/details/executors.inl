@@ -0,0 +1,323 @@
+/***************************************************************************************
+* file        : executors.inl
+*             :
+* description : This inline file contains implementation of slot and signal methods
+*             : which use thread_pool, dispatcher, delivery_queue and future.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY_EXECUTORS___INL__
+# error executors.inl must be included only from executors.hpp!
+#else
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    template <typename return_type, typename ... Args>
+    void slot< return_type(Args...) >::set_affinity(::slib::util::dispatcher* _dispatcher)
+    {
+        lock_guard lg(m_mutex);
+
+        if (m_affinity == nullptr && _dispatcher == nullptr)
+        {
+            return; // slot has never been thread-affine
+        }
+
+        affinity_state& state = affine();
+        if (state.queue != nullptr && (_dispatcher == nullptr || &state.queue->owner() != _dispatcher))
+        {
+            delete state.queue; // bounded queue belongs to previous dispatcher
+            state.queue = nullptr;
+        }
+
+        state.owner = _dispatcher;
+        for (subscriber_type* current = m_first; current != nullptr; current = current->slot_list_link.next)
+        {
+            if (current->signal != nullptr)
+            {
+                current->signal->set_connection_affinity(current, _dispatcher);
+            }
+            else if (_dispatcher != nullptr || current->affinity() != nullptr)
+            {
+                current->extend().affinity = _dispatcher;
+            }
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    void slot< return_type(Args...) >::set_affinity(::slib::util::dispatcher* _dispatcher, size_t _capacity, overflow_policy _policy)
+    {
+        queue_type* queue = _dispatcher != nullptr ? ::slib::util::guarded_new<queue_type>(*this, *_dispatcher, _capacity, _policy) : nullptr;
+        queue_type* old = nullptr;
+        if (queue != nullptr)
+        {
+            affinity_state& state = affine();
+            old = state.queue;
+            state.queue = queue;
+        }
+
+        set_affinity(_dispatcher); // queue of another dispatcher is deleted here if _dispatcher is nullptr
+        delete old;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline ::slib::util::queue_statistics slot< return_type(Args...) >::queue_statistics() const
+    {
+        const affinity_state* state = m_affinity;
+        return state != nullptr && state->queue != nullptr ? state->queue->statistics() : queue_statistics_type();
+    }
+
+    template <typename return_type, typename ... Args>
+    template <class ... TArgs>
+    inline void slot< return_type(Args...) >::enqueue(::slib::util::dispatcher* _owner, TArgs&&... _args) const
+    {
+        queue_type* queue = m_affinity->queue;
+        if (queue != nullptr)
+        {
+            queue->push(::std::forward<TArgs>(_args)...);
+        }
+        else
+        {
+            _owner->post(static_cast<const delegate_type&>(*this), ::std::forward<TArgs>(_args)...);
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    typename slot< return_type(Args...) >::affinity_state& slot< return_type(Args...) >::affine()
+    {
+        if (m_affinity == nullptr)
+        {
+            m_affinity = ::slib::util::guarded_new<affinity_state>();
+            m_affinity->deliver = &this_type::deliver;
+            m_affinity->destroy = &this_type::destroy_affinity;
+        }
+
+        return *m_affinity;
+    }
+
+    template <typename return_type, typename ... Args>
+    bool slot< return_type(Args...) >::deliver(const slot_type& _slot, ::slib::util::dispatcher* _owner, Args&... _args)
+    {
+        if (_owner->is_current())
+        {
+            return false; // emitting thread is the owner: slot is invoked directly
+        }
+
+        _slot.enqueue(_owner, _args...);
+        return true;
+    }
+
+    template <typename return_type, typename ... Args>
+    void slot< return_type(Args...) >::destroy_affinity(affinity_state* _affinity)
+    {
+        delete _affinity->queue;
+        delete _affinity;
+    }
+
+    template <typename return_type, typename ... Args>
+    template <class executor_type>
+    inline ::slib::future<return_type> slot< return_type(Args...) >::post(executor_type& _executor, Args... _args) const
+    {
+        return ::slib::util::invoke_async(&_executor, static_cast<const delegate_type&>(*this), ::std::forward<Args>(_args)...);
+    }
+
+    template <typename return_type, typename ... Args>
+    inline ::slib::future<return_type> slot< return_type(Args...) >::invoke_async(Args... _args) const
+    {
+        ::slib::util::dispatcher* owner = affinity();
+        if (owner != nullptr && owner->is_current())
+        {
+            owner = nullptr;
+        }
+
+        return ::slib::util::invoke_async(owner, static_cast<const delegate_type&>(*this), ::std::forward<Args>(_args)...);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////////////////////////
+
+    template <typename return_type, typename ... Args>
+    struct signal< return_type(Args...) >::parallel_chunk final : public ::slib::util::pool_task
+    {
+        subscriber_type*               first; ///< The first subscriber of the chunk
+        unsigned int                  number; ///< Number of subscribers in the chunk
+        const parallel_arguments*  arguments; ///< Emission arguments
+        ::slib::util::task_latch*      latch; ///< Latch which is counted down on completion (nullptr for chunk of calling thread)
+
+        parallel_chunk() : ::slib::util::pool_task(&this_type::run_parallel_chunk), first(nullptr), number(0), arguments(nullptr), latch(nullptr)
+        {
+        }
+    };
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::emit_parallel(::slib::util::thread_pool& _pool, Args... _args) const
+    {
+        enum : unsigned int { chunks_per_thread = 4, max_chunks = 64 };
+
+        if (blocked())
+        {
+            return;
+        }
+
+        ::slib::util::emission_scope scope(m_mutex.threadsafe()); // full queues are waited for after unlocking
+        lock_guard lg(m_mutex);
+
+        unsigned int number = 0;
+        for (const subscriber_type* current = m_head; current != nullptr; current = current->signal_list_link.next)
+        {
+            ++number;
+        }
+
+        if (number == 0)
+        {
+            return;
+        }
+
+        unsigned int chunks = (_pool.size() + 1) * chunks_per_thread;
+        if (chunks > max_chunks)
+        {
+            chunks = max_chunks;
+        }
+
+        if (chunks > number)
+        {
+            chunks = number;
+        }
+
+        const parallel_arguments arguments(_args...);
+        ::slib::util::task_latch latch(chunks - 1);
+        parallel_chunk parts[max_chunks];
+
+        subscriber_type* current = m_head;
+        for (unsigned int i = 0; i < chunks; ++i)
+        {
+            parallel_chunk& part = parts[i];
+            part.first = current;
+            part.number = number / chunks + (i < number % chunks ? 1 : 0);
+            part.arguments = &arguments;
+
+            for (unsigned int j = 0; j < part.number; ++j)
+            {
+                current = current->signal_list_link.next;
+            }
+
+            if (i != 0)
+            {
+                part.latch = &latch;
+                _pool.submit(&part);
+            }
+        }
+
+        run_parallel_chunk(&parts[0]); // the first chunk is invoked by calling thread
+        _pool.wait(latch);
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::emit_async(::slib::util::thread_pool& _pool, Args... _args) const
+    {
+        if (blocked())
+        {
+            return;
+        }
+
+        ::slib::util::emission_scope scope(m_mutex.threadsafe()); // full queues are waited for after unlocking
+        lock_guard lg(m_mutex);
+
+        for (const subscriber_type* current = m_head; current != nullptr; current = current->signal_list_link.next)
+        {
+            if (current->blocked)
+            {
+                continue;
+            }
+
+            ::slib::util::dispatcher* owner = current->affinity();
+            if (owner != nullptr)
+            {
+                current->slot->enqueue(owner, _args...);
+            }
+            else
+            {
+                _pool.post(static_cast<const delegate_type&>(*current->slot), _args...);
+            }
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    template <class executor_type>
+    inline ::slib::future<void> signal< return_type(Args...) >::post(executor_type& _executor, Args... _args) const
+    {
+        typedef ::slib::delegate< void(Args...) > emission_type;
+        const emission_type emission = emission_type::template from_const_method<this_type, &this_type::emit_>(const_cast<this_type*>(this));
+        return ::slib::util::invoke_async(&_executor, emission, ::std::forward<Args>(_args)...);
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::run_parallel_chunk(::slib::util::pool_task* _task)
+    {
+        const parallel_chunk& chunk = static_cast<const parallel_chunk&>(*_task);
+
+        {
+            // emitting thread holds signal's mutex until all chunks are finished: chunks never wait for full queues
+            ::slib::util::emission_scope scope(true, false);
+            invoke_parallel_chunk(chunk, typename ::slib::util::args_sequence_generator<sizeof...(Args)>::type());
+        }
+
+        if (chunk.latch != nullptr)
+        {
+            chunk.latch->count_down(); // chunk may be destroyed by emitting thread right after that
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    template <int ... S>
+    inline void signal< return_type(Args...) >::invoke_parallel_chunk(const parallel_chunk& _chunk, ::slib::util::args_sequence<S...>)
+    {
+        const subscriber_type* current = _chunk.first;
+        for (unsigned int i = 0; i < _chunk.number; ++i, current = current->signal_list_link.next)
+        {
+            if (current->blocked)
+            {
+                continue;
+            }
+
+            ::slib::util::dispatcher* owner = current->affinity();
+            if (owner != nullptr && !owner->is_current())
+            {
+                current->slot->enqueue(owner, ::std::get<S>(*_chunk.arguments)...);
+            }
+            else
+            {
+                // arguments are shared by all slots: rvalues are passed only if slot requires them
+                current->slot->operator()(static_cast<typename ::std::conditional<::std::is_rvalue_reference<Args>::value, Args, Args&>::type>(
+                    ::std::get<S>(*_chunk.arguments))...);
+            }
+        }
+    }
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY_EXECUTORS___INL__
@@ -0,0 +1,101 @@
+/***************************************************************************************
+* file        : recording.inl
+*             :
+* description : This inline file contains implementation of signal methods which use
+*             : trace_recorder.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY_RECORDING___INL__
+# error recording.inl must be included only from recording.hpp!
+#else
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::record(recorder_type* _recorder, const char* _name)
+    {
+        lock_guard lg(m_mutex);
+
+        extension* ext = extended();
+        if (ext != nullptr)
+        {
+            set_state(recording_state, false);
+            ext->recorder.store(nullptr, ::std::memory_order_relaxed);
+            ext->trace_id = 0;
+        }
+
+        if (_recorder == nullptr)
+        {
+            return;
+        }
+
+        ext = &extend();
+        ext->trace_id = _recorder->register_signal(_name, ::slib::util::trace_arguments<Args...>::size);
+        ext->recording = &s_recording_operations;
+        ext->recorder.store(_recorder, ::std::memory_order_relaxed);
+        set_state(recording_state, true);
+
+        // Write existing connections (downstream signals are registered first, so links between signals are kept in the trace)
+        for (const subscriber_type* current = m_head; current != nullptr; current = current->signal_list_link.next)
+        {
+            this_type* downstream = const_cast<this_type*>(signal_of(current->slot));
+            if (downstream != nullptr && downstream->active_recorder() == nullptr)
+            {
+                downstream->record(_recorder, nullptr);
+            }
+
+            _recorder->connect(ext->trace_id, trace_id_of(current->slot), current->priority());
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::record_connect_stub(recorder_type* _recorder, unsigned int _id, unsigned int _target, int _priority)
+    {
+        _recorder->connect(_id, _target, _priority);
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::record_disconnect_stub(recorder_type* _recorder, unsigned int _id, unsigned int _target)
+    {
+        _recorder->disconnect(_id, _target);
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::record_emit_stub(recorder_type* _recorder, unsigned int _id, Args&... _args)
+    {
+        _recorder->emit_(_id, _args...);
+    }
+
+    template <typename return_type, typename ... Args>
+    const typename signal< return_type(Args...) >::recording_operations signal< return_type(Args...) >::s_recording_operations = {
+        &signal< return_type(Args...) >::record_connect_stub,
+        &signal< return_type(Args...) >::record_disconnect_stub,
+        &signal< return_type(Args...) >::record_emit_stub
+    };
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY_RECORDING___INL__
@@ -36,13 +36,119 @@ namespace slib {
 
     namespace util {
 
+        class dispatcher;
+
+        /** \brief Allocator of subscriber objects which never releases their memory.
+
+        Memory of subscribers is kept in process-wide free list of subscribers of the same type and it is reused
+        by other slots, so connection handle which outlives it's slot never points to released memory
+        (subscriber keeps an id which does not match the handle, see next_connection_id).
+        Reuse of pooled memory is reported to no_allocation_region: it has not been reserved by the slot.
+
+        \note The pool is never shrunk: it's size is the peak number of simultaneously existing subscribers of this type
+        and the memory is returned to the system only at process exit. */
+        template <class T>
+        struct subscriber_allocator : public ::slib::util::guarded_allocator<T>
+        {
+            typedef ::slib::util::guarded_allocator<T>  parent_type;
+            typedef typename parent_type::pointer      pointer;
+            typedef typename parent_type::size_type  size_type;
+
+            /** \brief Auxiliary struct to convert this type to allocator of other type (used by cached_allocator for it's cache). */
+            template <class U>
+            struct rebind
+            {
+                typedef ::slib::util::guarded_allocator<U> other;
+            };
+
+            using parent_type::allocate;
+
+            /** \brief Allocate array of elements (single element is taken from the pool first).
+
+            \param _number Required number of elements in array. */
+            pointer allocate(size_type _number) const
+            {
+                if (_number == 1)
+                {
+                    free_list& pool = s_pool();
+                    lock_pool();
+
+                    void* memory = pool.first;
+                    if (memory != nullptr)
+                    {
+                        pool.first = *static_cast<void**>(memory);
+                    }
+
+                    unlock_pool();
+
+                    if (memory != nullptr)
+                    {
+                        ::slib::util::on_allocation();
+                        return static_cast<pointer>(memory);
+                    }
+                }
+
+                return parent_type::allocate(_number);
+            }
+
+            /** \brief Returns memory of one element into the pool.
+
+            \note Pool link is kept in the first bytes of memory, so subscriber's id stays untouched. */
+            void deallocate(pointer _memory, size_type = 0) const
+            {
+                free_list& pool = s_pool();
+                lock_pool();
+
+                *reinterpret_cast<void**>(_memory) = pool.first;
+                pool.first = _memory;
+
+                unlock_pool();
+            }
+
+            /** \brief Locks the pool's spin lock.
+
+            The pool outlives every slot, so the lock is also used by connection handles: subscriber's id is reset
+            under this lock, hence the slot of a subscriber with valid id can not be destroyed while the lock is held. */
+            static void lock_pool()
+            {
+                while (s_pool().locked.test_and_set(::std::memory_order_acquire));
+            }
+
+            /** \brief Unlocks the pool's spin lock. */
+            static void unlock_pool()
+            {
+                s_pool().locked.clear(::std::memory_order_release);
+            }
+
+        private:
+
+            /** \brief Process-wide list of free subscribers (it is trivially destructible, so it outlives static slots). */
+            struct free_list
+            {
+                ::std::atomic_flag locked; ///< Spin lock (used by connect, reserve, disconnect and connection handles)
+                void*              first; ///< The first free element
+            };
+
+            static free_list& s_pool()
+            {
+                static free_list s_list = {ATOMIC_FLAG_INIT, nullptr};
+                return s_list;
+            }
+
+        }; // END struct subscriber_allocator.
+
         /** \brief An auxiliary data struct, which keeps pointer to this slot
-        and pointers to previous and next elements in signal's slot list. */
+        and pointers to previous and next elements in signal's slot list.
+
+        Subscriber keeps only the state which is used by every connection (it fits one cache line).
+        State of rare features (priority, thread affinity, profiling, group membership) is kept
+        in extension which is created on the first use and destroyed together with subscriber. */
         template <class slot_type, class signal_type>
         class subscriber final
         {
             typedef subscriber this_type;
-            typedef ::salloc::cached_allocator<this_type, ::salloc::shared_allocator<this_type> > allocator_type;
+            typedef ::salloc::shared_allocator<this_type>                                  base_allocator_type;
+            typedef ::salloc::cached_allocator<this_type, subscriber_allocator<this_type> > allocator_type;
 
             struct link {
                 this_type* prev;
@@ -50,20 +156,108 @@ namespace slib {
                 link(this_type* _prev = nullptr, this_type* _next = nullptr) : prev(_prev), next(_next) { }
             };
 
+            /** \brief State of rare features of connection.
+
+            Base group_node keeps links in connection_group's list. */
+            struct extension_type final : public ::slib::util::group_node
+            {
+                this_type*                           owner; ///< Subscriber which owns this extension
+                ::slib::util::latency_histogram* histogram; ///< Invocation timings (exists only if signal's profiling is enabled)
+                ::slib::util::dispatcher*         affinity; ///< Dispatcher of thread-affine slot (nullptr for ordinary slots) // used by signal
+                int                               priority; ///< Emission priority (greater priority slots are invoked first) // used by signal
+
+                explicit extension_type(this_type* _owner) : owner(_owner), histogram(nullptr), affinity(nullptr), priority(0)
+                {
+                }
+
+                ~extension_type()
+                {
+                    delete histogram;
+                }
+            };
+
+            typedef subscriber_allocator<extension_type> extension_allocator_type;
+
         private:
 
             slot_type*           slot; ///< Pointer to slot to make disconnect which is used by signal
+            link     signal_list_link; ///< Pointers to prev and next elements in signal's list // used by signal (kept next to slot: both are read by emission)
             const signal_type* signal; ///< Pointer to signal to make disconnect which is used by both slot and signal
 
             link       slot_list_link; ///< Pointers to prev and next elements in slot's list // used by slot
-            link     signal_list_link; ///< Pointers to prev and next elements in signal's list // used by signal
 
-            subscriber(slot_type* _slot) : slot(_slot), signal(nullptr)
+            ::std::atomic<extension_type*> extension; ///< State of rare features (nullptr until one of them is used)
+            ::std::atomic<unsigned int>           id; ///< Connection id (0 if not connected) // used by connection handles without locking
+            bool                             blocked; ///< True if connection is blocked (slot is not invoked) // used by signal
+            bool                             guarded; ///< True if connection closes a cycle allowed by cycle_policy::allow_guarded // used by signal
+
+            subscriber(slot_type* _slot) : slot(_slot), signal(nullptr), extension(nullptr), id(0), blocked(false), guarded(false)
+            {
+            }
+
+            ~subscriber()
+            {
+                extension_type* ext = extension.load(::std::memory_order_acquire);
+                if (ext != nullptr)
+                {
+                    ext->~extension_type();
+                    extension_allocator_type().deallocate(ext);
+                }
+            }
+
+            /** \brief Returns extension (nullptr if it has not been created yet). */
+            inline extension_type* extended() const
+            {
+                return extension.load(::std::memory_order_acquire);
+            }
+
+            /** \brief Returns extension creating it if necessary.
+
+            Extension may be created concurrently by slot (under slot's mutex) and by signal (under signal's mutex),
+            so it is published by compare-exchange. */
+            extension_type& extend()
+            {
+                extension_type* ext = extension.load(::std::memory_order_acquire);
+                if (ext == nullptr)
+                {
+                    extension_allocator_type allocator;
+                    extension_type* created = new (allocator.allocate(1)) extension_type(this);
+                    if (extension.compare_exchange_strong(ext, created, ::std::memory_order_acq_rel))
+                    {
+                        ext = created;
+                    }
+                    else
+                    {
+                        created->~extension_type(); // another thread has been the first
+                        allocator.deallocate(created);
+                    }
+                }
+
+                return *ext;
+            }
+
+            inline int priority() const
+            {
+                const extension_type* ext = extended();
+                return ext != nullptr ? ext->priority : 0;
+            }
+
+            inline ::slib::util::dispatcher* affinity() const
+            {
+                const extension_type* ext = extended();
+                return ext != nullptr ? ext->affinity : nullptr;
+            }
+
+            inline ::slib::util::latency_histogram* histogram() const
             {
+                const extension_type* ext = extended();
+                return ext != nullptr ? ext->histogram : nullptr;
             }
 
-            subscriber(const signal_type* _signal) : slot(nullptr), signal(_signal)
+            inline ::slib::connection_group* group() const
             {
+                const extension_type* ext = extended();
+                return ext != nullptr ? ext->group.load() : nullptr;
             }
 
             /** \brief Unbinds signal's private parts.
@@ -108,6 +302,7 @@ namespace slib {
             friend slot_type;
             friend signal_type;
             friend allocator_type;
+            friend base_allocator_type;
 
         }; // END struct subscriber.
 
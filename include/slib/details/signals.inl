@@ -38,6 +38,7 @@ namespace slib {
     slot< return_type(Args...) >::slot()
         : parent_type()
         , m_first(nullptr)
+        , m_affinity(nullptr)
     {
         m_allocator.reserve(1, 1); // reserve connection for one signal
     }
@@ -46,6 +47,7 @@ namespace slib {
     slot< return_type(Args...) >::slot(const parent_type& _handler)
         : parent_type(_handler)
         , m_first(nullptr)
+        , m_affinity(nullptr)
     {
         m_allocator.reserve(1, 1); // reserve connection for one signal
     }
@@ -55,6 +57,7 @@ namespace slib {
         : parent_type()
         , m_mutex(_is_threadsafe)
         , m_first(nullptr)
+        , m_affinity(nullptr)
     {
         m_allocator.reserve(1, 1); // reserve connection for one signal
     }
@@ -64,6 +67,7 @@ namespace slib {
         : parent_type(_handler)
         , m_mutex(_is_threadsafe)
         , m_first(nullptr)
+        , m_affinity(nullptr)
     {
         m_allocator.reserve(1, 1); // reserve connection for one signal
     }
@@ -84,12 +88,19 @@ namespace slib {
 
             current->slot_unbind();
             current->signal->remove(current);
+            leave_group(current);
 
+            invalidate(current); // subscriber's memory is kept in the pool
             m_allocator.destroy(current);
             m_allocator.deallocate_force(current);
         }
 
         m_mutex.unlock();
+
+        if (m_affinity != nullptr)
+        {
+            m_affinity->destroy(m_affinity);
+        }
     }
 
     template <typename return_type, typename ... Args>
@@ -105,7 +116,13 @@ namespace slib {
     }
 
     template <typename return_type, typename ... Args>
-    inline typename slot< return_type(Args...) >::subscriber_type* slot< return_type(Args...) >::get_new_subscriber()
+    inline ::slib::util::dispatcher* slot< return_type(Args...) >::affinity() const
+    {
+        return m_affinity != nullptr ? m_affinity->owner : nullptr;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline typename slot< return_type(Args...) >::subscriber_type* slot< return_type(Args...) >::get_new_subscriber(int _priority)
     {
         lock_guard lg(m_mutex);
 
@@ -116,6 +133,16 @@ namespace slib {
         }
 
         m_allocator.construct(subscriber, this);
+        ::slib::util::dispatcher* owner = affinity();
+        if (_priority != 0 || owner != nullptr)
+        {
+            typename subscriber_type::extension_type& ext = subscriber->extend();
+            ext.priority = _priority;
+            ext.affinity = owner;
+        }
+
+        // every connection gets unique id to make connection handles of old connections invalid
+        subscriber->id = ::slib::util::next_connection_id();
 
         // put new slot into subscribers list
         subscriber->slot_list_link.next = m_first;
@@ -144,19 +171,27 @@ namespace slib {
             current->slot_unbind();
             current->signal->remove(current);
 
-            m_allocator.destroy(current);
-            m_allocator.deallocate(current);
+            release(current);
         }
     }
 
     template <typename return_type, typename ... Args>
-    void slot< return_type(Args...) >::connect(const signal_type& _signal)
+    connection slot< return_type(Args...) >::connect(const signal_type& _signal, int _priority)
     {
-        subscriber_type* subscriber = get_new_subscriber();
-        if (subscriber != nullptr)
+        subscriber_type* subscriber = get_new_subscriber(_priority);
+        if (subscriber == nullptr)
+        {
+            return connection();
+        }
+
+        const connection result = make_connection(subscriber);
+        if (!_signal.insert(subscriber))
         {
-            _signal.insert(subscriber);
+            detach(subscriber); // rejected as duplicate or as a cycle
+            return connection();
         }
+
+        return result;
     }
 
     template <typename return_type, typename ... Args>
@@ -177,8 +212,7 @@ namespace slib {
                 current->slot_unbind();
                 _signal.remove(current);
 
-                m_allocator.destroy(current);
-                m_allocator.deallocate(current);
+                release(current);
 
                 return;
             }
@@ -211,10 +245,196 @@ namespace slib {
 
         _that->slot_unbind();
 
+        release(_that);
+    }
+
+    template <typename return_type, typename ... Args>
+    inline void slot< return_type(Args...) >::release(subscriber_type* _that)
+    {
+        leave_group(_that);
+        invalidate(_that);
         m_allocator.destroy(_that);
         m_allocator.deallocate(_that);
     }
 
+    template <typename return_type, typename ... Args>
+    inline void slot< return_type(Args...) >::leave_group(subscriber_type* _that)
+    {
+        connection_group* group = _that->group();
+        if (group != nullptr)
+        {
+            group->remove(_that->extended());
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    inline void slot< return_type(Args...) >::invalidate(subscriber_type* _that)
+    {
+        typedef ::slib::util::subscriber_allocator<subscriber_type> pool_type;
+
+        pool_type::lock_pool();
+        _that->id = 0; // invalidate connection handles
+        pool_type::unlock_pool();
+    }
+
+    template <typename return_type, typename ... Args>
+    slot< return_type(Args...) >* slot< return_type(Args...) >::acquire(const subscriber_type* _that, unsigned int _id)
+    {
+        typedef ::slib::util::subscriber_allocator<subscriber_type> pool_type;
+
+        for (;;)
+        {
+            pool_type::lock_pool();
+            if (_that->id != _id)
+            {
+                pool_type::unlock_pool();
+                return nullptr; // disconnected (slot may be destroyed already)
+            }
+
+            // slot's mutex is not waited for under the pool lock: slot destructor holds it's mutex while it invalidates ids
+            this_type* owner = _that->slot;
+            const bool locked = owner->m_mutex.try_lock();
+            pool_type::unlock_pool();
+
+            if (locked)
+            {
+                return owner; // id can not be changed anymore: it is reset only under locked slot's mutex
+            }
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    inline connection slot< return_type(Args...) >::make_connection(subscriber_type* _that)
+    {
+        return connection(_that, _that->id, &s_connection_operations);
+    }
+
+    template <typename return_type, typename ... Args>
+    void slot< return_type(Args...) >::disconnect(subscriber_type* _that, unsigned int _id)
+    {
+        lock_guard lg(m_mutex);
+
+        if (_that->id != _id)
+        {
+            return; // already disconnected
+        }
+
+        if (_that == m_first)
+        {
+            m_first = _that->slot_list_link.next;
+        }
+
+        _that->slot_unbind();
+        if (_that->signal != nullptr)
+        {
+            _that->signal->remove(_that);
+        }
+
+        release(_that);
+    }
+
+    template <typename return_type, typename ... Args>
+    bool slot< return_type(Args...) >::connected_stub(const void* _subscriber, unsigned int _id)
+    {
+        const subscriber_type* that = static_cast<const subscriber_type*>(_subscriber);
+        this_type* owner = acquire(that, _id);
+        if (owner == nullptr)
+        {
+            return false;
+        }
+
+        lock_guard lg(owner->m_mutex, ::std::adopt_lock);
+        return that->signal != nullptr;
+    }
+
+    template <typename return_type, typename ... Args>
+    void slot< return_type(Args...) >::disconnect_stub(void* _subscriber, unsigned int _id)
+    {
+        subscriber_type* that = static_cast<subscriber_type*>(_subscriber);
+        this_type* owner = acquire(that, _id);
+        if (owner != nullptr)
+        {
+            lock_guard lg(owner->m_mutex, ::std::adopt_lock);
+            owner->disconnect(that, _id);
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    void slot< return_type(Args...) >::block_stub(void* _subscriber, unsigned int _id, bool _blocked)
+    {
+        subscriber_type* that = static_cast<subscriber_type*>(_subscriber);
+        this_type* owner = acquire(that, _id);
+        if (owner == nullptr)
+        {
+            return;
+        }
+
+        lock_guard lg(owner->m_mutex, ::std::adopt_lock);
+        if (that->signal != nullptr)
+        {
+            that->signal->block_connection(that, _blocked);
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    bool slot< return_type(Args...) >::blocked_stub(const void* _subscriber, unsigned int _id)
+    {
+        const subscriber_type* that = static_cast<const subscriber_type*>(_subscriber);
+        this_type* owner = acquire(that, _id);
+        if (owner == nullptr)
+        {
+            return false;
+        }
+
+        lock_guard lg(owner->m_mutex, ::std::adopt_lock);
+        return that->signal != nullptr && that->blocked;
+    }
+
+    template <typename return_type, typename ... Args>
+    bool slot< return_type(Args...) >::join_stub(void* _subscriber, unsigned int _id, connection_group* _group)
+    {
+        subscriber_type* that = static_cast<subscriber_type*>(_subscriber);
+        this_type* owner = acquire(that, _id);
+        if (owner == nullptr)
+        {
+            return false;
+        }
+
+        lock_guard lg(owner->m_mutex, ::std::adopt_lock);
+        if (that->signal == nullptr)
+        {
+            return false;
+        }
+
+        if (that->group() != _group)
+        {
+            leave_group(that);
+
+            typename subscriber_type::extension_type& ext = that->extend();
+            ext.operations = &s_connection_operations;
+            _group->insert(&ext);
+        }
+
+        return true;
+    }
+
+    template <typename return_type, typename ... Args>
+    connection slot< return_type(Args...) >::connection_of_stub(::slib::util::group_node* _node)
+    {
+        subscriber_type* that = static_cast<typename subscriber_type::extension_type*>(_node)->owner;
+        return connection(that, that->id, &s_connection_operations);
+    }
+
+    template <typename return_type, typename ... Args>
+    const ::slib::util::connection_operations slot< return_type(Args...) >::s_connection_operations = {
+        &slot< return_type(Args...) >::connected_stub,
+        &slot< return_type(Args...) >::disconnect_stub,
+        &slot< return_type(Args...) >::block_stub,
+        &slot< return_type(Args...) >::blocked_stub,
+        &slot< return_type(Args...) >::join_stub,
+        &slot< return_type(Args...) >::connection_of_stub
+    };
+
     template <typename return_type, typename ... Args>
     inline bool slot< return_type(Args...) >::connected() const
     {
@@ -222,6 +442,18 @@ namespace slib {
         return m_first != nullptr;
     }
 
+    template <typename return_type, typename ... Args>
+    inline void slot< return_type(Args...) >::enable_lock_statistics(bool _enabled)
+    {
+        m_mutex.set_statistics_enabled(_enabled);
+    }
+
+    template <typename return_type, typename ... Args>
+    inline typename slot< return_type(Args...) >::lock_statistics_type slot< return_type(Args...) >::lock_statistics() const
+    {
+        return m_mutex.statistics();
+    }
+
     //////////////////////////////////////////////////////////////////////////
     //////////////////////////////////////////////////////////////////////////
     //////////////////////////////////////////////////////////////////////////
@@ -231,15 +463,23 @@ namespace slib {
     template <typename return_type, typename ... Args>
     signal< return_type(Args...) >::signal()
         : parent_type(delegate_type::template from_const_method<this_type, &this_type::private_invoke>(this))
-        , m_head(this)
+        , m_state(0)
+        , m_head(nullptr)
+        , m_tail(nullptr)
+        , m_cursors(nullptr)
+        , m_extension(nullptr)
     {
     }
 
     template <typename return_type, typename ... Args>
     signal< return_type(Args...) >::signal(bool _is_threadsafe)
         : parent_type(delegate_type::template from_const_method<this_type, &this_type::private_invoke>(this), _is_threadsafe)
-        , m_head(this)
         , m_mutex(_is_threadsafe)
+        , m_state(_is_threadsafe ? threadsafe_state : 0U)
+        , m_head(nullptr)
+        , m_tail(nullptr)
+        , m_cursors(nullptr)
+        , m_extension(nullptr)
     {
     }
 
@@ -247,7 +487,31 @@ namespace slib {
     signal< return_type(Args...) >::~signal()
     {
         m_deleted = true;
+
+        extension* ext = extended();
+        if (ext != nullptr)
+        {
+            ext->recorder = nullptr;
+        }
+
         disconnect();
+
+        // This signal is destroyed by one of it's slots: emissions in progress must return without touching it
+        for (emission_cursor* cursor = m_cursors; cursor != nullptr; cursor = cursor->outer)
+        {
+            cursor->alive = false;
+            m_mutex.unlock(); // every emission holds one lock of the mutex
+        }
+        m_cursors = nullptr;
+
+        parent_type::disconnect(); // upstream signals use extension while removing this signal
+
+        ext = extended(); // extension may be created by upstream signals
+        if (ext != nullptr)
+        {
+            ::slib::util::signal_graph::release(ext->graph);
+            delete ext;
+        }
     }
 
     template <typename return_type, typename ... Args>
@@ -261,6 +525,8 @@ namespace slib {
     {
         parent_type::set_threadsafe(_is_threadsafe);
         m_mutex.set_threadsafe(_is_threadsafe);
+        set_state(threadsafe_state, _is_threadsafe);
+        topology_changed();
     }
 
     template <typename return_type, typename ... Args>
@@ -274,36 +540,95 @@ namespace slib {
     {
         lock_guard lg(m_mutex);
 
-        subscriber_type* current = m_head.signal_list_link.next;
+        extension* ext = extended();
+        recorder_type* recorder = active_recorder();
+
+        subscriber_type* current = m_head;
         while (current != nullptr)
         {
             subscriber_type* next = current->signal_list_link.next;
 
+            if (recorder != nullptr)
+            {
+                ext->recording->disconnect(recorder, ext->trace_id, trace_id_of(current->slot));
+            }
+
+            unlink_downstream(current);
+
             current->signal_unbind();
             current->slot->detach(current);
 
             current = next;
         }
 
-        m_head.signal_list_link.prev = nullptr;
-        m_head.signal_list_link.next = nullptr;
+        for (emission_cursor* cursor = m_cursors; cursor != nullptr; cursor = cursor->outer)
+        {
+            cursor->next = nullptr; // stop emissions in progress
+        }
+
+        m_head = nullptr;
+        m_tail = nullptr;
+        set_state(blocked_connections_state | affine_connections_state, false);
+        topology_changed();
+
+        if (ext == nullptr)
+        {
+            return;
+        }
+
+        ext->priorities.clear();
+        ext->blocked_connections = 0;
+        ext->affine_connections = 0;
+
+        if (ext->index != nullptr)
+        {
+            ::std::fill(ext->index->buckets.begin(), ext->index->buckets.end(), index_entry {nullptr, 0});
+            ext->index->size = 0;
+        }
     }
 
     template <typename return_type, typename ... Args>
-    void signal< return_type(Args...) >::insert(subscriber_type* _subscriber) const
+    bool signal< return_type(Args...) >::insert(subscriber_type* _subscriber) const
     {
         lock_guard lg(m_mutex);
 
-        _subscriber->signal_list_link.next = m_head.signal_list_link.next;
-        m_head.signal_list_link.next = _subscriber;
+        extension* ext = extended();
+        const bool indexed = ext != nullptr && ext->index != nullptr;
 
-        if (_subscriber->signal_list_link.next != nullptr)
+        if (indexed && index_find(_subscriber->slot, false) != nullptr)
         {
-            _subscriber->signal_list_link.next->signal_list_link.prev = _subscriber;
+            return false;
         }
 
-        _subscriber->signal_list_link.prev = &m_head;
-        _subscriber->signal = this;
+        if (!accept_connection(_subscriber))
+        {
+            return false;
+        }
+
+        if (indexed)
+        {
+            index_insert(_subscriber);
+        }
+
+        link(_subscriber);
+
+        if (ext == nullptr)
+        {
+            return true; // neither profiling nor recording is enabled
+        }
+
+        if (ext->timing != nullptr && _subscriber->histogram() == nullptr)
+        {
+            _subscriber->extend().histogram = ::slib::util::guarded_new<::slib::util::latency_histogram>();
+        }
+
+        recorder_type* recorder = ext->recorder.load(::std::memory_order_relaxed);
+        if (recorder != nullptr)
+        {
+            ext->recording->connect(recorder, ext->trace_id, trace_id_of(_subscriber->slot), _subscriber->priority());
+        }
+
+        return true;
     }
 
     template <typename return_type, typename ... Args>
@@ -312,63 +637,1217 @@ namespace slib {
         if (_subscriber->signal == this && !m_deleted)
         {
             lock_guard lg(m_mutex);
-            _subscriber->signal_unbind();
+            unlink(_subscriber);
         }
     }
 
     template <typename return_type, typename ... Args>
-    inline void signal< return_type(Args...) >::connect(slot_type& _slot) const
+    void signal< return_type(Args...) >::link(subscriber_type* _subscriber) const
     {
-        subscriber_type* subscriber = _slot.get_new_subscriber();
-        if (subscriber != nullptr)
+        subscriber_type* after; // new subscriber is inserted after this one (nullptr to insert it at the head)
+
+        const extension* ext = extended();
+        const int priority = _subscriber->priority();
+        if ((ext == nullptr || ext->priorities.empty()) && priority == 0)
+        {
+            // all slots have default priority: just append to the end of the list
+            after = m_tail;
+        }
+        else
+        {
+            priorities_type& priorities = extend().priorities;
+            if (priorities.empty() && m_tail != nullptr)
+            {
+                priorities.push_back(priority_bucket {0, m_tail});
+            }
+
+            auto bucket = ::std::lower_bound(priorities.begin(), priorities.end(), priority,
+                [](const priority_bucket& _bucket, int _priority) { return _bucket.priority > _priority; });
+
+            if (bucket != priorities.end() && bucket->priority == priority)
+            {
+                after = bucket->last;
+                bucket->last = _subscriber;
+            }
+            else
+            {
+                after = bucket == priorities.begin() ? nullptr : (bucket - 1)->last;
+                priorities.insert(bucket, priority_bucket {priority, _subscriber});
+            }
+        }
+
+        subscriber_type*& place = after != nullptr ? after->signal_list_link.next : m_head;
+
+        _subscriber->signal_list_link.prev = after;
+        _subscriber->signal_list_link.next = place;
+        if (place != nullptr)
+        {
+            place->signal_list_link.prev = _subscriber;
+        }
+        else
+        {
+            m_tail = _subscriber;
+        }
+
+        place = _subscriber;
+        _subscriber->signal = this;
+
+        const this_type* downstream = signal_of(_subscriber->slot);
+        if (downstream != nullptr)
         {
-            insert(subscriber);
+            extension& downstream_ext = downstream->extend();
+            ++downstream_ext.upstreams;
+
+            if (_subscriber->guarded && downstream_ext.guards++ == 0)
+            {
+                // guarded signals are not flattened (downstream's generation is changed without locking it's mutex)
+                downstream->set_state(guarded_state, true);
+                ++downstream_ext.generation;
+                ++::slib::util::topology_changes();
+            }
+        }
+
+        if (_subscriber->affinity() != nullptr && extend().affine_connections++ == 0)
+        {
+            set_state(affine_connections_state, true);
         }
+
+        topology_changed();
     }
 
     template <typename return_type, typename ... Args>
-    inline void signal< return_type(Args...) >::disconnect(slot_type& _slot) const
+    void signal< return_type(Args...) >::unlink(subscriber_type* _subscriber) const
     {
-        _slot.disconnect(*this);
+        extension* ext = extended();
+
+        recorder_type* recorder = active_recorder();
+        if (recorder != nullptr)
+        {
+            ext->recording->disconnect(recorder, ext->trace_id, trace_id_of(_subscriber->slot));
+        }
+
+        if (ext != nullptr && ext->index != nullptr)
+        {
+            index_erase(_subscriber);
+        }
+
+        subscriber_type* prev = _subscriber->signal_list_link.prev;
+
+        if (ext != nullptr && !ext->priorities.empty())
+        {
+            priorities_type& priorities = ext->priorities;
+            const int priority = _subscriber->priority();
+            auto bucket = ::std::lower_bound(priorities.begin(), priorities.end(), priority,
+                [](const priority_bucket& _bucket, int _priority) { return _bucket.priority > _priority; });
+
+            if (bucket != priorities.end() && bucket->last == _subscriber)
+            {
+                if (prev != nullptr && prev->priority() == priority)
+                {
+                    bucket->last = prev;
+                }
+                else
+                {
+                    priorities.erase(bucket);
+                    if (priorities.size() == 1 && priorities.front().priority == 0)
+                    {
+                        priorities.clear(); // only default priority left
+                    }
+                }
+            }
+        }
+
+        if (m_tail == _subscriber)
+        {
+            m_tail = prev;
+        }
+
+        unlink_downstream(_subscriber);
+
+        if (_subscriber->blocked)
+        {
+            _subscriber->blocked = false;
+            if (--ext->blocked_connections == 0)
+            {
+                set_state(blocked_connections_state, false);
+            }
+        }
+
+        if (_subscriber->affinity() != nullptr && --ext->affine_connections == 0)
+        {
+            set_state(affine_connections_state, false);
+        }
+
+        for (emission_cursor* cursor = m_cursors; cursor != nullptr; cursor = cursor->outer)
+        {
+            if (cursor->next == _subscriber)
+            {
+                cursor->next = _subscriber->signal_list_link.next; // invoked slot removes subscriber which is going to be invoked
+            }
+        }
+
+        if (m_head == _subscriber)
+        {
+            m_head = _subscriber->signal_list_link.next;
+        }
+
+        _subscriber->signal_unbind();
+        topology_changed();
     }
 
     template <typename return_type, typename ... Args>
-    void signal< return_type(Args...) >::private_emit(Args&&... _args) const
+    inline void signal< return_type(Args...) >::topology_changed() const
     {
-        lock_guard lg(m_mutex);
+        extension* ext = extended();
+        if (ext == nullptr || (ext->flat == nullptr && ext->upstreams.load(::std::memory_order_relaxed) == 0))
+        {
+            return; // this signal can not be a part of any flattened cache
+        }
 
-        subscriber_type* current = m_head.signal_list_link.next;
-        while (current != nullptr)
+        if (ext->flat != nullptr)
         {
-            subscriber_type* next = current->signal_list_link.next;
-            current->slot->operator()(::std::forward<Args>(_args)...); // call signal handler
-            current = next;
+            ext->flat->valid = false;
         }
+
+        ++ext->generation;
+        ++::slib::util::topology_changes(); // lets flattened emission in progress notice the change
     }
 
     template <typename return_type, typename ... Args>
-    inline void signal< return_type(Args...) >::emit_(Args... _args) const
+    inline void signal< return_type(Args...) >::block()
     {
-        private_emit(::std::forward<Args>(_args)...);
+        m_state += blocked_state;
+
+        lock_guard lg(m_mutex);
+        topology_changed();
     }
 
     template <typename return_type, typename ... Args>
-    inline void signal< return_type(Args...) >::operator ()(Args... _args) const
+    inline void signal< return_type(Args...) >::unblock()
     {
-        private_emit(::std::forward<Args>(_args)...);
+        m_state -= blocked_state;
+
+        lock_guard lg(m_mutex);
+        topology_changed();
     }
 
     template <typename return_type, typename ... Args>
-    inline bool signal< return_type(Args...) >::connected() const
+    inline bool signal< return_type(Args...) >::blocked() const
     {
-        lock_guard lg(m_mutex);
-        return m_head.signal_list_link.next != nullptr;
+        return m_state.load(::std::memory_order_relaxed) >= blocked_state;
     }
 
     template <typename return_type, typename ... Args>
-    inline return_type signal< return_type(Args...) >::private_invoke(Args... _args) const
+    void signal< return_type(Args...) >::block_connection(subscriber_type* _subscriber, bool _blocked) const
     {
-        private_emit(::std::forward<Args>(_args)...);
+        lock_guard lg(m_mutex);
+
+        if (_subscriber->blocked != _blocked)
+        {
+            _subscriber->blocked = _blocked;
+
+            extension& ext = extend();
+            if (_blocked ? ext.blocked_connections++ == 0 : --ext.blocked_connections == 0)
+            {
+                set_state(blocked_connections_state, _blocked);
+            }
+
+            topology_changed();
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::set_connection_affinity(subscriber_type* _subscriber, ::slib::util::dispatcher* _dispatcher) const
+    {
+        lock_guard lg(m_mutex);
+
+        if ((_subscriber->affinity() != nullptr) != (_dispatcher != nullptr))
+        {
+            extension& ext = extend();
+            if (_dispatcher != nullptr ? ext.affine_connections++ == 0 : --ext.affine_connections == 0)
+            {
+                set_state(affine_connections_state, _dispatcher != nullptr);
+            }
+
+            topology_changed();
+        }
+
+        if (_dispatcher != nullptr || _subscriber->affinity() != nullptr)
+        {
+            _subscriber->extend().affinity = _dispatcher;
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    inline void signal< return_type(Args...) >::invoke_affine(const subscriber_type* _subscriber, Args&&... _args)
+    {
+        const slot_type* target = _subscriber->slot;
+        ::slib::util::dispatcher* owner = _subscriber->affinity();
+        if (owner == nullptr || !target->m_affinity->deliver(*target, owner, _args...))
+        {
+            target->operator()(::std::forward<Args>(_args)...); // call signal handler
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    inline void signal< return_type(Args...) >::set_cycle_policy(cycle_policy _policy)
+    {
+        extend().cycle = _policy;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline cycle_policy signal< return_type(Args...) >::cycle_handling() const
+    {
+        const extension* ext = extended();
+        return ext != nullptr ? ext->cycle : cycle_policy::reject;
+    }
+
+    template <typename return_type, typename ... Args>
+    bool signal< return_type(Args...) >::accept_connection(subscriber_type* _subscriber) const
+    {
+        const this_type* downstream = signal_of(_subscriber->slot);
+        if (downstream == nullptr)
+        {
+            return true;
+        }
+
+        extension& ext = extend();
+        if (::slib::util::signal_graph::insert(ext.graph, downstream->extend().graph))
+        {
+            return true;
+        }
+
+        switch (ext.cycle)
+        {
+            case cycle_policy::allow_guarded:
+                _subscriber->guarded = true;
+                return true;
+
+            case cycle_policy::assertion:
+                assert(false && "signal-to-signal connection creates a cycle");
+                return false;
+
+            default:
+                return false;
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::unlink_downstream(const subscriber_type* _subscriber) const
+    {
+        const this_type* downstream = signal_of(_subscriber->slot);
+        if (downstream == nullptr)
+        {
+            return;
+        }
+
+        extension& downstream_ext = *downstream->extended();
+        --downstream_ext.upstreams;
+
+        if (!_subscriber->guarded)
+        {
+            ::slib::util::signal_graph::erase(extended()->graph, downstream_ext.graph);
+        }
+        else if (--downstream_ext.guards == 0)
+        {
+            // the last guarded connection is removed: downstream can be flattened again
+            downstream->set_state(guarded_state, false);
+            ++downstream_ext.generation;
+            ++::slib::util::topology_changes();
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::set_flattening(bool _enabled)
+    {
+        lock_guard lg(m_mutex);
+
+        extension* ext = extended();
+        if (!_enabled)
+        {
+            if (ext != nullptr)
+            {
+                set_state(flattening_state, false);
+                delete ext->flat;
+                ext->flat = nullptr;
+            }
+        }
+        else if (ext == nullptr || ext->flat == nullptr)
+        {
+            extend().flat = ::slib::util::guarded_new<flat_cache>();
+            set_state(flattening_state, true);
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    inline bool signal< return_type(Args...) >::flattening() const
+    {
+        return (m_state.load(::std::memory_order_relaxed) & flattening_state) != 0;
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::flatten(const this_type& _signal, leaves_type& _leaves, flat_signals_type* _signals)
+    {
+        for (const subscriber_type* current = _signal.m_head; current != nullptr; current = current->signal_list_link.next)
+        {
+            if (current->blocked)
+            {
+                continue;
+            }
+
+            const this_type* downstream = signal_of(current->slot);
+            if (downstream == nullptr)
+            {
+                _leaves.push_back(current->slot);
+                continue;
+            }
+
+            if (_signals != nullptr)
+            {
+                // Every visited signal is remembered: unblocking it or changing it's flags changes the cache too
+                _signals->push_back(flat_signal(downstream, downstream->extended()->generation.load(::std::memory_order_relaxed)));
+            }
+
+            const unsigned int state = downstream->m_state.load(::std::memory_order_relaxed);
+            if (state >= blocked_state)
+            {
+                continue;
+            }
+
+            if ((state & (threadsafe_state | profiling_state | guarded_state | affine_connections_state)) == 0)
+            {
+                flatten(*downstream, _leaves, _signals);
+            }
+            else
+            {
+                _leaves.push_back(current->slot);
+            }
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    bool signal< return_type(Args...) >::unchanged(const flat_signals_type& _signals)
+    {
+        for (size_t i = 0, number = _signals.size(); i < number; ++i)
+        {
+            if (_signals[i].first->extended()->generation.load(::std::memory_order_relaxed) != _signals[i].second)
+            {
+                return false; // signals after the changed one may be destroyed already
+            }
+        }
+
+        return true;
+    }
+
+    template <typename return_type, typename ... Args>
+    bool signal< return_type(Args...) >::private_emit_flat(const emission_cursor& _cursor, Args&&... _args) const
+    {
+        extension& ext = *extended();
+        flat_cache& cache = *ext.flat;
+
+        if (!cache.valid || !unchanged(cache.signals))
+        {
+            if (cache.depth != 0)
+            {
+                return false; // leaves are being iterated by outer emission
+            }
+
+            cache.leaves.clear();
+            cache.signals.clear();
+            cache.signals.push_back(flat_signal(this, ext.generation.load(::std::memory_order_relaxed)));
+            flatten(*this, cache.leaves, &cache.signals);
+            cache.valid = true;
+        }
+
+        unsigned long long changes = ::slib::util::topology_changes();
+
+        ++cache.depth;
+        const size_t number = cache.leaves.size();
+        for (size_t i = 0; i < number; ++i)
+        {
+            if (changes != ::slib::util::topology_changes())
+            {
+                if (!_cursor.alive)
+                {
+                    return true; // this signal (and it's cache) has been destroyed by invoked slot
+                }
+
+                if (!cache.valid || !unchanged(cache.signals))
+                {
+                    // invoked slot has changed topology: cached leaves can not be trusted any more
+                    private_emit_flat_changed(_cursor, i, ::std::forward<Args>(_args)...);
+                    break;
+                }
+
+                changes = ::slib::util::topology_changes(); // invoked slot has changed unrelated signals only
+            }
+
+            cache.leaves[i]->operator()(::std::forward<Args>(_args)...); // call signal handler
+        }
+
+        if (_cursor.alive)
+        {
+            --cache.depth;
+        }
+
+        return true;
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::private_emit_flat_changed(const emission_cursor& _cursor, size_t _position, Args&&... _args) const
+    {
+        const leaves_type& leaves = extended()->flat->leaves;
+
+        leaves_type reachable;
+        unsigned long long changes = 0;
+
+        for (size_t i = _position, number = leaves.size(); i < number && _cursor.alive; ++i)
+        {
+            const unsigned long long current = ::slib::util::topology_changes();
+            if (reachable.empty() || current != changes)
+            {
+                reachable.clear();
+                flatten(*this, reachable, nullptr);
+                ::std::sort(reachable.begin(), reachable.end());
+                changes = current;
+            }
+
+            const slot_type* leaf = leaves[i];
+            if (::std::binary_search(reachable.begin(), reachable.end(), leaf))
+            {
+                leaf->operator()(::std::forward<Args>(_args)...); // call signal handler
+            }
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    inline connection signal< return_type(Args...) >::connect(slot_type& _slot, int _priority) const
+    {
+        return _slot.connect(*this, _priority);
+    }
+
+    template <typename return_type, typename ... Args>
+    inline void signal< return_type(Args...) >::disconnect(slot_type& _slot) const
+    {
+        lock_guard lg(m_mutex);
+
+        const extension* ext = extended();
+        if (ext == nullptr || ext->index == nullptr)
+        {
+            lg.unlock();
+            _slot.disconnect(*this);
+            return;
+        }
+
+        subscriber_type* subscriber = index_find(&_slot, true);
+        if (subscriber != nullptr)
+        {
+            const unsigned int id = subscriber->id;
+            lg.unlock(); // slot locks it's own mutex first
+            _slot.disconnect(subscriber, id);
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    template <class slot_iterator>
+    size_t signal< return_type(Args...) >::connect(slot_iterator _first, slot_iterator _last, connection* _connections, int _priority) const
+    {
+        // Allocate subscribers without locking the signal.
+        // New subscribers are chained in order of connection.
+        subscriber_type* chain = nullptr;
+        subscriber_type* chain_last = nullptr;
+        size_t number = 0;
+        for (; _first != _last; ++_first, ++number)
+        {
+            slot_type& slt = slot_ref(*_first);
+            subscriber_type* subscriber = slt.get_new_subscriber(_priority);
+
+            if (_connections != nullptr)
+            {
+                _connections[number] = subscriber == nullptr ? connection() : slt.make_connection(subscriber);
+            }
+
+            if (subscriber != nullptr)
+            {
+                subscriber->signal_list_link.next = nullptr;
+                if (chain_last != nullptr)
+                {
+                    chain_last->signal_list_link.next = subscriber;
+                }
+                else
+                {
+                    chain = subscriber;
+                }
+                chain_last = subscriber;
+            }
+        }
+
+        if (chain == nullptr)
+        {
+            return 0;
+        }
+
+        size_t connected = 0;
+        subscriber_type* rejected = nullptr;
+
+        lock_guard lg(m_mutex);
+
+        extension* ext = extended();
+        const bool indexed = ext != nullptr && ext->index != nullptr;
+        const bool profiled = ext != nullptr && ext->timing != nullptr;
+        recorder_type* recorder = active_recorder();
+
+        while (chain != nullptr)
+        {
+            subscriber_type* current = chain;
+            chain = current->signal_list_link.next;
+
+            if ((indexed && index_find(current->slot, false) != nullptr) || !accept_connection(current))
+            {
+                current->signal_list_link.next = rejected; // duplicate or cycle
+                rejected = current;
+                continue;
+            }
+
+            if (indexed)
+            {
+                index_insert(current);
+            }
+
+            link(current);
+
+            if (profiled && current->histogram() == nullptr)
+            {
+                current->extend().histogram = ::slib::util::guarded_new<::slib::util::latency_histogram>();
+            }
+
+            if (recorder != nullptr)
+            {
+                ext->recording->connect(recorder, ext->trace_id, trace_id_of(current->slot), current->priority());
+            }
+
+            ++connected;
+        }
+
+        if (rejected != nullptr && _connections != nullptr)
+        {
+            // subscribers of accepted connections can not be unbinded while signal is locked
+            for (size_t i = 0; i < number; ++i)
+            {
+                if (!_connections[i].empty() && static_cast<const subscriber_type*>(_connections[i].subscriber())->signal != this)
+                {
+                    _connections[i] = connection();
+                }
+            }
+        }
+
+        lg.unlock();
+
+        while (rejected != nullptr)
+        {
+            subscriber_type* current = rejected;
+            rejected = current->signal_list_link.next;
+            current->signal_list_link.next = nullptr;
+            current->slot->detach(current);
+        }
+
+        return connected;
+    }
+
+    template <typename return_type, typename ... Args>
+    template <class slot_iterator>
+    size_t signal< return_type(Args...) >::disconnect(slot_iterator _first, slot_iterator _last) const
+    {
+        size_t disconnected = 0;
+
+        lock_guard lg(m_mutex);
+
+        for (; _first != _last; ++_first)
+        {
+            slot_type& slt = slot_ref(*_first);
+            if (slt.m_deleted)
+            {
+                continue;
+            }
+
+            // slot's connections list is usually much shorter than signal's slots list
+            typename slot_type::lock_guard slg(slt.m_mutex);
+
+            subscriber_type* current = slt.m_first;
+            while (current != nullptr)
+            {
+                subscriber_type* next = current->slot_list_link.next;
+
+                if (current->signal == this)
+                {
+                    unlink(current);
+
+                    if (current == slt.m_first)
+                    {
+                        slt.m_first = next;
+                    }
+
+                    current->slot_unbind();
+                    slt.release(current);
+                    ++disconnected;
+                }
+
+                current = next;
+            }
+        }
+
+        return disconnected;
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::set_unique_connections(unique_connections _mode)
+    {
+        lock_guard lg(m_mutex);
+
+        extension* ext = extended();
+        if (ext != nullptr)
+        {
+            delete ext->index;
+            ext->index = nullptr;
+        }
+
+        if (_mode == unique_connections::none)
+        {
+            return;
+        }
+
+        extend().index = ::slib::util::guarded_new<connection_index>(_mode);
+        for (subscriber_type* current = m_head; current != nullptr; current = current->signal_list_link.next)
+        {
+            index_insert(current);
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    inline unique_connections signal< return_type(Args...) >::uniqueness() const
+    {
+        const extension* ext = extended();
+        return ext == nullptr || ext->index == nullptr ? unique_connections::none : ext->index->mode;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline unsigned int signal< return_type(Args...) >::index_hash(const slot_type* _slot) const
+    {
+        size_t value;
+        if (extended()->index->mode == unique_connections::by_slot)
+        {
+            value = reinterpret_cast<size_t>(_slot);
+            value ^= value >> 17;
+            value *= static_cast<size_t>(0x9e3779b97f4a7c15ULL);
+        }
+        else
+        {
+            value = static_cast<const delegate_type&>(*_slot).hash();
+            value *= static_cast<size_t>(0x9e3779b97f4a7c15ULL);
+        }
+
+        return static_cast<unsigned int>(value ^ (value >> 32 >> 1));
+    }
+
+    template <typename return_type, typename ... Args>
+    size_t signal< return_type(Args...) >::index_position(const subscriber_type* _subscriber) const
+    {
+        const buckets_type& buckets = extended()->index->buckets;
+        const size_t mask = buckets.size() - 1;
+
+        for (size_t i = index_hash(_subscriber->slot) & mask; buckets[i].subscriber != nullptr; i = (i + 1) & mask)
+        {
+            if (buckets[i].subscriber == _subscriber)
+            {
+                return i;
+            }
+        }
+
+        // slot has been rebound after indexing (it's hash has changed)
+        for (size_t i = 0; i < buckets.size(); ++i)
+        {
+            if (buckets[i].subscriber == _subscriber)
+            {
+                return i;
+            }
+        }
+
+        return buckets.size();
+    }
+
+    template <typename return_type, typename ... Args>
+    typename signal< return_type(Args...) >::subscriber_type* signal< return_type(Args...) >::index_find(const slot_type* _slot, bool _exact) const
+    {
+        const connection_index& index = *extended()->index;
+        const unsigned int hash = index_hash(_slot);
+        const size_t mask = index.buckets.size() - 1;
+
+        for (size_t i = hash & mask; index.buckets[i].subscriber != nullptr; i = (i + 1) & mask)
+        {
+            const index_entry& entry = index.buckets[i];
+            if (entry.hash != hash)
+            {
+                continue;
+            }
+
+            if (entry.subscriber->slot == _slot)
+            {
+                return entry.subscriber;
+            }
+
+            if (!_exact && index.mode == unique_connections::by_delegate &&
+                static_cast<const delegate_type&>(*entry.subscriber->slot) == static_cast<const delegate_type&>(*_slot))
+            {
+                return entry.subscriber;
+            }
+        }
+
+        return nullptr;
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::index_insert(subscriber_type* _subscriber) const
+    {
+        connection_index& index = *extended()->index;
+
+        if ((index.size + 1) * 2 > index.buckets.size())
+        {
+            // grow twice and redistribute all subscribers
+            buckets_type buckets(index.buckets.size() << 1, index_entry {nullptr, 0});
+            const size_t mask = buckets.size() - 1;
+
+            for (const index_entry& entry : index.buckets)
+            {
+                if (entry.subscriber != nullptr)
+                {
+                    size_t i = entry.hash & mask;
+                    while (buckets[i].subscriber != nullptr)
+                    {
+                        i = (i + 1) & mask;
+                    }
+
+                    buckets[i] = entry;
+                }
+            }
+
+            index.buckets.swap(buckets);
+        }
+
+        const unsigned int hash = index_hash(_subscriber->slot);
+        const size_t mask = index.buckets.size() - 1;
+
+        size_t i = hash & mask;
+        while (index.buckets[i].subscriber != nullptr)
+        {
+            i = (i + 1) & mask;
+        }
+
+        index.buckets[i] = index_entry {_subscriber, hash};
+        ++index.size;
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::index_erase(subscriber_type* _subscriber) const
+    {
+        connection_index& index = *extended()->index;
+        const size_t mask = index.buckets.size() - 1;
+
+        size_t hole = index_position(_subscriber);
+        if (hole == index.buckets.size())
+        {
+            return;
+        }
+
+        // Entries after the hole are shifted back unless it moves them before their home bucket
+        for (size_t i = (hole + 1) & mask; index.buckets[i].subscriber != nullptr; i = (i + 1) & mask)
+        {
+            const size_t home = index.buckets[i].hash & mask;
+            if (((i - home) & mask) >= ((i - hole) & mask))
+            {
+                index.buckets[hole] = index.buckets[i];
+                hole = i;
+            }
+        }
+
+        index.buckets[hole] = index_entry {nullptr, 0};
+        --index.size;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline void signal< return_type(Args...) >::private_emit(Args&&... _args) const
+    {
+        emission_cursor cursor(*this, nullptr);
+
+        subscriber_type* current = m_head;
+        while (current != nullptr)
+        {
+            cursor.next = current->signal_list_link.next;
+            current->slot->operator()(::std::forward<Args>(_args)...); // call signal handler
+            current = cursor.next;
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::private_emit_special(unsigned int _state, Args&&... _args) const
+    {
+        if (_state >= blocked_state)
+        {
+            return;
+        }
+
+        ::slib::util::emission_scope scope((_state & threadsafe_state) != 0); // full queues are waited for after unlocking
+        lock_guard lg(m_mutex);
+        emission_cursor cursor(*this, &lg);
+
+        const unsigned int state = m_state.load(::std::memory_order_relaxed); // flags of connections are changed under locked mutex
+
+        if ((state & profiling_state) != 0)
+        {
+            profiler& timing = *extended()->timing;
+            if (--timing.countdown == 0)
+            {
+                timing.countdown = timing.sample_every;
+                private_emit_profiled(cursor, ::std::forward<Args>(_args)...);
+                return;
+            }
+        }
+
+        if ((state & (flattening_state | affine_connections_state)) == flattening_state && private_emit_flat(cursor, ::std::forward<Args>(_args)...))
+        {
+            return;
+        }
+
+        subscriber_type* current = m_head;
+
+        if ((state & (blocked_connections_state | affine_connections_state)) != 0)
+        {
+            while (current != nullptr)
+            {
+                cursor.next = current->signal_list_link.next;
+                if (!current->blocked)
+                {
+                    invoke_affine(current, ::std::forward<Args>(_args)...);
+                }
+                current = cursor.next;
+            }
+
+            return;
+        }
+
+        while (current != nullptr)
+        {
+            cursor.next = current->signal_list_link.next;
+            current->slot->operator()(::std::forward<Args>(_args)...); // call signal handler
+            current = cursor.next;
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::private_emit_profiled(emission_cursor& _cursor, Args&&... _args) const
+    {
+        typedef ::std::chrono::steady_clock clock_type;
+
+        const profiler& timing = *extended()->timing;
+
+        subscriber_type* current = m_head;
+        while (current != nullptr)
+        {
+            _cursor.next = current->signal_list_link.next;
+            const slot_type* slot = current->slot;
+
+            if (current->blocked)
+            {
+                current = _cursor.next;
+                continue;
+            }
+
+            const unsigned int id = current->id;
+            const auto start = clock_type::now();
+            invoke_affine(current, ::std::forward<Args>(_args)...);
+            const auto elapsed = static_cast<unsigned long long>(
+                ::std::chrono::duration_cast<::std::chrono::nanoseconds>(clock_type::now() - start).count());
+
+            if (current->id != id)
+            {
+                // subscriber (and maybe slot or this signal) has been removed by invoked slot (it's memory is kept in the pool)
+                current = _cursor.next;
+                continue;
+            }
+
+            ::slib::util::latency_histogram* histogram = current->histogram();
+            if (histogram != nullptr)
+            {
+                histogram->record(elapsed);
+            }
+
+            if (timing.budget != 0 && elapsed > timing.budget)
+            {
+                timing.on_slow_slot(*slot, elapsed);
+            }
+
+            current = _cursor.next;
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::enable_profiling(unsigned int _sample_every, unsigned long long _budget, const slow_slot_handler& _on_slow_slot)
+    {
+        lock_guard lg(m_mutex);
+
+        extension& ext = extend();
+        if (ext.timing == nullptr)
+        {
+            ext.timing = ::slib::util::guarded_new<profiler>();
+        }
+
+        ext.timing->on_slow_slot = _on_slow_slot;
+        ext.timing->budget = _budget;
+        ext.timing->sample_every = _sample_every == 0 ? 1 : _sample_every;
+        ext.timing->countdown = 1; // time the very next emission
+        set_state(profiling_state, true);
+        topology_changed();
+
+        for (subscriber_type* current = m_head; current != nullptr; current = current->signal_list_link.next)
+        {
+            if (current->histogram() == nullptr)
+            {
+                current->extend().histogram = ::slib::util::guarded_new<::slib::util::latency_histogram>();
+            }
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::disable_profiling()
+    {
+        lock_guard lg(m_mutex);
+
+        extension* ext = extended();
+        if (ext == nullptr || ext->timing == nullptr)
+        {
+            return;
+        }
+
+        set_state(profiling_state, false);
+        delete ext->timing;
+        ext->timing = nullptr;
+        topology_changed();
+
+        for (subscriber_type* current = m_head; current != nullptr; current = current->signal_list_link.next)
+        {
+            typename subscriber_type::extension_type* current_ext = current->extended();
+            if (current_ext != nullptr)
+            {
+                delete current_ext->histogram;
+                current_ext->histogram = nullptr;
+            }
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    inline bool signal< return_type(Args...) >::profiling() const
+    {
+        return (m_state.load(::std::memory_order_relaxed) & profiling_state) != 0;
+    }
+
+    template <typename return_type, typename ... Args>
+    ::std::vector<typename signal< return_type(Args...) >::slot_latency_type> signal< return_type(Args...) >::slowest(size_t _number) const
+    {
+        typedef ::slib::util::latency_histogram::value_type value_type;
+        typedef ::std::pair<value_type, const subscriber_type*>  rank_type;
+
+        ::std::vector<rank_type, ::slib::util::guarded_allocator<rank_type> > ranks;
+        ::std::vector<slot_latency_type> result;
+
+        lock_guard lg(m_mutex);
+
+        for (const subscriber_type* current = m_head; current != nullptr; current = current->signal_list_link.next)
+        {
+            const ::slib::util::latency_histogram* histogram = current->histogram();
+            if (histogram != nullptr && histogram->count() != 0)
+            {
+                ranks.push_back(rank_type(histogram->percentile(99.0), current)); // percentile is evaluated once per connection
+            }
+        }
+
+        if (_number > ranks.size())
+        {
+            _number = ranks.size();
+        }
+
+        ::std::partial_sort(ranks.begin(), ranks.begin() + _number, ranks.end(), [](const rank_type& _left, const rank_type& _right)
+        {
+            return _left.first > _right.first;
+        });
+
+        // Only the slowest histograms are copied (histograms are copied under lock: subscribers may be disconnected after unlock)
+        if (_number != 0)
+        {
+            ::slib::util::on_allocation(); // returned list
+            result.reserve(_number);
+        }
+
+        for (size_t i = 0; i < _number; ++i)
+        {
+            result.push_back(slot_latency_type(ranks[i].second->slot, *ranks[i].second->histogram()));
+        }
+
+        return result;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline void signal< return_type(Args...) >::enable_lock_statistics(bool _enabled)
+    {
+        parent_type::enable_lock_statistics(_enabled);
+        m_mutex.set_statistics_enabled(_enabled);
+    }
+
+    template <typename return_type, typename ... Args>
+    inline typename signal< return_type(Args...) >::lock_statistics_type signal< return_type(Args...) >::lock_statistics() const
+    {
+        lock_statistics_type statistics = m_mutex.statistics();
+        statistics.merge(parent_type::lock_statistics());
+        return statistics;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline const signal< return_type(Args...) >* signal< return_type(Args...) >::signal_of(const slot_type* _slot)
+    {
+        this_type* that = static_cast<this_type*>(const_cast<void*>(_slot->obj()));
+        if (that != nullptr && static_cast<const delegate_type&>(*_slot) == delegate_type::template from_const_method<this_type, &this_type::private_invoke>(that))
+        {
+            return that;
+        }
+
+        return nullptr;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline unsigned int signal< return_type(Args...) >::trace_id_of(const slot_type* _slot) const
+    {
+        const this_type* that = signal_of(_slot);
+        return that != nullptr && that->active_recorder() == active_recorder() ? that->extended()->trace_id : 0;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline typename signal< return_type(Args...) >::extension* signal< return_type(Args...) >::extended() const
+    {
+        return m_extension.load(::std::memory_order_acquire);
+    }
+
+    template <typename return_type, typename ... Args>
+    typename signal< return_type(Args...) >::extension& signal< return_type(Args...) >::extend() const
+    {
+        extension* ext = m_extension.load(::std::memory_order_acquire);
+        if (ext == nullptr)
+        {
+            extension* created = ::slib::util::guarded_new<extension>();
+            if (m_extension.compare_exchange_strong(ext, created, ::std::memory_order_acq_rel))
+            {
+                ext = created;
+            }
+            else
+            {
+                delete created; // extension has been created by upstream signal meanwhile
+            }
+        }
+
+        return *ext;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline void signal< return_type(Args...) >::set_state(unsigned int _flags, bool _enabled) const
+    {
+        if (_enabled)
+        {
+            m_state.fetch_or(_flags, ::std::memory_order_relaxed);
+        }
+        else
+        {
+            m_state.fetch_and(~_flags, ::std::memory_order_relaxed);
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    inline typename signal< return_type(Args...) >::recorder_type* signal< return_type(Args...) >::active_recorder() const
+    {
+        const extension* ext = extended();
+        return ext != nullptr ? ext->recorder.load(::std::memory_order_relaxed) : nullptr;
+    }
+
+    template <typename return_type, typename ... Args>
+    void signal< return_type(Args...) >::record_emission(Args&... _args) const
+    {
+        if (blocked())
+        {
+            return; // blocked emission does not run, so it is not replayed
+        }
+
+        lock_guard lg(m_mutex);
+
+        recorder_type* recorder = active_recorder();
+        if (recorder != nullptr)
+        {
+            const extension* ext = extended();
+            ext->recording->emit(recorder, ext->trace_id, _args...);
+        }
+    }
+
+    template <typename return_type, typename ... Args>
+    inline void signal< return_type(Args...) >::emit_(Args... _args) const
+    {
+        operator()(::std::forward<Args>(_args)...);
+    }
+
+    template <typename return_type, typename ... Args>
+    inline void signal< return_type(Args...) >::operator ()(Args... _args) const
+    {
+        const unsigned int state = m_state.load(::std::memory_order_relaxed);
+        if (state == 0)
+        {
+            private_emit(::std::forward<Args>(_args)...);
+            return;
+        }
+
+        if ((state & recording_state) != 0)
+        {
+            record_emission(_args...);
+        }
+
+        private_emit_special(state, ::std::forward<Args>(_args)...);
+    }
+
+    template <typename return_type, typename ... Args>
+    inline bool signal< return_type(Args...) >::connected() const
+    {
+        lock_guard lg(m_mutex);
+        return m_head != nullptr;
+    }
+
+    template <typename return_type, typename ... Args>
+    inline return_type signal< return_type(Args...) >::private_invoke(Args... _args) const
+    {
+        const unsigned int state = m_state.load(::std::memory_order_relaxed);
+        if (state == 0)
+        {
+            private_emit(::std::forward<Args>(_args)...);
+            return ::slib::util::default_constructor<return_type>();
+        }
+
+        if ((state & guarded_state) != 0)
+        {
+            // this signal is a part of allowed cycle: do not enter it again while it is being invoked
+            if (::slib::util::guarded_invocation::active(this))
+            {
+                return ::slib::util::default_constructor<return_type>();
+            }
+
+            ::slib::util::guarded_invocation invocation(this);
+            private_emit_special(state, ::std::forward<Args>(_args)...);
+
+            return ::slib::util::default_constructor<return_type>();
+        }
+
+        private_emit_special(state, ::std::forward<Args>(_args)...);
         return ::slib::util::default_constructor<return_type>();
     }
 
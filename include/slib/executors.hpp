@@ -0,0 +1,49 @@
+/***************************************************************************************
+* file        : executors.hpp
+*             :
+* description : This header makes executors available to signals and slots: thread_pool,
+*             : dispatcher of thread-affine slots, bounded delivery queues and futures.
+*             :
+*             : signals.hpp only declares methods which use them (slot::set_affinity,
+*             : slot::post, slot::invoke_async, signal::emit_parallel, signal::emit_async
+*             : and signal::post), so code which emits signals on one thread does not
+*             : include threads and condition variables.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__EXECUTORS__HPP_
+#define SIGNALS_LIBRARY__EXECUTORS__HPP_
+
+#include "slib/signals.hpp"
+#include "slib/util/thread_pool.hpp"
+#include "slib/util/dispatcher.hpp"
+#include "slib/util/delivery_queue.hpp"
+#include "slib/util/future.hpp"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define SIGNALS_LIBRARY_EXECUTORS___INL__
+#include "slib/details/executors.inl"
+#undef SIGNALS_LIBRARY_EXECUTORS___INL__
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__EXECUTORS__HPP_
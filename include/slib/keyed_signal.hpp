@@ -0,0 +1,238 @@
+/***************************************************************************************
+* file        : keyed_signal.hpp
+*             :
+* description : This header contains description of keyed_signal class.
+*             : Keyed signal dispatches emission only to slots which are connected for the
+*             : emitted key (symbol, entity id, channel...). It keeps one ordinary signal per key
+*             : in a hash table, so emission costs one hash lookup plus invocation of matching
+*             : slots only (instead of invocation of every slot which filters keys by itself).
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__KEYED_SIGNAL__HPP_
+#define SIGNALS_LIBRARY__KEYED_SIGNAL__HPP_
+
+#include "slib/signals.hpp"
+#include <unordered_map>
+#include <memory>
+#include <functional>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    template <class key_type, typename function_signature, class hash_type = ::std::hash<key_type> > class keyed_signal;
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Signal which invokes only slots connected for emitted key.
+
+    Usage example:
+    \code
+    slib::keyed_signal<int, void(double)> price_changed;
+    price_changed.connect(42, slt); // slt is invoked only for symbol 42
+    price_changed(42, 10.5);
+    \endcode
+
+    Every key has it's own slib::signal (created on first connect for this key), so all signal features
+    (priorities, unique connections, connection handles, profiling) work for every key separately.
+    Signals of keys are not destroyed when their slots disconnect (use compact() to destroy them),
+    so pointers returned by find() and at() stay valid.
+
+    \ingroup slib */
+    template <class key_type, typename return_type, typename ... Args, class hash_type>
+    class keyed_signal < key_type, return_type(Args...), hash_type >
+    {
+    public:
+
+        typedef ::slib::slot< return_type(Args...) >           slot_type;
+        typedef ::slib::signal< return_type(Args...) >       signal_type;
+
+    private:
+
+        typedef ::slib::util::dynamic_mutex              dynamic_mutex;
+        typedef ::slib::util::lock_guard<dynamic_mutex>     lock_guard;
+        typedef ::std::unordered_map<key_type, ::std::unique_ptr<signal_type>, hash_type> map_type;
+
+        map_type           m_signals; ///< Signals of keys
+        dynamic_mutex        m_mutex; ///< Mutex for multithreading protection of m_signals (it is not multithreated by default)
+
+        keyed_signal(const keyed_signal&) = delete;
+        keyed_signal& operator = (const keyed_signal&) = delete;
+
+    public:
+
+        /** \brief Constructs keyed signal.
+
+        \param _is_threadsafe Thread-safety flag (signals of all keys get the same flag). */
+        explicit keyed_signal(bool _is_threadsafe = false) : m_mutex(_is_threadsafe)
+        {
+        }
+
+        /** \brief Returns thread-safety flag. */
+        inline bool threadsafe() const
+        {
+            return m_mutex.threadsafe();
+        }
+
+        /** \brief Connects slot for specified key.
+
+        \note This method is thread-safe if threadsafe() is true.
+
+        \param _key Key of emissions which would be received by slot.
+        \param _slot Reference to the slot.
+        \param _priority Emission priority (see signal::connect).
+
+        \retval Handle of the new connection. */
+        inline connection connect(const key_type& _key, slot_type& _slot, int _priority = 0)
+        {
+            return at(_key).connect(_slot, _priority);
+        }
+
+        /** \brief Disconnects slot from specified key.
+
+        \note This method is thread-safe if threadsafe() is true. */
+        inline void disconnect(const key_type& _key, slot_type& _slot)
+        {
+            const signal_type* sgnl = find(_key);
+            if (sgnl != nullptr)
+            {
+                sgnl->disconnect(_slot);
+            }
+        }
+
+        /** \brief Disconnects all slots of specified key.
+
+        \note This method is thread-safe if threadsafe() is true. */
+        inline void disconnect(const key_type& _key)
+        {
+            const signal_type* sgnl = find(_key);
+            if (sgnl != nullptr)
+            {
+                sgnl->disconnect();
+            }
+        }
+
+        /** \brief Disconnects all slots of all keys.
+
+        \note This method is thread-safe if threadsafe() is true. */
+        void disconnect()
+        {
+            lock_guard lg(m_mutex);
+            for (auto& key_signal : m_signals)
+            {
+                key_signal.second->disconnect();
+            }
+        }
+
+        /** \brief Emits signal of specified key.
+
+        \note This method is thread-safe if threadsafe() is true. */
+        inline void emit_(const key_type& _key, Args... _args) const
+        {
+            const signal_type* sgnl = find(_key);
+            if (sgnl != nullptr)
+            {
+                sgnl->emit_(::std::forward<Args>(_args)...);
+            }
+        }
+
+        /** \brief Emits signal of specified key.
+
+        \note This method is thread-safe if threadsafe() is true. */
+        inline void operator()(const key_type& _key, Args... _args) const
+        {
+            emit_(_key, ::std::forward<Args>(_args)...);
+        }
+
+        /** \brief Tests if at least one slot is connected for specified key.
+
+        \note This method is thread-safe if threadsafe() is true. */
+        inline bool connected(const key_type& _key) const
+        {
+            const signal_type* sgnl = find(_key);
+            return sgnl != nullptr && sgnl->connected();
+        }
+
+        /** \brief Returns signal of specified key or nullptr if nothing has been connected for this key.
+
+        \note This method is thread-safe if threadsafe() is true. */
+        const signal_type* find(const key_type& _key) const
+        {
+            lock_guard lg(m_mutex);
+            auto it = m_signals.find(_key);
+            return it == m_signals.end() ? nullptr : it->second.get();
+        }
+
+        /** \brief Returns signal of specified key (creates it if necessary).
+
+        Can be used to connect signal of the key to another signal.
+
+        \note This method is thread-safe if threadsafe() is true. */
+        signal_type& at(const key_type& _key)
+        {
+            lock_guard lg(m_mutex);
+
+            ::std::unique_ptr<signal_type>& sgnl = m_signals[_key];
+            if (sgnl == nullptr)
+            {
+                sgnl.reset(new signal_type(m_mutex.threadsafe()));
+            }
+
+            return *sgnl;
+        }
+
+        /** \brief Returns number of keys which have their own signal. */
+        inline size_t keys() const
+        {
+            lock_guard lg(m_mutex);
+            return m_signals.size();
+        }
+
+        /** \brief Destroys signals of keys which have no connected slots.
+
+        \warning This method is NOT thread-safe: no one must emit or use signals returned by find() or at() during compact(). */
+        void compact()
+        {
+            lock_guard lg(m_mutex);
+
+            for (auto it = m_signals.begin(); it != m_signals.end();)
+            {
+                if (it->second->connected())
+                {
+                    ++it;
+                }
+                else
+                {
+                    it = m_signals.erase(it);
+                }
+            }
+        }
+
+    }; // END class keyed_signal.
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__KEYED_SIGNAL__HPP_
@@ -0,0 +1,351 @@
+/***************************************************************************************
+* file        : rate_limited_signal.hpp
+*             :
+* description : This header contains description of throttled_signal and debounced_signal classes.
+*             : They are put between a noisy signal and it's slots:
+*             : throttled_signal delivers emissions at most once per interval (the latest arguments
+*             : of emissions made during interval are delivered at it's end), debounced_signal
+*             : delivers the latest arguments after emissions have stopped for a quiet period.
+*             :
+*             : Delayed deliveries are driven by timers of one timer_wheel which is shared by
+*             : any number of adaptors. Every adaptor has one intrusive timer which is scheduled
+*             : at most once per delivery, so timer bookkeeping is O(1) per emission.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__RATE_LIMITED_SIGNAL__HPP_
+#define SIGNALS_LIBRARY__RATE_LIMITED_SIGNAL__HPP_
+
+#include "slib/signals.hpp"
+#include "slib/coalescing_signal.hpp"
+#include "slib/util/timer_wheel.hpp"
+#include <chrono>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    template <typename function_signature> class throttled_signal;
+    template <typename function_signature> class debounced_signal;
+
+    namespace util {
+
+        template <typename function_signature> class rate_limiter;
+
+        /** \brief Common part of throttled_signal and debounced_signal.
+
+        Arguments waiting for delayed delivery are kept by coalescing_signal, it's target signal
+        delivers emissions to connected slots.
+
+        \ingroup util */
+        template <typename return_type, typename ... Args>
+        class rate_limiter < return_type(Args...) >
+        {
+        public:
+
+            typedef ::slib::delegate< return_type(Args...) >   delegate_type;
+            typedef ::slib::slot< return_type(Args...) >           slot_type;
+            typedef ::slib::signal< return_type(Args...) >       signal_type;
+            typedef timer_wheel::clock_type                       clock_type;
+
+        protected:
+
+            typedef ::slib::coalescing_signal< return_type(Args...) > coalescing_type;
+            typedef ::slib::util::lock_guard<dynamic_mutex>                lock_guard;
+
+            /** \brief Timer of delayed delivery. */
+            struct delivery_timer final : public timer_node
+            {
+                rate_limiter* owner; ///< Adaptor which owns timer
+
+                delivery_timer(rate_limiter* _owner, void (*_function)(timer_node*)) : timer_node(_function), owner(_owner)
+                {
+                }
+            };
+
+            coalescing_type          m_pending; ///< Arguments waiting for delivery and signal which delivers them
+            slot_type                  m_input; ///< Slot which is connected to rate limited signal
+            timer_wheel&               m_wheel; ///< Wheel which drives delayed deliveries
+            delivery_timer             m_timer; ///< Timer of delayed delivery
+            clock_type::duration    m_interval; ///< Throttling interval or quiet period
+            clock_type::time_point      m_last; ///< Time of the last delivery (throttle) or emission (debounce)
+            dynamic_mutex              m_mutex; ///< Mutex for multithreading protection (it is not multithreated by default)
+            bool                   m_scheduled; ///< True if delayed delivery is scheduled
+
+            rate_limiter(const rate_limiter&) = delete;
+            rate_limiter& operator = (const rate_limiter&) = delete;
+
+            rate_limiter(timer_wheel& _wheel, clock_type::duration _interval, bool _is_threadsafe, void (*_on_timer)(timer_node*))
+                : m_pending(_is_threadsafe)
+                , m_input(_is_threadsafe)
+                , m_wheel(_wheel)
+                , m_timer(this, _on_timer)
+                , m_interval(_interval)
+                , m_last(clock_type::now() - _interval)
+                , m_mutex(_is_threadsafe)
+                , m_scheduled(false)
+            {
+            }
+
+            /** \brief Cancels delayed delivery and waits for it if it is being delivered by another thread
+            (by timer_scheduler thread, for example). */
+            ~rate_limiter()
+            {
+                m_input.disconnect();
+                m_wheel.cancel_and_wait(&m_timer);
+            }
+
+        public:
+
+            /** \brief Returns slot which must be connected to rate limited signal.
+
+            Usage example:
+            \code
+            slib::throttled_signal<void(double)> price_updates(wheel, std::chrono::milliseconds(100));
+            slib::connect(feed.price_changed, price_updates.input());
+            price_updates.connect(chart.on_price);
+            \endcode */
+            inline slot_type& input()
+            {
+                return m_input;
+            }
+
+            /** \brief Returns signal which delivers rate limited emissions. */
+            inline signal_type& target()
+            {
+                return m_pending.target();
+            }
+
+            /** \brief Connects slot to rate limited emissions (see signal::connect). */
+            inline connection connect(slot_type& _slot, int _priority = 0) const
+            {
+                return m_pending.connect(_slot, _priority);
+            }
+
+            /** \brief Disconnects slot from rate limited emissions. */
+            inline void disconnect(slot_type& _slot) const
+            {
+                m_pending.disconnect(_slot);
+            }
+
+            /** \brief Delivers pending emission immediately (without waiting for timer).
+
+            \retval true if there was pending emission. */
+            inline bool flush()
+            {
+                return m_pending.flush();
+            }
+
+            /** \brief Returns true if there is an emission waiting for delayed delivery. */
+            inline bool pending() const
+            {
+                return m_pending.pending();
+            }
+
+            /** \brief Returns number of emissions which were replaced by later ones (were not delivered). */
+            inline unsigned long long suppressed() const
+            {
+                return m_pending.coalesced();
+            }
+
+        }; // END class rate_limiter.
+
+    } // END namespace util.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Adaptor which delivers emissions at most once per interval.
+
+    The first emission after quiet interval is delivered immediately (by emitting thread).
+    Emissions made during interval are coalesced: arguments of the latest of them are delivered
+    when interval expires (by the thread which advances timer wheel).
+
+    \ingroup slib */
+    template <typename return_type, typename ... Args>
+    class throttled_signal < return_type(Args...) > final : public ::slib::util::rate_limiter< return_type(Args...) >
+    {
+        typedef ::slib::util::rate_limiter< return_type(Args...) > parent_type;
+        typedef throttled_signal                                     this_type;
+        typedef typename parent_type::delegate_type              delegate_type;
+
+    public:
+
+        typedef typename parent_type::clock_type clock_type;
+
+        /** \brief Constructs adaptor.
+
+        \param _wheel Timer wheel shared by adaptors (must outlive adaptor).
+        \param _interval Minimum interval between two deliveries.
+        \param _is_threadsafe Thread-safety flag. */
+        template <class rep_type, class period_type>
+        throttled_signal(::slib::util::timer_wheel& _wheel, const ::std::chrono::duration<rep_type, period_type>& _interval, bool _is_threadsafe = false)
+            : parent_type(_wheel, ::std::chrono::duration_cast<typename clock_type::duration>(_interval), _is_threadsafe, &this_type::on_timer)
+        {
+            this->m_input.bind(delegate_type::template from_method<this_type, &this_type::private_invoke>(this));
+        }
+
+        /** \brief Delivers emission immediately or stores it for delivery at the end of current interval.
+
+        \note This method is thread-safe if threadsafe flag is true. */
+        void emit_(Args... _args)
+        {
+            this->m_mutex.lock();
+
+            if (!this->m_scheduled)
+            {
+                const typename clock_type::time_point now = clock_type::now();
+                if (now - this->m_last >= this->m_interval)
+                {
+                    this->m_last = now;
+                    this->m_mutex.unlock();
+                    this->m_pending.target().emit_(::std::forward<Args>(_args)...);
+                    return;
+                }
+
+                this->m_scheduled = true;
+                this->m_wheel.schedule(&this->m_timer, this->m_last + this->m_interval);
+            }
+
+            this->m_pending.emit_(::std::forward<Args>(_args)...);
+            this->m_mutex.unlock();
+        }
+
+        /** \brief Delivers emission immediately or stores it for delivery at the end of current interval. */
+        inline void operator()(Args... _args)
+        {
+            emit_(::std::forward<Args>(_args)...);
+        }
+
+    private:
+
+        return_type private_invoke(Args... _args)
+        {
+            emit_(::std::forward<Args>(_args)...);
+            return ::slib::util::default_constructor<return_type>();
+        }
+
+        static void on_timer(::slib::util::timer_node* _timer)
+        {
+            this_type* that = static_cast<this_type*>(static_cast<typename parent_type::delivery_timer*>(_timer)->owner);
+
+            that->m_mutex.lock();
+            that->m_scheduled = false;
+            that->m_last = that->m_wheel.time();
+            that->m_mutex.unlock();
+
+            that->m_pending.flush();
+        }
+
+    }; // END class throttled_signal.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Adaptor which delivers the latest emission after emissions have stopped for a quiet period.
+
+    Emission only stores arguments and time: timer is scheduled by the first emission after delivery
+    and, when it expires too early (there were later emissions), it is scheduled again for the rest
+    of quiet period. Deliveries are made by the thread which advances timer wheel.
+
+    \ingroup slib */
+    template <typename return_type, typename ... Args>
+    class debounced_signal < return_type(Args...) > final : public ::slib::util::rate_limiter< return_type(Args...) >
+    {
+        typedef ::slib::util::rate_limiter< return_type(Args...) > parent_type;
+        typedef debounced_signal                                     this_type;
+        typedef typename parent_type::delegate_type              delegate_type;
+
+    public:
+
+        typedef typename parent_type::clock_type clock_type;
+
+        /** \brief Constructs adaptor.
+
+        \param _wheel Timer wheel shared by adaptors (must outlive adaptor).
+        \param _quiet Quiet period after the last emission which must pass before delivery.
+        \param _is_threadsafe Thread-safety flag. */
+        template <class rep_type, class period_type>
+        debounced_signal(::slib::util::timer_wheel& _wheel, const ::std::chrono::duration<rep_type, period_type>& _quiet, bool _is_threadsafe = false)
+            : parent_type(_wheel, ::std::chrono::duration_cast<typename clock_type::duration>(_quiet), _is_threadsafe, &this_type::on_timer)
+        {
+            this->m_input.bind(delegate_type::template from_method<this_type, &this_type::private_invoke>(this));
+        }
+
+        /** \brief Stores emission for delivery after quiet period.
+
+        \note This method is thread-safe if threadsafe flag is true. */
+        void emit_(Args... _args)
+        {
+            this->m_mutex.lock();
+
+            this->m_last = clock_type::now();
+            this->m_pending.emit_(::std::forward<Args>(_args)...);
+
+            if (!this->m_scheduled)
+            {
+                this->m_scheduled = true;
+                this->m_wheel.schedule(&this->m_timer, this->m_last + this->m_interval);
+            }
+
+            this->m_mutex.unlock();
+        }
+
+        /** \brief Stores emission for delivery after quiet period. */
+        inline void operator()(Args... _args)
+        {
+            emit_(::std::forward<Args>(_args)...);
+        }
+
+    private:
+
+        return_type private_invoke(Args... _args)
+        {
+            emit_(::std::forward<Args>(_args)...);
+            return ::slib::util::default_constructor<return_type>();
+        }
+
+        static void on_timer(::slib::util::timer_node* _timer)
+        {
+            this_type* that = static_cast<this_type*>(static_cast<typename parent_type::delivery_timer*>(_timer)->owner);
+
+            that->m_mutex.lock();
+            const typename clock_type::time_point deadline = that->m_last + that->m_interval;
+            if (that->m_wheel.time() < deadline)
+            {
+                that->m_wheel.schedule(&that->m_timer, deadline); // there were emissions after timer has been scheduled
+                that->m_mutex.unlock();
+                return;
+            }
+
+            that->m_scheduled = false;
+            that->m_mutex.unlock();
+
+            that->m_pending.flush();
+        }
+
+    }; // END class debounced_signal.
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__RATE_LIMITED_SIGNAL__HPP_
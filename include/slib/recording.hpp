@@ -0,0 +1,45 @@
+/***************************************************************************************
+* file        : recording.hpp
+*             :
+* description : This header makes trace_recorder available to signals: signal::record
+*             : writes emissions and connection changes of a signal into recorder's trace
+*             : (see trace_player.hpp to replay it).
+*             :
+*             : signals.hpp only declares signal::record, so code which does not record
+*             : signals does not include the recorder.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__RECORDING__HPP_
+#define SIGNALS_LIBRARY__RECORDING__HPP_
+
+#include "slib/signals.hpp"
+#include "slib/util/trace_recorder.hpp"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define SIGNALS_LIBRARY_RECORDING___INL__
+#include "slib/details/recording.inl"
+#undef SIGNALS_LIBRARY_RECORDING___INL__
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__RECORDING__HPP_
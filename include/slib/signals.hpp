@@ -16,6 +16,8 @@
 *             : It is because slot automatically disconnects from all connected signals on destructor.
 *             : Slots uses dynamic memory allocation on first connect to signal, and does not use
 *             : dynamic memory allocation on secondary connects after disconnect.
+*             : Use slot::reserve() to preallocate connections and slib::util::no_allocation_region
+*             : to verify that your hot path does not allocate memory.
 *             : 
 *             : Signal is inherited from slot and has the same syntax. Signal is used to call all
 *             : connected Slots when user calls it's emit_() method.
@@ -44,8 +46,19 @@
 #define SIGNALS_LIBRARY__SIGNALS__HPP_
 
 #include "slib/delegate.hpp"
+#include "slib/args_list.hpp"
+#include "slib/connection.hpp"
+#include "slib/util/allocation_guard.hpp"
 #include "slib/util/mutex.hpp"
+#include "slib/connection_group.hpp"
+#include "slib/util/emission_scope.hpp"
+#include "slib/util/latency_histogram.hpp"
+#include "slib/util/signal_graph.hpp"
 #include "shared_allocator/cached_allocator.hpp"
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <assert.h>
 #include "slib/details/signal_slot_subscriber.hpp"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -55,6 +68,134 @@ namespace slib {
 
     //////////////////////////////////////////////////////////////////////////
 
+    // Executors, futures and trace recorder are opt-in (see slib/executors.hpp and slib/recording.hpp)
+
+    template <class result_type> class future;
+
+    namespace util {
+
+        struct pool_task;
+        class thread_pool;
+        class task_latch;
+        class dispatcher;
+        class trace_recorder;
+        struct queue_statistics;
+        template <typename function_signature> class delivery_queue;
+
+    } // END namespace util.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    namespace util {
+
+        /** \brief Returns number of signal-to-signal topology changes made by current thread.
+
+        It is increased every time a flattened signal or a signal connected to other signals (by to_slot())
+        changes it's slots list. Flattened emission compares it between invocations of leaf slots to notice
+        changes made by invoked slots, and checks generations of flattened signals only if it has changed. */
+        inline unsigned long long& topology_changes()
+        {
+            static thread_local unsigned long long s_changes = 0;
+            return s_changes;
+        }
+
+        /** \brief Invocation of guarded signal through signal-to-signal connection.
+
+        Invocations are kept on the stack of invoking thread and linked into per-thread list, so the guard never
+        allocates memory, and invocation is removed from the list even if invoked slot throws an exception.
+
+        \sa cycle_policy::allow_guarded */
+        struct guarded_invocation final
+        {
+            const void*          signal; ///< Invoked signal
+            guarded_invocation*   outer; ///< Outer invocation of current thread (or nullptr)
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wdangling-pointer" // invocation is unregistered by destructor
+#endif
+            explicit guarded_invocation(const void* _signal) : signal(_signal), outer(top())
+            {
+                top() = this;
+            }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+# pragma GCC diagnostic pop
+#endif
+
+            ~guarded_invocation()
+            {
+                top() = outer;
+            }
+
+            /** \brief Returns true if specified signal is being invoked by current thread. */
+            static bool active(const void* _signal)
+            {
+                for (const guarded_invocation* current = top(); current != nullptr; current = current->outer)
+                {
+                    if (current->signal == _signal)
+                    {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            /** \brief Returns the innermost invocation of current thread. */
+            static guarded_invocation*& top()
+            {
+                static thread_local guarded_invocation* s_top = nullptr;
+                return s_top;
+            }
+        };
+
+    } // END namespace util.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Defines which connections of a signal are considered duplicates.
+
+    \sa signal::set_unique_connections
+
+    \ingroup slib */
+    enum class unique_connections : unsigned char
+    {
+        none = 0,   ///< Duplicates are allowed (default). The same slot connected twice is invoked twice.
+        by_slot,    ///< The same slot object can not be connected twice.
+        by_delegate ///< Slots binded to the same method of the same instance (or to the same function) can not be connected twice.
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Defines what happens when signal-to-signal connection would create a cycle.
+
+    \sa signal::set_cycle_policy
+
+    \ingroup slib */
+    enum class cycle_policy : unsigned char
+    {
+        reject = 0,   ///< Connection is not made (default)
+        assertion,    ///< Assertion fails (works only if NDEBUG is not defined), then connection is not made
+        allow_guarded ///< Connection is made and the connected signal gets reentrancy guard: it is invoked through signal-to-signal connections at most once per thread at a time
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Defines what happens when bounded queue of thread-affine slot is full.
+
+    \sa slot::set_affinity
+
+    \ingroup slib */
+    enum class overflow_policy : unsigned char
+    {
+        block = 0,   ///< Emitting thread waits until owner thread takes it's invocation into the queue (default, see delivery_queue::push)
+        drop_newest, ///< New invocation is dropped
+        drop_oldest, ///< The oldest queued invocation is dropped
+        coalesce     ///< The newest queued invocation gets arguments of new invocation (consumer gets the latest values)
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+
     /** \brief Slot class. It has a pointer to method (handler) and keeps pointer to self position in
     signal's slot list for safe disconnection when owner of slot is being destroyed.
 
@@ -71,6 +212,9 @@ namespace slib {
         typedef ::slib::slot< return_type(Args...) >           slot_type;
         typedef ::slib::signal< return_type(Args...) >       signal_type;
 
+        typedef ::slib::util::lock_statistics       lock_statistics_type;
+        typedef ::slib::util::queue_statistics     queue_statistics_type;
+
     private:
 
         typedef delegate_type                              parent_type;
@@ -80,12 +224,28 @@ namespace slib {
         typedef ::slib::util::atomic_boolean            atomic_boolean;
 
         typedef ::slib::util::subscriber<slot_type, signal_type> subscriber_type;
-        typedef ::salloc::cached_allocator<subscriber_type, ::salloc::shared_allocator<subscriber_type> > allocator_type;
+        typedef ::salloc::cached_allocator<subscriber_type, ::slib::util::subscriber_allocator<subscriber_type> > allocator_type;
+        typedef ::slib::util::delivery_queue< return_type(Args...) > queue_type;
+
+        /** \brief Thread affinity of slot.
+
+        It is created by the first set_affinity() call and it lives until slot is destroyed. Emission reaches
+        dispatcher and queue only through it's functions, so signals.hpp does not depend on executors. */
+        struct affinity_state final
+        {
+            ::slib::util::dispatcher* owner; ///< Dispatcher of owner thread (nullptr if slot is not thread-affine)
+            queue_type*               queue; ///< Bounded queue of invocations (nullptr if queue is unbounded)
+            bool (*deliver)(const slot_type&, ::slib::util::dispatcher*, Args&...); ///< Queues invocation unless dispatcher is owned by current thread (returns false then)
+            void (*destroy)(affinity_state*); ///< Destroys queue and affinity
+        };
 
         dynamic_mutex        m_mutex; ///< Mutex for multi-threading protection (it is not thread-safe by default)
         subscriber_type*     m_first; ///< Pointer to the first binded signal in list
         atomic_boolean     m_deleted; ///< Equals to true if deleted
         allocator_type   m_allocator; ///< Allocator for safe cross-library allocations and reuse of deallocated memory
+        affinity_state*   m_affinity; ///< Thread affinity (nullptr if set_affinity has never been called)
+
+        static const ::slib::util::connection_operations s_connection_operations; ///< Functions used by connection handles
 
     public:
 
@@ -126,12 +286,99 @@ namespace slib {
         \param _is_threadsafe thread-safe protection flag. */
         inline void set_threadsafe(bool _is_threadsafe);
 
+        /** \brief Makes this slot thread-affine: it is always invoked on the owner thread of specified dispatcher.
+
+        If signal is emitted on the owner thread, then slot is invoked directly (the check is one comparison
+        of thread ids), otherwise copy of slot's delegate and copies of arguments are queued into dispatcher.
+        Emission of signals without thread-affine connections is not affected.
+
+        Affinity is applied to existing connections too.
+
+        \note Include slib/executors.hpp to use this method.
+
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \warning Slot (and object bound to it) must stay alive until queued invocations are processed.
+        Slot must not take non-const lvalue references (arguments of queued invocations are copies).
+
+        \param _dispatcher Pointer to dispatcher (nullptr makes slot ordinary again). */
+        void set_affinity(::slib::util::dispatcher* _dispatcher);
+
+        /** \brief Makes this slot thread-affine with bounded queue of invocations.
+
+        Queued invocations are kept in ring buffer of _capacity elements which is allocated by this call,
+        so emission from another thread never allocates (arguments are copied into preallocated element).
+        When ring is full, _policy defines whether emitting thread waits, or which invocation is dropped
+        (see overflow_policy). Dropped and coalesced invocations are counted (see queue_statistics).
+        Emitting thread never waits under locked signal: with block policy invocation is kept over capacity
+        in second ring (_capacity + delivery_queue::reserved_emitters elements, it is allocated by this call too)
+        and emitting thread waits after it has unlocked emitted signals. If that ring is full during nested
+        emission, then invocation is coalesced into the newest queued one instead.
+
+        \note Include slib/executors.hpp to use this method.
+
+        \warning This method is NOT thread-safe with respect to concurrent emissions. Use this on initialization.
+        Slot's queue must not have undelivered invocations when it is replaced or destroyed.
+
+        \param _dispatcher Pointer to dispatcher of owner thread (nullptr makes slot ordinary again).
+        \param _capacity Maximum number of queued invocations.
+        \param _policy What happens when queue is full. */
+        void set_affinity(::slib::util::dispatcher* _dispatcher, size_t _capacity, overflow_policy _policy = overflow_policy::block);
+
+        /** \brief Returns counters of bounded queue (all counters are 0 if queue is unbounded).
+
+        \note Include slib/executors.hpp to use this method.
+
+        \note This method is thread-safe. */
+        inline queue_statistics_type queue_statistics() const;
+
+        /** \brief Returns dispatcher of thread-affine slot (nullptr for ordinary slot).
+
+        \warning This method is NOT thread-safe by itself. */
+        inline ::slib::util::dispatcher* affinity() const;
+
+        /** \brief Queues invocation of slot into executor and returns future of it's result.
+
+        Usage example:
+        \code
+        slib::future<double> price = pricer.on_quote.post(pool, instrument);
+        chart.draw(price.get());
+        \endcode
+
+        Invocation node (copy of slot's delegate, copies of arguments and storage of result) is the shared state
+        of the future, and it is taken from the task cache, so posting does not allocate after warm-up.
+
+        \note Include slib/executors.hpp to use this method.
+
+        \note This method is thread-safe.
+
+        \warning Slot (and object bound to it) must stay alive until invocation.
+
+        \param _executor thread_pool or dispatcher which executes invocation */
+        template <class executor_type>
+        inline ::slib::future<return_type> post(executor_type& _executor, Args... _args) const;
+
+        /** \brief Invokes slot on it's owner thread (see set_affinity) and returns future of it's result.
+
+        Invocation is queued into slot's dispatcher (bounded queue is not used). Ordinary slot or slot
+        which is owned by calling thread is invoked immediately, and returned future is ready.
+
+        \note Include slib/executors.hpp to use this method.
+
+        \note This method is thread-safe.
+
+        \warning Slot (and object bound to it) must stay alive until invocation. */
+        inline ::slib::future<return_type> invoke_async(Args... _args) const;
+
         /** \brief Connects this slot to specified signal.
 
         \note This method is thread-safe if set_threadsafe(true).
 
-        \param _signal reference to the signal */
-        void connect(const signal_type& _signal);
+        \param _signal reference to the signal
+        \param _priority emission priority (see signal::connect)
+
+        \retval Handle of the new connection which can be used to disconnect it in O(1). */
+        connection connect(const signal_type& _signal, int _priority = 0);
 
         /** \brief Disconnects slot from specified signal.
 
@@ -161,6 +408,20 @@ namespace slib {
         \retval true if slot has been connected at least to one signal */
         inline bool connected() const;
 
+        /** \brief Turns collecting of lock contention statistics on/off.
+
+        \warning This method is NOT thread-safe.
+
+        \note Statistics are collected only if set_threadsafe(true).
+
+        \param _enabled Statistics flag. Turning statistics off removes all collected values. */
+        inline void enable_lock_statistics(bool _enabled);
+
+        /** \brief Returns lock contention statistics of this slot's mutex.
+
+        \note This method is thread-safe if set_threadsafe(true). */
+        inline lock_statistics_type lock_statistics() const;
+
     private:
 
         // Restricted methods
@@ -188,8 +449,57 @@ namespace slib {
 
         /** \brief Returns new subscriber object which can be connected to signal.
 
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \param _priority emission priority of new connection */
+        inline subscriber_type* get_new_subscriber(int _priority);
+
+        /** \brief Returns subscriber object's memory into cache.
+
+        \note Subscriber must be already removed from both lists. Must be called under locked m_mutex. */
+        inline void release(subscriber_type* _that);
+
+        /** \brief Queues invocation into bounded queue (if any) or into specified dispatcher. */
+        template <class ... TArgs>
+        inline void enqueue(::slib::util::dispatcher* _owner, TArgs&&... _args) const;
+
+        /** \brief Returns thread affinity creating it if necessary. */
+        affinity_state& affine();
+
+        /** \brief Function of affinity_state: queues invocation of slot unless specified dispatcher is owned by current thread. */
+        static bool deliver(const slot_type& _slot, ::slib::util::dispatcher* _owner, Args&... _args);
+
+        /** \brief Function of affinity_state: destroys bounded queue and affinity. */
+        static void destroy_affinity(affinity_state* _affinity);
+
+        /** \brief Removes subscriber from it's connection_group (if any). Must be called under locked m_mutex. */
+        static inline void leave_group(subscriber_type* _that);
+
+        /** \brief Resets subscriber's id under the pool lock, so connection handles can not reach it's slot anymore. */
+        static inline void invalidate(subscriber_type* _that);
+
+        /** \brief Locks mutex of subscriber's slot if subscriber still represents connection with specified id.
+
+        Id is checked under the pool lock (see subscriber_allocator), which outlives the slot,
+        so slot can not be destroyed between the check and locking of it's mutex.
+
+        \return Slot with locked m_mutex or nullptr if connection does not exist anymore. */
+        static this_type* acquire(const subscriber_type* _that, unsigned int _id);
+
+        /** \brief Returns handle of connection represented by specified subscriber. */
+        inline connection make_connection(subscriber_type* _that);
+
+        /** \brief Disconnects specified subscriber if it still represents connection with specified id.
+
         \note This method is thread-safe if set_threadsafe(true). */
-        inline subscriber_type* get_new_subscriber();
+        void disconnect(subscriber_type* _that, unsigned int _id);
+
+        static bool connected_stub(const void* _subscriber, unsigned int _id);
+        static void disconnect_stub(void* _subscriber, unsigned int _id);
+        static void block_stub(void* _subscriber, unsigned int _id, bool _blocked);
+        static bool blocked_stub(const void* _subscriber, unsigned int _id);
+        static bool join_stub(void* _subscriber, unsigned int _id, connection_group* _group);
+        static connection connection_of_stub(::slib::util::group_node* _node);
 
         friend signal_type;
 
@@ -213,6 +523,11 @@ namespace slib {
         typedef ::slib::slot< return_type(Args...) >           slot_type;
         typedef ::slib::signal< return_type(Args...) >       signal_type;
 
+        typedef ::slib::delegate< void(const slot_type&, unsigned long long) > slow_slot_handler;
+        typedef ::slib::util::slot_latency<slot_type>                          slot_latency_type;
+        typedef ::slib::util::lock_statistics                               lock_statistics_type;
+        typedef ::slib::util::trace_recorder                                       recorder_type;
+
     private:
 
         typedef signal_type this_type;
@@ -224,9 +539,182 @@ namespace slib {
 
         typedef ::slib::util::subscriber<slot_type, signal_type> subscriber_type;
 
-        mutable subscriber_type    m_head; ///< The head of slots list
+        typedef ::std::vector<const slot_type*, ::slib::util::guarded_allocator<const slot_type*> >  leaves_type;
+        typedef ::std::pair<const signal_type*, unsigned long long>                          flat_signal;
+        typedef ::std::vector<flat_signal, ::slib::util::guarded_allocator<flat_signal> >    flat_signals_type;
+
+        /** \brief Element of connections index. */
+        struct index_entry final
+        {
+            subscriber_type*          subscriber; ///< Indexed subscriber (nullptr for an empty bucket)
+            unsigned int                    hash; ///< Hash value of subscriber's slot at the moment of indexing
+        };
+
+        typedef ::std::vector<index_entry, ::slib::util::guarded_allocator<index_entry> > buckets_type;
+
+        /** \brief Hash table of connections used to detect duplicates.
+
+        Open addressing with linear probing: subscribers keep no index data,
+        and index does not allocate memory except when it grows. */
+        struct connection_index final
+        {
+            buckets_type                    buckets; ///< Buckets (number of buckets is a power of 2, at most half of them are used)
+            size_t                             size; ///< Number of indexed subscribers
+            unique_connections                 mode; ///< Duplicates detection mode
+
+            explicit connection_index(unique_connections _mode) : buckets(16, index_entry {nullptr, 0}), size(0), mode(_mode)
+            {
+            }
+        };
+
+        /** \brief Last subscriber of slots with the same priority. */
+        struct priority_bucket final
+        {
+            int                 priority; ///< Priority of subscribers
+            subscriber_type*        last; ///< The last connected subscriber with this priority
+        };
+
+        typedef ::std::vector<priority_bucket, ::slib::util::guarded_allocator<priority_bucket> > priorities_type;
+
+        /** \brief Flattened list of leaf slots of signal-to-signal chains. */
+        struct flat_cache final
+        {
+            leaves_type                     leaves; ///< Slots to invoke in order of emission
+            flat_signals_type              signals; ///< Visited signals with their generations at the moment of build (parents go first)
+            unsigned int                     depth; ///< Number of nested flattened emissions in progress
+            bool                             valid; ///< False if slots list of this signal has been changed
+
+            flat_cache() : depth(0), valid(false)
+            {
+            }
+        };
+
+        /** \brief Position of one emission in progress.
+
+        Emission keeps the next subscriber to invoke in the cursor. Every cursor is registered in signal's
+        stack of active emissions, so unlink() can move it forward if invoked slot removes that subscriber
+        (by disconnecting or destroying any slot). This is the only work needed to support changes of
+        slots list from inside slots: emission loop itself has no additional branches.
+
+        If invoked slot destroys the emitting signal, then signal's destructor stops every emission in progress,
+        unlocks signal's mutex for it and clears it's alive flag: the emission returns without touching the signal. */
+        struct emission_cursor final
+        {
+            const this_type&     owner; ///< Emitting signal
+            lock_guard*           lock; ///< Lock of owner's mutex held by emission (nullptr if owner is not thread-safe)
+            subscriber_type*      next; ///< Next subscriber to invoke
+            emission_cursor*     outer; ///< Cursor of outer emission of the same signal (or nullptr)
+            bool                 alive; ///< False if owner has been destroyed by invoked slot
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wdangling-pointer" // cursor is unregistered by destructor
+#endif
+            emission_cursor(const this_type& _owner, lock_guard* _lock)
+                : owner(_owner), lock(_lock), next(nullptr), outer(_owner.m_cursors), alive(true)
+            {
+                owner.m_cursors = this;
+            }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+# pragma GCC diagnostic pop
+#endif
+
+            ~emission_cursor()
+            {
+                if (alive)
+                {
+                    owner.m_cursors = outer;
+                }
+                else if (lock != nullptr)
+                {
+                    lock->release(); // mutex has been unlocked by owner's destructor
+                }
+            }
+        };
+
+        /** \brief Arguments of parallel emission (shared by all chunks). */
+        typedef ::std::tuple<Args&...> parallel_arguments;
+
+        /** \brief Part of slots list which is invoked by one task of parallel emission (see slib/executors.hpp). */
+        struct parallel_chunk;
+
+        /** \brief Table of trace recorder functions used by recorded signal.
+
+        It is set by record() (see slib/recording.hpp), so signals.hpp does not depend on trace_recorder. */
+        struct recording_operations final
+        {
+            void (*connect)(recorder_type* _recorder, unsigned int _id, unsigned int _target, int _priority); ///< Writes connection into the trace
+            void (*disconnect)(recorder_type* _recorder, unsigned int _id, unsigned int _target);             ///< Writes disconnection into the trace
+            void (*emit)(recorder_type* _recorder, unsigned int _id, Args&... _args);                          ///< Writes emission into the trace
+        };
+
+        /** \brief Settings and state of slot invocations timing. */
+        struct profiler final
+        {
+            slow_slot_handler on_slow_slot; ///< Handler which is called when slot invocation exceeds budget
+            unsigned long long      budget; ///< Time budget for one slot invocation in nanoseconds (0 means no budget)
+            unsigned int      sample_every; ///< Only every Nth emission is timed
+            unsigned int         countdown; ///< Number of emissions left before next timed emission
+        };
+
+        /** \brief State of rare features of signal.
+
+        Extension is created on the first use of any of them and it lives until signal is destroyed.
+        Upstream signals create extension of connected signal under their own mutex, so it is published by compare-exchange. */
+        struct extension final
+        {
+            profiler*                                 timing; ///< Timing settings (nullptr if profiling is disabled)
+            ::std::atomic<recorder_type*>           recorder; ///< Emission trace recorder (nullptr if recording is disabled)
+            const recording_operations*            recording; ///< Functions of recorder (set together with recorder)
+            unsigned int                            trace_id; ///< Id of the signal in recorder's trace
+            connection_index*                          index; ///< Connections index (nullptr if duplicates are allowed)
+            priorities_type                       priorities; ///< Buckets sorted by descending priority (empty while all slots have priority 0)
+            flat_cache*                                 flat; ///< Flattened emission cache (nullptr if flattening is disabled)
+            ::std::atomic<unsigned long long>     generation; ///< Generation of slots list (it is increased by topology_changed())
+            ::std::atomic<unsigned int>            upstreams; ///< Number of signals to which the signal is connected by to_slot()
+            ::std::atomic<unsigned int>               guards; ///< Number of connections of the signal which close cycles allowed by cycle_policy::allow_guarded
+            ::slib::util::graph_node*                  graph; ///< Node in graph of signal-to-signal connections (nullptr if the signal has never been a part of it)
+            unsigned int                 blocked_connections; ///< Number of blocked connections in slots list
+            unsigned int                  affine_connections; ///< Number of connections of thread-affine slots in slots list
+            cycle_policy                               cycle; ///< What happens if connection of another signal would create a cycle
+
+            extension()
+                : timing(nullptr), recorder(nullptr), recording(nullptr), trace_id(0), index(nullptr), flat(nullptr), generation(0), upstreams(0), guards(0)
+                , graph(nullptr), blocked_connections(0), affine_connections(0), cycle(cycle_policy::reject)
+            {
+            }
+
+            ~extension()
+            {
+                delete timing;
+                delete index;
+                delete flat;
+            }
+        };
+
+        /** \brief Flags of m_state.
+
+        Emission reads the whole state once: slots of signal without flags are just invoked one by one,
+        every rare feature is handled by private_emit_special(). */
+        enum state_flags : unsigned int
+        {
+            threadsafe_state          = 1U << 0, ///< Signal is thread-safe (it's mutex is locked and emission_scope is used)
+            recording_state           = 1U << 1, ///< Emissions are recorded
+            profiling_state           = 1U << 2, ///< Slot invocations are timed
+            flattening_state          = 1U << 3, ///< Flattened emission cache is enabled
+            blocked_connections_state = 1U << 4, ///< Some connections are blocked
+            affine_connections_state  = 1U << 5, ///< Some connected slots are thread-affine
+            guarded_state             = 1U << 6, ///< Signal closes a cycle allowed by cycle_policy::allow_guarded
+            blocked_state             = 1U << 8  ///< One block() call (upper bits count block() calls without unblock())
+        };
+
         dynamic_mutex             m_mutex; ///< Mutex for multithreading protection (it is not multithreated by default)
         atomic_boolean          m_deleted; ///< Equals to true if deleted
+        mutable ::std::atomic<unsigned int> m_state; ///< Flags of rare features (see state_flags) and number of block() calls
+        mutable subscriber_type*   m_head; ///< The first subscriber in slots list (nullptr if list is empty)
+        mutable subscriber_type*   m_tail; ///< The last subscriber in slots list (nullptr if list is empty)
+        mutable emission_cursor* m_cursors; ///< Stack of emissions in progress (nullptr if signal is not being emitted)
+        mutable ::std::atomic<extension*> m_extension; ///< State of rare features (nullptr until one of them is used)
 
     public:
 
@@ -262,18 +750,79 @@ namespace slib {
 
         /** \brief Connects specified slot with this signal.
 
+        Slots are invoked in order of descending priority. Slots with equal priority are invoked
+        in order of their connection. Emission order is kept in the slots list itself, so emit is not slower
+        than without priorities; connect with a priority is O(log number of different priorities).
+
         \note This method is thread-safe if set_threadsafe(true).
 
-        \param _slot reference to the slot */
-        inline void connect(slot_type& _slot) const;
+        \param _slot reference to the slot
+        \param _priority emission priority (greater priority slots are invoked first)
+
+        \retval Handle of the new connection which can be used to disconnect it in O(1).
+        Empty connection is returned if connection is rejected as duplicate (see set_unique_connections). */
+        inline connection connect(slot_type& _slot, int _priority = 0) const;
 
         /** \brief Disconnects specified slot from this signal.
 
         \note This method is thread-safe if set_threadsafe(true).
 
+        \note Complexity is O(1) if unique connections mode is on, otherwise it is O(number of slot's connections).
+
         \param _slot reference to the slot */
         inline void disconnect(slot_type& _slot) const;
 
+        /** \brief Connects range of slots with this signal.
+
+        Subscriber objects are allocated first (every slot's mutex is locked once), then signal's mutex
+        is locked once and all new connections are linked into slots list in one pass.
+        Result is the same as of sequential connect() of every slot in range.
+
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \param _first Iterator to the first slot (elements of range may be slots or pointers to slots).
+        \param _last Iterator after the last slot.
+        \param _connections Pointer to array of handles of new connections (one handle for every slot; may be nullptr).
+        Handle of rejected duplicate is empty.
+        \param _priority Emission priority of all new connections.
+
+        \retval Number of connected slots. */
+        template <class slot_iterator>
+        size_t connect(slot_iterator _first, slot_iterator _last, connection* _connections = nullptr, int _priority = 0) const;
+
+        /** \brief Disconnects range of slots from this signal.
+
+        Signal's mutex is locked once and only connections lists of specified slots are traversed
+        (complexity does not depend on number of other slots connected to this signal).
+        Unlike disconnect(slot_type&), all connections of every specified slot are removed.
+
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \param _first Iterator to the first slot (elements of range may be slots or pointers to slots).
+        \param _last Iterator after the last slot.
+
+        \retval Number of removed connections. */
+        template <class slot_iterator>
+        size_t disconnect(slot_iterator _first, slot_iterator _last) const;
+
+        /** \brief Sets duplicate connections detection mode.
+
+        If mode is not unique_connections::none, then connect() rejects a slot which is a duplicate
+        of already connected one. Duplicates are found in O(1) using hash index of connections.
+        Already existing duplicates are not disconnected.
+
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \note Rebinding of connected slot is not tracked by index (index keeps hash value of slot's delegate at the moment of connection).
+
+        \param _mode Duplicates detection mode. */
+        void set_unique_connections(unique_connections _mode);
+
+        /** \brief Returns duplicate connections detection mode.
+
+        \warning This method is NOT thread-safe by itself. */
+        inline unique_connections uniqueness() const;
+
         /** \brief Disconnects all connected slots.
 
         \note This method is thread-safe if set_threadsafe(true). */
@@ -289,11 +838,180 @@ namespace slib {
         \note This method is thread-safe if set_threadsafe(true). */
         inline void operator()(Args... _args) const;
 
+        /** \brief Emits signal invoking slots in parallel on the thread pool.
+
+        Slots list is split into chunks (several chunks per pool thread). Chunks are executed by pool
+        workers and by the calling thread; method returns when all slots have been invoked.
+
+        Only slots which do a lot of independent work benefit from it: for cheap slots serial
+        emission is much faster (see "parallel" benchmark group to find the crossover point).
+
+        Profiling, flattening and recording are not applied to parallel emission.
+        Invocations of thread-affine slots are queued into their dispatchers as usual (see slot::set_affinity).
+
+        \note Include slib/executors.hpp to use this method.
+
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \warning Slots are invoked concurrently, so they must be thread-safe and they must not
+        connect or disconnect this signal (it's mutex is held by the calling thread).
+        Arguments are shared between all slots, so they are passed as lvalues. */
+        void emit_parallel(::slib::util::thread_pool& _pool, Args... _args) const;
+
+        /** \brief Queues invocation of every connected slot on the thread pool and returns immediately.
+
+        Every slot gets it's own task (copy of slot's delegate and copies of arguments) from the task cache,
+        so asynchronous emission does not allocate after warm-up. Tasks are executed in any order.
+        Invocations of thread-affine slots are queued into their dispatchers instead of the pool.
+
+        \note Include slib/executors.hpp to use this method.
+
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \warning Slots (and objects bound to them) must stay alive until their tasks are executed.
+        Downstream signals connected by to_slot() are emitted on pool threads, so they must be thread-safe. */
+        void emit_async(::slib::util::thread_pool& _pool, Args... _args) const;
+
+        /** \brief Queues emission into executor and returns future which becomes ready when emission is finished.
+
+        Unlike emit_async, the whole emission is one task (slots are invoked in order of their priorities
+        by executing thread). Slots' return values are not collected (as for emit_), use slot::post
+        to get result of a slot.
+
+        \note Include slib/executors.hpp to use this method.
+
+        \note This method is thread-safe.
+
+        \warning Signal must stay alive until emission.
+
+        \param _executor thread_pool or dispatcher which executes emission */
+        template <class executor_type>
+        inline ::slib::future<void> post(executor_type& _executor, Args... _args) const;
+
         /** \brief Test if signal is connected at least to one slot.
 
         \note This method is thread-safe if set_threadsafe(true). */
         inline bool connected() const;
 
+        /** \brief Blocks signal: it's slots stay connected but emission does nothing.
+
+        Blocks are counted: signal is unblocked after the same number of unblock() calls.
+        Emission of blocked signal costs one predictable branch.
+
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \sa scoped_block */
+        inline void block();
+
+        /** \brief Unblocks signal.
+
+        \note This method is thread-safe if set_threadsafe(true). */
+        inline void unblock();
+
+        /** \brief Tests if signal is blocked. */
+        inline bool blocked() const;
+
+        /** \brief Sets what happens if connection of another signal to this signal would create a cycle.
+
+        Cycles are detected at connect time using incremental topological order of signals (see signal_graph):
+        connection which keeps the order costs O(1), otherwise only signals between connected signals
+        in the current order are visited. Connections of ordinary slots are not checked.
+        Emission has no additional cost (except signals guarded by cycle_policy::allow_guarded).
+
+        Connection allowed by cycle_policy::allow_guarded is not a part of the order. Every cycle which goes
+        through it enters it's guarded signal, so the guard is enough to stop such cycles too.
+        The guard is removed when the last guarded connection of the signal is disconnected.
+
+        \warning This method is NOT thread-safe by itself. */
+        inline void set_cycle_policy(cycle_policy _policy);
+
+        /** \brief Returns cycle policy of this signal.
+
+        \warning This method is NOT thread-safe by itself. */
+        inline cycle_policy cycle_handling() const;
+
+        /** \brief Turns flattening of signal-to-signal chains on/off.
+
+        If flattening is on, then emission of this signal does not go through private_invoke of every connected
+        signal (taking it's mutex and walking it's list): it walks cached list of leaf slots of the whole chain.
+        Cache is rebuilt on the next emission after any signal of the chain connects or disconnects.
+
+        Connected signals which are thread-safe, profiled or have thread-affine slots are not flattened
+        (they are invoked as ordinary slots). Cache is not used while this signal has thread-affine slots.
+
+        \note This method is thread-safe if set_threadsafe(true). */
+        void set_flattening(bool _enabled);
+
+        /** \brief Returns true if flattening of signal-to-signal chains is on.
+
+        \warning This method is NOT thread-safe by itself. */
+        inline bool flattening() const;
+
+        /** \brief Enables timing of every slot invocation.
+
+        Each connection gets it's own latency histogram which records invocation time in nanoseconds.
+        Histograms are removed when profiling is disabled or when connection is destroyed.
+
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \param _sample_every Only every Nth emission is timed (use values greater than 1 to reduce overhead).
+        \param _budget Time budget in nanoseconds for one slot invocation (0 means no budget).
+        \param _on_slow_slot Handler which is called for every timed invocation exceeding _budget. */
+        void enable_profiling(unsigned int _sample_every = 1, unsigned long long _budget = 0,
+                              const slow_slot_handler& _on_slow_slot = slow_slot_handler());
+
+        /** \brief Disables timing of slot invocations and removes all collected statistics.
+
+        \note This method is thread-safe if set_threadsafe(true). */
+        void disable_profiling();
+
+        /** \brief Returns true if profiling is enabled.
+
+        \warning This method is NOT thread-safe by itself. */
+        inline bool profiling() const;
+
+        /** \brief Returns statistics of the slowest connections.
+
+        Connections are sorted by 99th percentile of their invocation time (the slowest first).
+        Connections without timed invocations are skipped.
+
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \param _number Maximum number of returned connections. */
+        ::std::vector<slot_latency_type> slowest(size_t _number) const;
+
+        /** \brief Turns collecting of lock contention statistics on/off.
+
+        \warning This method is NOT thread-safe.
+
+        \note Statistics are collected only if set_threadsafe(true).
+
+        \param _enabled Statistics flag. Turning statistics off removes all collected values. */
+        inline void enable_lock_statistics(bool _enabled);
+
+        /** \brief Returns lock contention statistics aggregated for all mutexes of this signal
+        (including mutex used when this signal is connected to another signal as a slot).
+
+        \note This method is thread-safe if set_threadsafe(true). */
+        inline lock_statistics_type lock_statistics() const;
+
+        /** \brief Starts (or stops) recording of this signal's emissions and connection changes.
+
+        Signal is registered in recorder's trace together with it's current connections (and their priorities).
+        Connected signals which are not recorded yet are registered too (with empty names), so the whole
+        signal graph can be rebuilt by trace_player.
+        Only emissions made by emit_() and operator() are recorded (emissions caused by
+        another signal connected to this one are reproduced by replaying that signal).
+        Emissions of blocked signal are not recorded.
+
+        \note Include slib/recording.hpp to use this method.
+
+        \note This method is thread-safe if set_threadsafe(true).
+
+        \param _recorder Pointer to recorder (nullptr stops recording).
+        \param _name Name of this signal in the trace. */
+        void record(recorder_type* _recorder, const char* _name = "");
+
     private:
 
         // Restricted methods
@@ -316,8 +1034,10 @@ namespace slib {
 
         \note This method is thread-safe if set_threadsafe(true).
 
-        \param _subscriber pointer to subscriber object */
-        void insert(subscriber_type* _subscriber) const;
+        \param _subscriber pointer to subscriber object
+
+        \retval false if subscriber is rejected as a duplicate */
+        bool insert(subscriber_type* _subscriber) const;
 
         /** \brief Removes slot from slots list.
 
@@ -330,8 +1050,147 @@ namespace slib {
 
         // Self private methods
 
-        /** \brief Private invoker method. */
-        void private_emit(Args&&... _args) const;
+        /** \brief Returns signal which is converted to specified slot by to_slot() (or nullptr for ordinary slots).
+
+        \param _slot Pointer to the slot. */
+        static inline const this_type* signal_of(const slot_type* _slot);
+
+        /** \brief Returns slot from element of range (used by range connect/disconnect). */
+        static inline slot_type& slot_ref(slot_type& _slot) { return _slot; }
+        static inline slot_type& slot_ref(slot_type* _slot) { return *_slot; }
+
+        /** \brief Returns id of the slot in this signal's trace (0 if it is not a recorded signal). */
+        inline unsigned int trace_id_of(const slot_type* _slot) const;
+
+        /** \brief Returns extension (nullptr if it has not been created yet). */
+        inline extension* extended() const;
+
+        /** \brief Returns extension creating it if necessary. */
+        extension& extend() const;
+
+        /** \brief Sets or clears flags of m_state. */
+        inline void set_state(unsigned int _flags, bool _enabled) const;
+
+        /** \brief Returns emission trace recorder (nullptr if recording is disabled). */
+        inline recorder_type* active_recorder() const;
+
+        /** \brief Writes emission into recorder's trace (unless signal is blocked). */
+        void record_emission(Args&... _args) const;
+
+        static void record_connect_stub(recorder_type* _recorder, unsigned int _id, unsigned int _target, int _priority);
+        static void record_disconnect_stub(recorder_type* _recorder, unsigned int _id, unsigned int _target);
+        static void record_emit_stub(recorder_type* _recorder, unsigned int _id, Args&... _args);
+
+        static const recording_operations s_recording_operations; ///< Functions of trace recorder (defined by slib/recording.hpp)
+
+        /** \brief Links subscriber into slots list according to it's priority.
+
+        \note Must be called under locked m_mutex. */
+        void link(subscriber_type* _subscriber) const;
+
+        /** \brief Unlinks subscriber from slots list and connections index.
+
+        \note Must be called under locked m_mutex. */
+        void unlink(subscriber_type* _subscriber) const;
+
+        /** \brief Tests if connection of specified subscriber to this signal is allowed by cycle policy.
+
+        Connection of another signal is inserted into signal_graph. If it closes a cycle allowed by
+        cycle_policy::allow_guarded then subscriber is marked as guarded instead (downstream signal becomes
+        guarded when the connection is linked).
+
+        \note Must be called under locked m_mutex. */
+        bool accept_connection(subscriber_type* _subscriber) const;
+
+        /** \brief Removes connection of downstream signal (if subscriber represents one) from signal_graph or from guards.
+
+        \note Must be called under locked m_mutex. */
+        void unlink_downstream(const subscriber_type* _subscriber) const;
+
+        /** \brief Invalidates flattened caches which contain this signal's slots.
+
+        Only caches of signals which have visited this signal while flattening notice the change (by generation
+        of this signal), flattened emissions of unrelated chains are not affected.
+
+        \note Must be called under locked m_mutex after any change of slots list. */
+        inline void topology_changed() const;
+
+        /** \brief Appends leaf slots of specified signal to flattened list.
+
+        Every visited downstream signal is appended to _signals (if it is not nullptr) after it's upstream.
+
+        \note Flattened signals are not thread-safe, so their lists can be read without locking. */
+        static void flatten(const this_type& _signal, leaves_type& _leaves, flat_signals_type* _signals);
+
+        /** \brief Returns true if none of flattened signals has changed since cache was built.
+
+        \note Signals are checked in order of visiting, so destroyed signal is never read: it's upstream has changed before. */
+        static bool unchanged(const flat_signals_type& _signals);
+
+        /** \brief Emits signal using flattened cache.
+
+        \note Must be called only under locked m_mutex.
+
+        \retval false if cache can not be used (it is invalid and nested emission is in progress). */
+        bool private_emit_flat(const emission_cursor& _cursor, Args&&... _args) const;
+
+        /** \brief Finishes flattened emission after topology has been changed by invoked slot.
+
+        Only remaining leaves which are still reachable from this signal are invoked.
+
+        \param _position Index of the first leaf which has not been invoked yet. */
+        void private_emit_flat_changed(const emission_cursor& _cursor, size_t _position, Args&&... _args) const;
+
+        /** \brief Returns hash value of the slot in connections index. */
+        inline unsigned int index_hash(const slot_type* _slot) const;
+
+        /** \brief Returns position of indexed subscriber in index buckets (or buckets number if it is not indexed). */
+        size_t index_position(const subscriber_type* _subscriber) const;
+
+        /** \brief Returns indexed subscriber which is a duplicate of specified slot (or nullptr).
+
+        \param _exact If true then subscriber of exactly this slot is searched (independently of index mode). */
+        subscriber_type* index_find(const slot_type* _slot, bool _exact) const;
+
+        /** \brief Adds subscriber into connections index. */
+        void index_insert(subscriber_type* _subscriber) const;
+
+        /** \brief Removes subscriber from connections index. */
+        void index_erase(subscriber_type* _subscriber) const;
+
+        /** \brief Blocks/unblocks connection represented by subscriber.
+
+        \note Must be called under locked slot's mutex (subscriber can not be destroyed meanwhile). */
+        void block_connection(subscriber_type* _subscriber, bool _blocked) const;
+
+        /** \brief Sets dispatcher of thread-affine slot for connection represented by subscriber.
+
+        \note Must be called under locked slot's mutex (subscriber can not be destroyed meanwhile). */
+        void set_connection_affinity(subscriber_type* _subscriber, ::slib::util::dispatcher* _dispatcher) const;
+
+        /** \brief Invokes slot of thread-affine connection or queues it's invocation into slot's dispatcher. */
+        static inline void invoke_affine(const subscriber_type* _subscriber, Args&&... _args);
+
+        /** \brief Invokes slots of signal without state flags (it is not thread-safe, so it's mutex is not locked).
+
+        \note Emission of a single slot costs one test of m_state and registration of emission_cursor. */
+        inline void private_emit(Args&&... _args) const;
+
+        /** \brief Emits signal which has any state flag (it is blocked, thread-safe, flattened, profiled etc.).
+
+        \param _state Value of m_state read by caller. */
+        void private_emit_special(unsigned int _state, Args&&... _args) const;
+
+        /** \brief Invokes slots of one chunk of parallel emission. */
+        static void run_parallel_chunk(::slib::util::pool_task* _task);
+
+        template <int ... S>
+        static inline void invoke_parallel_chunk(const parallel_chunk& _chunk, ::slib::util::args_sequence<S...>);
+
+        /** \brief Private invoker method which measures every slot invocation.
+
+        \note Must be called only under locked m_mutex. */
+        void private_emit_profiled(emission_cursor& _cursor, Args&&... _args) const;
 
         /** \brief This is emit_.
 
@@ -348,6 +1207,41 @@ namespace slib {
 
     //////////////////////////////////////////////////////////////////////////
 
+    /** \brief Blocks signal during it's lifetime.
+
+    Usage example:
+    \code
+    {
+        slib::scoped_block<slib::signal<void(int)> > block(changed);
+        // ... bulk update, changed is not emitted
+    }
+    \endcode
+
+    \ingroup slib */
+    template <class signal_type>
+    class scoped_block final
+    {
+        signal_type& m_signal; ///< Blocked signal
+
+        scoped_block(const scoped_block&) = delete;
+        scoped_block& operator = (const scoped_block&) = delete;
+
+    public:
+
+        explicit scoped_block(signal_type& _signal) : m_signal(_signal)
+        {
+            m_signal.block();
+        }
+
+        ~scoped_block()
+        {
+            m_signal.unblock();
+        }
+
+    }; // END class scoped_block.
+
+    //////////////////////////////////////////////////////////////////////////
+
 } // END namespace slib.
 
 //////////////////////////////////////////////////////////////////////////
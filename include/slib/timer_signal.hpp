@@ -0,0 +1,573 @@
+/***************************************************************************************
+* file        : timer_signal.hpp
+*             :
+* description : This header contains description of timer_scheduler and timer_signal classes.
+*             : Timer signal emits signal<void()> or signal<void(time_point)> when it expires
+*             : (once or periodically). Timer signals are intrusive timers of scheduler's
+*             : timer_wheel, so start and stop are O(1) and millions of timers may be active.
+*             :
+*             : Scheduler's wheel is advanced either by poll() from user's event loop or by
+*             : scheduler's own thread (see timer_scheduler::start). Timer signal with dispatcher
+*             : queues it's emission into dispatcher, so slots are invoked by dispatcher's owner thread.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__TIMER_SIGNAL__HPP_
+#define SIGNALS_LIBRARY__TIMER_SIGNAL__HPP_
+
+#include "slib/executors.hpp"
+#include "slib/util/timer_wheel.hpp"
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <type_traits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Owner of timer wheel which drives timer signals.
+
+    Usage example (polling):
+    \code
+    slib::timer_scheduler scheduler(std::chrono::milliseconds(1));
+    slib::timer_signal<> heartbeat(scheduler);
+    heartbeat.connect(connection_monitor.on_heartbeat);
+    heartbeat.start(std::chrono::seconds(1));
+    // ... event loop:
+    scheduler.poll();
+    \endcode
+
+    Usage example (scheduler thread):
+    \code
+    slib::timer_scheduler scheduler(std::chrono::milliseconds(1), true);
+    scheduler.start(); // timers expire on scheduler thread
+    \endcode
+
+    Scheduler's wheel may be shared with other timers (for example, with throttled_signal and debounced_signal):
+    scheduler thread is woken by timers scheduled directly through the wheel too.
+
+    \ingroup slib */
+    class timer_scheduler final
+    {
+    public:
+
+        typedef ::slib::util::timer_wheel::clock_type clock_type;
+
+    private:
+
+        ::slib::util::timer_wheel           m_wheel; ///< Wheel of all timers
+        ::std::thread                      m_thread; ///< Scheduler thread (not joinable if it is not started)
+        ::std::mutex                        m_mutex; ///< Protects m_wakeup, m_running and m_notified
+        ::std::condition_variable       m_condition; ///< Scheduler thread sleeps on it until the next expiry
+        clock_type::time_point             m_wakeup; ///< Time of scheduler thread's wake-up (min() while it advances wheel)
+        bool                              m_running; ///< True while scheduler thread must work
+        bool                             m_notified; ///< True if timer has been scheduled while thread was advancing wheel
+        bool                              m_started; ///< True if scheduler thread is started
+
+        timer_scheduler(const timer_scheduler&) = delete;
+        timer_scheduler& operator = (const timer_scheduler&) = delete;
+
+    public:
+
+        /** \brief Constructs scheduler.
+
+        \param _resolution Duration of one tick of timer wheel (timers expire with this precision).
+        \param _is_threadsafe Thread-safety flag (it must be true if scheduler thread is used or if timers
+        are started and stopped by different threads). */
+        template <class rep_type = long long, class period_type = ::std::milli>
+        explicit timer_scheduler(const ::std::chrono::duration<rep_type, period_type>& _resolution = ::std::chrono::milliseconds(1), bool _is_threadsafe = false)
+            : m_wheel(_resolution, _is_threadsafe)
+            , m_wakeup(clock_type::time_point::min())
+            , m_running(false)
+            , m_notified(false)
+            , m_started(false)
+        {
+            m_wheel.set_wake_function(&timer_scheduler::wake, this);
+        }
+
+        /** \brief Stops scheduler thread.
+
+        \warning All timers must be stopped before destruction. */
+        ~timer_scheduler()
+        {
+            stop();
+        }
+
+        /** \brief Returns timer wheel. */
+        inline ::slib::util::timer_wheel& wheel()
+        {
+            return m_wheel;
+        }
+
+        /** \brief Returns thread-safety flag. */
+        inline bool threadsafe() const
+        {
+            return m_wheel.threadsafe();
+        }
+
+        /** \brief Returns true if scheduler thread is started. */
+        inline bool running() const
+        {
+            return m_started;
+        }
+
+        /** \brief Starts scheduler thread which advances wheel (timers expire on this thread).
+
+        \warning This method is NOT thread-safe. Use this on initialization.
+
+        \retval false if scheduler is not thread-safe or if thread is already started. */
+        bool start()
+        {
+            if (m_started || !threadsafe())
+            {
+                return false;
+            }
+
+            ::std::lock_guard<::std::mutex> lg(m_mutex); // thread waits for m_thread and m_started assignment
+            m_running = true;
+            m_notified = false;
+            m_thread = ::std::thread(&timer_scheduler::run, this);
+            m_started = true;
+
+            return true;
+        }
+
+        /** \brief Stops scheduler thread and waits for it's completion.
+
+        \warning This method is NOT thread-safe and it must not be called by scheduler thread. */
+        void stop()
+        {
+            if (!m_started)
+            {
+                return;
+            }
+
+            {
+                ::std::lock_guard<::std::mutex> lg(m_mutex);
+                m_running = false;
+            }
+
+            m_condition.notify_one();
+            m_thread.join();
+            m_started = false;
+        }
+
+        /** \brief Invokes expired timers (advances wheel up to specified time).
+
+        \warning Must not be used while scheduler thread is started.
+
+        \retval Number of expired timers. */
+        inline size_t poll(clock_type::time_point _now = clock_type::now())
+        {
+            return m_wheel.advance(_now);
+        }
+
+        /** \brief Returns time of the next poll() which would do some work (see timer_wheel::next_expiry). */
+        inline clock_type::time_point next_expiry() const
+        {
+            return m_wheel.next_expiry();
+        }
+
+        /** \brief Schedules timer (reschedules it if it is already scheduled) and wakes scheduler thread if it is needed.
+
+        \note Complexity is O(1).
+
+        \note This method is thread-safe if threadsafe() is true. */
+        inline void schedule(::slib::util::timer_node* _timer, clock_type::time_point _deadline)
+        {
+            m_wheel.schedule(_timer, _deadline); // wheel calls wake()
+        }
+
+        /** \brief Cancels timer (see timer_wheel::cancel).
+
+        \note Complexity is O(1). */
+        inline bool cancel(::slib::util::timer_node* _timer)
+        {
+            return m_wheel.cancel(_timer);
+        }
+
+        /** \brief Cancels timer and waits for completion of it's handler (see timer_wheel::cancel_and_wait). */
+        inline void cancel_and_wait(::slib::util::timer_node* _timer)
+        {
+            m_wheel.cancel_and_wait(_timer);
+        }
+
+    private:
+
+        /** \brief Wakes scheduler thread if scheduled timer expires earlier than it's wake-up (wake function of the wheel).
+
+        Scheduler thread itself is not woken: it reads the next expiry after advancing wheel. */
+        static void wake(void* _scheduler, clock_type::time_point _deadline)
+        {
+            timer_scheduler* that = static_cast<timer_scheduler*>(_scheduler);
+            if (that->m_started && ::std::this_thread::get_id() != that->m_thread.get_id())
+            {
+                ::std::lock_guard<::std::mutex> lg(that->m_mutex);
+                if (_deadline < that->m_wakeup || that->m_wakeup == clock_type::time_point::min())
+                {
+                    that->m_notified = true;
+                    that->m_condition.notify_one();
+                }
+            }
+        }
+
+        /** \brief Function of scheduler thread: advances wheel and sleeps until the next expiry. */
+        void run()
+        {
+            ::std::unique_lock<::std::mutex> lock(m_mutex);
+            while (m_running)
+            {
+                m_wakeup = clock_type::time_point::min();
+                m_notified = false;
+                lock.unlock();
+
+                m_wheel.advance();
+                const clock_type::time_point next = m_wheel.next_expiry();
+
+                lock.lock();
+                if (m_notified)
+                {
+                    continue; // new timer may expire earlier than next
+                }
+
+                m_wakeup = next;
+                if (next == clock_type::time_point::max())
+                {
+                    m_condition.wait(lock, [this]() { return !m_running || m_notified; });
+                }
+                else
+                {
+                    m_condition.wait_until(lock, next, [this]() { return !m_running || m_notified; });
+                }
+            }
+        }
+
+    }; // END class timer_scheduler.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Signal which is emitted when timer expires.
+
+    Template argument is signature of emitted signal: void() or void(timer_scheduler::clock_type::time_point).
+    Emitted time is the time at which timer was due.
+
+    Usage example:
+    \code
+    slib::timer_signal<void(slib::timer_scheduler::clock_type::time_point)> frame(scheduler, true);
+    frame.connect(renderer.on_frame);
+    frame.set_dispatcher(&gui); // renderer.on_frame is invoked by GUI thread
+    frame.start(std::chrono::milliseconds(16));
+    \endcode
+
+    Periodic timer is rescheduled relative to it's previous due time, so it does not drift.
+    If previous expiry has not been delivered by dispatcher yet, new expiry is not queued again
+    (it replaces the queued one and it is counted by overruns()).
+
+    \ingroup slib */
+    template <class function_signature = void()>
+    class timer_signal final
+    {
+    public:
+
+        typedef timer_scheduler::clock_type                    clock_type;
+        typedef ::slib::slot<function_signature>                slot_type;
+        typedef ::slib::signal<function_signature>            signal_type;
+
+    private:
+
+        static_assert(::std::is_same<function_signature, void()>::value || ::std::is_same<function_signature, void(clock_type::time_point)>::value,
+                      "timer_signal can emit only signal<void()> or signal<void(clock_type::time_point)>");
+
+        typedef ::slib::util::dynamic_mutex          dynamic_mutex;
+        typedef ::slib::util::lock_guard<dynamic_mutex> lock_guard;
+
+        /** \brief Timer of timer_signal. */
+        struct expiry_timer final : public ::slib::util::timer_node
+        {
+            timer_signal* owner; ///< Timer signal which owns timer
+
+            explicit expiry_timer(timer_signal* _owner) : ::slib::util::timer_node(&timer_signal::expire), owner(_owner)
+            {
+            }
+        };
+
+        /** \brief Emission queued into dispatcher. */
+        struct delivery_task final : public ::slib::util::pool_task
+        {
+            timer_signal* owner; ///< Timer signal which owns task
+
+            explicit delivery_task(timer_signal* _owner) : ::slib::util::pool_task(&timer_signal::deliver), owner(_owner)
+            {
+            }
+        };
+
+        signal_type                     m_signal; ///< Emitted signal
+        expiry_timer                     m_timer; ///< Timer of scheduler's wheel
+        delivery_task                     m_task; ///< Emission queued into m_dispatcher
+        timer_scheduler&             m_scheduler; ///< Scheduler which drives timer
+        ::slib::util::dispatcher*   m_dispatcher; ///< Dispatcher which emits signal (nullptr if signal is emitted by expiring thread)
+        clock_type::duration          m_interval; ///< Period of periodic timer (zero for single shot timer)
+        clock_type::time_point        m_deadline; ///< Time at which timer is due
+        clock_type::time_point          m_queued; ///< Due time of expiry queued into m_dispatcher
+        unsigned long long            m_overruns; ///< Number of expiries which were not emitted separately
+        dynamic_mutex                    m_mutex; ///< Mutex for multithreading protection (it is not multithreated by default)
+        bool                            m_active; ///< True if timer is started and it has not been stopped (or expired if single shot)
+        bool                         m_scheduled; ///< True if m_task is queued into m_dispatcher
+
+        timer_signal(const timer_signal&) = delete;
+        timer_signal& operator = (const timer_signal&) = delete;
+
+    public:
+
+        /** \brief Constructs stopped timer.
+
+        \param _scheduler Scheduler which drives timer.
+        \param _is_threadsafe Thread-safety flag (emitted signal gets the same flag). */
+        explicit timer_signal(timer_scheduler& _scheduler, bool _is_threadsafe = false)
+            : m_signal(_is_threadsafe)
+            , m_timer(this)
+            , m_task(this)
+            , m_scheduler(_scheduler)
+            , m_dispatcher(nullptr)
+            , m_interval(clock_type::duration::zero())
+            , m_overruns(0)
+            , m_mutex(_is_threadsafe)
+            , m_active(false)
+            , m_scheduled(false)
+        {
+        }
+
+        /** \brief Stops timer.
+
+        \warning Emission queued into dispatcher must be processed before destruction. */
+        ~timer_signal()
+        {
+            stop();
+        }
+
+        /** \brief Returns emitted signal. */
+        inline signal_type& target()
+        {
+            return m_signal;
+        }
+
+        /** \brief Connects slot to emitted signal (see signal::connect). */
+        inline connection connect(slot_type& _slot, int _priority = 0) const
+        {
+            return m_signal.connect(_slot, _priority);
+        }
+
+        /** \brief Disconnects slot from emitted signal. */
+        inline void disconnect(slot_type& _slot) const
+        {
+            m_signal.disconnect(_slot);
+        }
+
+        /** \brief Sets dispatcher which emits signal (expiry is queued into dispatcher unless it expires on dispatcher's owner thread).
+
+        \warning This method is NOT thread-safe. Use this on initialization.
+
+        \param _dispatcher Pointer to dispatcher (nullptr means signal is emitted by thread which advances wheel). */
+        inline void set_dispatcher(::slib::util::dispatcher* _dispatcher)
+        {
+            m_dispatcher = _dispatcher;
+        }
+
+        /** \brief Starts (restarts) periodic timer which expires every _interval.
+
+        \note Complexity is O(1).
+
+        \note This method is thread-safe if threadsafe flag is true. */
+        template <class rep_type, class period_type>
+        inline void start(const ::std::chrono::duration<rep_type, period_type>& _interval)
+        {
+            arm(::std::chrono::duration_cast<clock_type::duration>(_interval), true);
+        }
+
+        /** \brief Starts (restarts) single shot timer which expires once after _delay.
+
+        \note Complexity is O(1).
+
+        \note This method is thread-safe if threadsafe flag is true. */
+        template <class rep_type, class period_type>
+        inline void start_once(const ::std::chrono::duration<rep_type, period_type>& _delay)
+        {
+            arm(::std::chrono::duration_cast<clock_type::duration>(_delay), false);
+        }
+
+        /** \brief Stops timer.
+
+        If timer is expiring on another thread, waits until it's expiration is finished,
+        so timer is not rescheduled after stop().
+
+        \note This method is thread-safe if threadsafe flag is true. It may be called by connected slots.
+
+        \retval true if timer was active. */
+        bool stop()
+        {
+            m_mutex.lock();
+            const bool active = m_active;
+            m_active = false;
+            m_mutex.unlock();
+
+            m_scheduler.cancel_and_wait(&m_timer);
+
+            return active;
+        }
+
+        /** \brief Returns true if timer is started and it has not been stopped (single shot timer becomes inactive on expiry). */
+        inline bool active() const
+        {
+            lock_guard lg(m_mutex);
+            return m_active;
+        }
+
+        /** \brief Returns period of periodic timer (zero for single shot timer). */
+        inline clock_type::duration interval() const
+        {
+            lock_guard lg(m_mutex);
+            return m_interval;
+        }
+
+        /** \brief Returns number of expiries which were not emitted separately (skipped periods or expiries merged by dispatcher). */
+        inline unsigned long long overruns() const
+        {
+            lock_guard lg(m_mutex);
+            return m_overruns;
+        }
+
+    private:
+
+        void arm(clock_type::duration _delay, bool _periodic)
+        {
+            if (_delay < m_scheduler.wheel().resolution())
+            {
+                _delay = m_scheduler.wheel().resolution();
+            }
+
+            lock_guard lg(m_mutex);
+
+            m_active = true;
+            m_interval = _periodic ? _delay : clock_type::duration::zero();
+            m_deadline = clock_type::now() + _delay;
+            m_scheduler.schedule(&m_timer, m_deadline);
+        }
+
+        inline void emit_(clock_type::time_point _time) const
+        {
+            private_emit(m_signal, _time);
+        }
+
+        static inline void private_emit(const ::slib::signal<void()>& _signal, clock_type::time_point)
+        {
+            _signal.emit_();
+        }
+
+        static inline void private_emit(const ::slib::signal<void(clock_type::time_point)>& _signal, clock_type::time_point _time)
+        {
+            _signal.emit_(_time);
+        }
+
+        /** \brief Function of expiry_timer: reschedules periodic timer and emits signal (or queues emission into dispatcher). */
+        static void expire(::slib::util::timer_node* _timer)
+        {
+            timer_signal* that = static_cast<expiry_timer*>(_timer)->owner;
+
+            that->m_mutex.lock();
+
+            if (!that->m_active)
+            {
+                that->m_mutex.unlock();
+                return;
+            }
+
+            const clock_type::time_point due = that->m_deadline;
+
+            if (that->m_interval != clock_type::duration::zero())
+            {
+                const clock_type::time_point now = that->m_scheduler.wheel().time();
+                clock_type::time_point next = due + that->m_interval;
+                if (next <= now)
+                {
+                    // expiry was late for more than one period: skipped periods are not emitted
+                    const clock_type::rep skipped = (now - due) / that->m_interval;
+                    that->m_overruns += static_cast<unsigned long long>(skipped);
+                    next = due + that->m_interval * (skipped + 1);
+                }
+
+                that->m_deadline = next;
+                that->m_scheduler.schedule(&that->m_timer, next);
+            }
+            else
+            {
+                that->m_active = false;
+            }
+
+            if (that->m_dispatcher != nullptr && !that->m_dispatcher->is_current())
+            {
+                const bool submit = !that->m_scheduled;
+                if (!submit)
+                {
+                    ++that->m_overruns; // previous expiry is still queued: it will be emitted with the latest due time
+                }
+
+                that->m_scheduled = true;
+                that->m_queued = due;
+                that->m_mutex.unlock();
+
+                if (submit)
+                {
+                    that->m_dispatcher->submit(&that->m_task);
+                }
+
+                return;
+            }
+
+            that->m_mutex.unlock();
+            that->emit_(due);
+        }
+
+        /** \brief Function of delivery_task queued into dispatcher. */
+        static void deliver(::slib::util::pool_task* _task)
+        {
+            timer_signal* that = static_cast<delivery_task*>(_task)->owner;
+
+            that->m_mutex.lock();
+            that->m_scheduled = false;
+            const clock_type::time_point due = that->m_queued;
+            that->m_mutex.unlock();
+
+            that->emit_(due);
+        }
+
+    }; // END class timer_signal.
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__TIMER_SIGNAL__HPP_
@@ -0,0 +1,452 @@
+/***************************************************************************************
+* file        : topic_router.hpp
+*             :
+* description : This header contains description of topic_router class which routes
+*             : hierarchical topics (segments separated by dots, for example "orders.eu.new")
+*             : to slots subscribed to topic patterns.
+*             :
+*             : Pattern segment "*" matches exactly one topic segment.
+*             : Pattern segment "#" may be only the last one and matches any number
+*             : (including zero) of remaining topic segments: "orders.#" matches "orders",
+*             : "orders.eu" and "orders.eu.new".
+*             :
+*             : Every pattern owns a signal to which slots are connected. Every published
+*             : topic gets cached signal which is connected (as signal-to-signal connection)
+*             : to signals of all matching patterns. Patterns are stored in a trie which is used
+*             : to resolve new topics. Subscription to a new pattern connects it only to already
+*             : cached matching topics, removal of a pattern disconnects it from them, so cache
+*             : is never rebuilt. Publishing is one hash lookup followed by an ordinary emit.
+*             :
+*             : Number of cached topics is limited: when the limit is reached, a topic which has
+*             : not been published since the previous eviction pass is destroyed (second chance
+*             : replacement), so routers with unbounded topic spaces do not grow without limit.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__TOPIC_ROUTER__HPP_
+#define SIGNALS_LIBRARY__TOPIC_ROUTER__HPP_
+
+#include "slib/signals.hpp"
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <assert.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    template <typename function_signature> class topic_router;
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Routes published topics to slots subscribed to topic patterns.
+
+    Usage example:
+    \code
+    slib::topic_router<void(const order&)> router;
+    router.subscribe("orders.eu.*", on_eu_order);
+    router.subscribe("orders.#", on_any_order);
+    router.publish("orders.eu.new", ord); // both slots are invoked
+    \endcode
+
+    \warning Topics must not contain wildcard segments. Patterns with "#" which is not the last segment are rejected.
+
+    \ingroup slib */
+    template <typename return_type, typename ... Args>
+    class topic_router < return_type(Args...) >
+    {
+    public:
+
+        typedef ::slib::slot< return_type(Args...) >           slot_type;
+        typedef ::slib::signal< return_type(Args...) >       signal_type;
+
+    private:
+
+        typedef ::slib::util::dynamic_mutex              dynamic_mutex;
+        typedef ::slib::util::lock_guard<dynamic_mutex>     lock_guard;
+        typedef ::std::vector<::std::string>             segments_type;
+
+        /** \brief Node of patterns trie. */
+        struct node final
+        {
+            ::std::unordered_map<::std::string, ::std::unique_ptr<node> > children; ///< Child nodes by segment (including "*" and "#")
+            signal_type*                                                     pattern; ///< Signal of pattern which ends at this node (or nullptr)
+
+            node() : pattern(nullptr)
+            {
+            }
+        };
+
+        /** \brief Cached signal of published topic.
+
+        Signal is shared with publishing threads, so evicted topic is destroyed after it's last emission. */
+        struct cached_topic final
+        {
+            ::std::shared_ptr<signal_type> sgnl; ///< Signal connected to all matching patterns
+            bool                     referenced; ///< True if topic has been published since the previous eviction pass
+        };
+
+        typedef ::std::unordered_map<::std::string, ::std::unique_ptr<signal_type> > signals_map;
+        typedef ::std::unordered_map<::std::string, cached_topic>                     topics_map;
+
+        signals_map        m_patterns; ///< Signals of subscribed patterns
+        topics_map           m_topics; ///< Cached signals of published topics
+        node                   m_root; ///< Root of patterns trie
+        dynamic_mutex         m_mutex; ///< Mutex for multithreading protection (it is not multithreated by default)
+        const size_t      m_max_topics; ///< Maximum number of cached topics
+
+        topic_router(const topic_router&) = delete;
+        topic_router& operator = (const topic_router&) = delete;
+
+    public:
+
+        /** \brief Constructs router.
+
+        \param _is_threadsafe Thread-safety flag (signals of all patterns and topics get the same flag).
+        \param _max_topics Maximum number of cached topics (at least 1). */
+        explicit topic_router(bool _is_threadsafe = false, size_t _max_topics = 4096)
+            : m_mutex(_is_threadsafe)
+            , m_max_topics(_max_topics == 0 ? 1 : _max_topics)
+        {
+        }
+
+        ~topic_router()
+        {
+            // topic signals must be destroyed before patterns they are connected to
+            m_topics.clear();
+        }
+
+        /** \brief Subscribes slot to topic pattern.
+
+        \note This method is thread-safe if router is thread-safe.
+
+        \param _pattern Topic pattern (may contain "*" segments and "#" as the last segment).
+        \param _slot Reference to the slot.
+        \param _priority Emission priority among slots of the same pattern (see signal::connect).
+
+        \retval Handle of the new connection (empty handle if pattern is not valid). */
+        connection subscribe(const ::std::string& _pattern, slot_type& _slot, int _priority = 0)
+        {
+            const segments_type segments = split(_pattern);
+            if (!valid(segments))
+            {
+                assert(false && "topic_router: \"#\" must be the last segment of pattern");
+                return connection();
+            }
+
+            lock_guard lg(m_mutex);
+            return pattern_signal(_pattern, segments).connect(_slot, _priority);
+        }
+
+        /** \brief Unsubscribes slot from topic pattern.
+
+        \note Pattern itself stays subscribed (use unsubscribe(_pattern) to remove it).
+
+        \note This method is thread-safe if router is thread-safe. */
+        void unsubscribe(const ::std::string& _pattern, slot_type& _slot)
+        {
+            lock_guard lg(m_mutex);
+
+            auto it = m_patterns.find(_pattern);
+            if (it != m_patterns.end())
+            {
+                it->second->disconnect(_slot);
+            }
+        }
+
+        /** \brief Unsubscribes all slots of topic pattern and removes the pattern.
+
+        \warning No one must publish topics matching this pattern during this call. */
+        void unsubscribe(const ::std::string& _pattern)
+        {
+            lock_guard lg(m_mutex);
+
+            auto it = m_patterns.find(_pattern);
+            if (it == m_patterns.end())
+            {
+                return;
+            }
+
+            const segments_type segments = split(_pattern);
+            ::std::vector<node*> path(1, &m_root);
+            for (const auto& segment : segments)
+            {
+                path.push_back(path.back()->children.find(segment)->second.get());
+            }
+            path.back()->pattern = nullptr;
+
+            // remove nodes which have neither pattern nor children
+            for (size_t i = segments.size(); i != 0 && path[i]->pattern == nullptr && path[i]->children.empty(); --i)
+            {
+                path[i - 1]->children.erase(segments[i - 1]);
+            }
+
+            // signal's destructor disconnects it from all topics
+            m_patterns.erase(it);
+        }
+
+        /** \brief Emits signals of all patterns which match specified topic.
+
+        \note This method is thread-safe if router is thread-safe. */
+        void publish(const ::std::string& _topic, Args... _args)
+        {
+            m_mutex.lock();
+
+            ::std::shared_ptr<signal_type> sgnl; // keeps signal alive if topic is evicted during emission
+            auto it = m_topics.find(_topic);
+            if (it != m_topics.end())
+            {
+                it->second.referenced = true;
+                sgnl = it->second.sgnl;
+            }
+            else
+            {
+                sgnl = resolve(_topic);
+            }
+
+            m_mutex.unlock();
+
+            sgnl->emit_(::std::forward<Args>(_args)...);
+        }
+
+        /** \brief Emits signals of all patterns which match specified topic. */
+        inline void operator()(const ::std::string& _topic, Args... _args)
+        {
+            publish(_topic, ::std::forward<Args>(_args)...);
+        }
+
+        /** \brief Returns maximum number of cached topics. */
+        inline size_t max_cached_topics() const
+        {
+            return m_max_topics;
+        }
+
+        /** \brief Returns number of cached topics. */
+        inline size_t cached_topics() const
+        {
+            lock_guard lg(m_mutex);
+            return m_topics.size();
+        }
+
+        /** \brief Destroys all cached topics (topics which are being published are destroyed after emission).
+
+        \note This method is thread-safe if router is thread-safe. */
+        void clear_cache()
+        {
+            lock_guard lg(m_mutex);
+            m_topics.clear();
+        }
+
+        /** \brief Tests if topic matches pattern.
+
+        \retval false if pattern is not valid ("#" is not the last segment). */
+        static bool matches(const ::std::string& _pattern, const ::std::string& _topic)
+        {
+            const segments_type pattern = split(_pattern);
+            return valid(pattern) && matches(pattern, split(_topic));
+        }
+
+        /** \brief Returns true if pattern can be subscribed ("#" may be only the last segment). */
+        static bool valid(const ::std::string& _pattern)
+        {
+            return valid(split(_pattern));
+        }
+
+    private:
+
+        /** \brief Splits topic or pattern into segments. */
+        static segments_type split(const ::std::string& _text)
+        {
+            segments_type segments;
+
+            size_t begin = 0;
+            while (true)
+            {
+                const size_t end = _text.find('.', begin);
+                segments.push_back(_text.substr(begin, end == ::std::string::npos ? ::std::string::npos : end - begin));
+                if (end == ::std::string::npos)
+                {
+                    break;
+                }
+
+                begin = end + 1;
+            }
+
+            return segments;
+        }
+
+        static bool valid(const segments_type& _pattern)
+        {
+            for (size_t i = 0; i + 1 < _pattern.size(); ++i)
+            {
+                if (_pattern[i] == "#")
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        static bool matches(const segments_type& _pattern, const segments_type& _topic)
+        {
+            for (size_t i = 0; i < _pattern.size(); ++i)
+            {
+                if (_pattern[i] == "#")
+                {
+                    return true;
+                }
+
+                if (i == _topic.size() || (_pattern[i] != "*" && _pattern[i] != _topic[i]))
+                {
+                    return false;
+                }
+            }
+
+            return _pattern.size() == _topic.size();
+        }
+
+        /** \brief Returns signal of pattern (creates it and connects to cached matching topics if necessary).
+
+        \note Must be called under locked m_mutex. */
+        signal_type& pattern_signal(const ::std::string& _pattern, const segments_type& _segments)
+        {
+            ::std::unique_ptr<signal_type>& sgnl = m_patterns[_pattern];
+            if (sgnl != nullptr)
+            {
+                return *sgnl;
+            }
+
+            sgnl.reset(new signal_type(m_mutex.threadsafe()));
+
+            node* current = &m_root;
+            for (const auto& segment : _segments)
+            {
+                ::std::unique_ptr<node>& child = current->children[segment];
+                if (child == nullptr)
+                {
+                    child.reset(new node());
+                }
+
+                current = child.get();
+            }
+            current->pattern = sgnl.get();
+
+            // incremental cache update: only topics matching new pattern are touched
+            for (auto& topic : m_topics)
+            {
+                if (matches(_segments, split(topic.first)))
+                {
+                    topic.second.sgnl->connect(sgnl->to_slot());
+                }
+            }
+
+            return *sgnl;
+        }
+
+        /** \brief Creates cached signal of topic and connects it to all matching patterns.
+
+        \note Must be called under locked m_mutex. */
+        ::std::shared_ptr<signal_type> resolve(const ::std::string& _topic)
+        {
+            ::std::vector<signal_type*> patterns;
+            collect(m_root, split(_topic), 0, patterns);
+
+            if (m_topics.size() >= m_max_topics)
+            {
+                evict();
+            }
+
+            cached_topic& topic = m_topics[_topic];
+            topic.sgnl = ::std::make_shared<signal_type>(m_mutex.threadsafe());
+            topic.referenced = false;
+            for (auto pattern : patterns)
+            {
+                topic.sgnl->connect(pattern->to_slot());
+            }
+
+            return topic.sgnl;
+        }
+
+        /** \brief Destroys one cached topic which has not been published since the previous eviction pass.
+
+        \note Must be called under locked m_mutex. */
+        void evict()
+        {
+            while (true)
+            {
+                for (auto it = m_topics.begin(); it != m_topics.end(); ++it)
+                {
+                    if (!it->second.referenced)
+                    {
+                        m_topics.erase(it);
+                        return;
+                    }
+
+                    it->second.referenced = false; // second chance
+                }
+            }
+        }
+
+        /** \brief Collects signals of all patterns which match topic segments starting from _index. */
+        static void collect(const node& _node, const segments_type& _segments, size_t _index, ::std::vector<signal_type*>& _patterns)
+        {
+            auto it = _node.children.find("#");
+            if (it != _node.children.end() && it->second->pattern != nullptr)
+            {
+                _patterns.push_back(it->second->pattern);
+            }
+
+            if (_index == _segments.size())
+            {
+                if (_node.pattern != nullptr)
+                {
+                    _patterns.push_back(_node.pattern);
+                }
+
+                return;
+            }
+
+            it = _node.children.find(_segments[_index]);
+            if (it != _node.children.end())
+            {
+                collect(*it->second, _segments, _index + 1, _patterns);
+            }
+
+            it = _node.children.find("*");
+            if (it != _node.children.end())
+            {
+                collect(*it->second, _segments, _index + 1, _patterns);
+            }
+        }
+
+    }; // END class topic_router.
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__TOPIC_ROUTER__HPP_
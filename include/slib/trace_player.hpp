@@ -0,0 +1,407 @@
+/***************************************************************************************
+* file        : trace_player.hpp
+*             :
+* description : This header contains description of trace_player class which loads emission
+*             : trace written by slib::util::trace_recorder, rebuilds recorded signal graph
+*             : and replays connection changes and emissions in original order.
+*             :
+*             : Every recorded signal is replaced by a signal with generic signature
+*             : void(const unsigned char* arguments, unsigned int size), and every ordinary slot
+*             : is replaced by a synthetic slot binded to user delegate. Links between recorded
+*             : signals and priorities of connections are restored as they were recorded.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__TRACE_PLAYER__HPP_
+#define SIGNALS_LIBRARY__TRACE_PLAYER__HPP_
+
+#include "slib/recording.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Rebuilds signal graph from emission trace and replays it.
+
+    Usage example:
+    \code
+    slib::trace_player player(slib::trace_player::delegate_type::from_function<consume>());
+    if (player.load("emissions.trace"))
+    {
+        player.replay(); // consume() is invoked by every emission which reaches an ordinary slot
+    }
+    \endcode
+
+    \sa slib::util::trace_recorder
+
+    \ingroup slib */
+    class trace_player final
+    {
+    public:
+
+        typedef ::slib::signal<void(const unsigned char*, unsigned int)>     signal_type;
+        typedef ::slib::slot<void(const unsigned char*, unsigned int)>         slot_type;
+        typedef ::slib::delegate<void(const unsigned char*, unsigned int)> delegate_type;
+        typedef ::slib::util::trace_recorder                               recorder_type;
+
+        /** \brief One record of the trace. */
+        struct event final
+        {
+            unsigned long long time; ///< Time since the beginning of the trace in nanoseconds
+            size_t        arguments; ///< Offset of emission arguments in arguments buffer
+            unsigned int         id; ///< Signal id
+            unsigned int     target; ///< Target signal id for connect/disconnect events (0 for ordinary slots)
+            int            priority; ///< Priority of connection for connect events
+            unsigned char      type; ///< One of recorder_type::record_type values
+        };
+
+        /** \brief Recorded signal. */
+        struct signal_info final
+        {
+            ::std::string           name; ///< Name of the signal (may be empty)
+            unsigned int       arguments; ///< Size of emission arguments in bytes
+            unsigned long long     emits; ///< Number of recorded emissions
+        };
+
+    private:
+
+        /** \brief Rebuilt signal with it's synthetic slots. */
+        struct replay_signal final
+        {
+            signal_type                                      sgnl; ///< Signal which replaces recorded one
+            ::std::vector<::std::unique_ptr<slot_type> >    slots; ///< Connected synthetic slots
+            ::std::vector<::std::unique_ptr<slot_type> >     pool; ///< Disconnected synthetic slots
+        };
+
+        ::std::vector<event>                                  m_events; ///< All records of the trace
+        ::std::vector<signal_info>                           m_signals; ///< Recorded signals (indexed by signal id - 1)
+        ::std::vector<unsigned char>                       m_arguments; ///< Arguments of all emissions
+        ::std::vector<::std::unique_ptr<replay_signal> >       m_graph; ///< Rebuilt signals (indexed by signal id - 1)
+        delegate_type                                         m_target; ///< Delegate of synthetic slots
+        ::std::string                                          m_error; ///< Description of the last load error
+
+        trace_player(const trace_player&) = delete;
+        trace_player& operator = (const trace_player&) = delete;
+
+    public:
+
+        /** \brief Creates empty player.
+
+        \param _target Delegate which is invoked instead of every ordinary slot of recorded signals. */
+        explicit trace_player(const delegate_type& _target) : m_target(_target)
+        {
+        }
+
+        /** \brief Loads trace file.
+
+        \retval false if file can not be read or it is not a valid trace (see error()). */
+        bool load(const char* _filename)
+        {
+            FILE* file = fopen(_filename, "rb");
+            if (file == nullptr)
+            {
+                m_error = ::std::string("can not open file \"") + _filename + "\"";
+                return false;
+            }
+
+            ::std::vector<unsigned char> data;
+            unsigned char chunk[1 << 12];
+            size_t count;
+            while ((count = fread(chunk, 1, sizeof(chunk), file)) != 0)
+            {
+                data.insert(data.end(), chunk, chunk + count);
+            }
+            fclose(file);
+
+            return parse(data.data(), data.size());
+        }
+
+        /** \brief Loads trace from memory.
+
+        \retval false if data is not a valid trace (see error()). */
+        bool parse(const unsigned char* _data, size_t _size)
+        {
+            m_graph.clear();
+            m_events.clear();
+            m_signals.clear();
+            m_arguments.clear();
+            m_error.clear();
+
+            if (_size < 8 || memcmp(_data, "SLIBTRC2", 8) != 0)
+            {
+                m_error = "not a slib trace (or unsupported version of trace format)";
+                return false;
+            }
+
+            const unsigned char* position = _data + 8;
+            const unsigned char* end = _data + _size;
+            unsigned long long time = 0;
+
+            while (position < end)
+            {
+                event e;
+                e.type = *position++;
+                e.arguments = 0;
+                e.target = 0;
+                e.priority = 0;
+
+                unsigned long long delta = 0, id = 0;
+                if (!read_varint(position, end, delta) || !read_varint(position, end, id) || id == 0)
+                {
+                    return truncated();
+                }
+
+                time += delta;
+                e.time = time;
+                e.id = static_cast<unsigned int>(id);
+
+                if (e.type != recorder_type::record_signal && id > m_signals.size())
+                {
+                    m_error = "record of unknown signal " + ::std::to_string(id);
+                    return false;
+                }
+
+                switch (e.type)
+                {
+                    case recorder_type::record_signal:
+                    {
+                        unsigned long long arguments = 0, name_length = 0;
+                        if (!read_varint(position, end, arguments) || !read_varint(position, end, name_length) || name_length > static_cast<size_t>(end - position))
+                        {
+                            return truncated();
+                        }
+
+                        if (m_signals.size() < id)
+                        {
+                            m_signals.resize(static_cast<size_t>(id));
+                        }
+
+                        signal_info& info = m_signals[id - 1];
+                        info.name.assign(reinterpret_cast<const char*>(position), static_cast<size_t>(name_length));
+                        info.arguments = static_cast<unsigned int>(arguments);
+                        info.emits = 0;
+                        position += name_length;
+                        break;
+                    }
+
+                    case recorder_type::record_connect:
+                    case recorder_type::record_disconnect:
+                    {
+                        unsigned long long target = 0, priority = 0;
+                        if (!read_varint(position, end, target) || (e.type == recorder_type::record_connect && !read_varint(position, end, priority)))
+                        {
+                            return truncated();
+                        }
+
+                        e.target = target > m_signals.size() ? 0 : static_cast<unsigned int>(target);
+                        e.priority = static_cast<int>(static_cast<unsigned int>(priority >> 1) ^ (0U - static_cast<unsigned int>(priority & 1)));
+                        break;
+                    }
+
+                    case recorder_type::record_emit:
+                    {
+                        signal_info& info = m_signals[id - 1];
+                        if (info.arguments > static_cast<size_t>(end - position))
+                        {
+                            return truncated();
+                        }
+
+                        e.arguments = m_arguments.size();
+                        m_arguments.insert(m_arguments.end(), position, position + info.arguments);
+                        position += info.arguments;
+                        ++info.emits;
+                        break;
+                    }
+
+                    default:
+                    {
+                        m_error = "unknown record type " + ::std::to_string(static_cast<unsigned int>(e.type));
+                        return false;
+                    }
+                }
+
+                m_events.push_back(e);
+            }
+
+            return true;
+        }
+
+        /** \brief Returns description of the last load error. */
+        inline const ::std::string& error() const
+        {
+            return m_error;
+        }
+
+        /** \brief Returns all records of loaded trace. */
+        inline const ::std::vector<event>& events() const
+        {
+            return m_events;
+        }
+
+        /** \brief Returns recorded signals (indexed by signal id - 1). */
+        inline const ::std::vector<signal_info>& signals() const
+        {
+            return m_signals;
+        }
+
+        /** \brief Returns rebuilt signal by it's id (nullptr if it has not been registered by replay yet). */
+        inline signal_type* find(unsigned int _id) const
+        {
+            return _id == 0 || _id > m_graph.size() || !m_graph[_id - 1] ? nullptr : &m_graph[_id - 1]->sgnl;
+        }
+
+        /** \brief Destroys rebuilt signal graph (next replay starts from scratch). */
+        inline void reset()
+        {
+            m_graph.clear();
+        }
+
+        /** \brief Replays one record (use it to reproduce original pacing of the trace). */
+        void play(const event& _event)
+        {
+            if (_event.type != recorder_type::record_signal && find(_event.id) == nullptr)
+            {
+                return; // signal has not been registered
+            }
+
+            switch (_event.type)
+            {
+                case recorder_type::record_signal:
+                {
+                    if (m_graph.size() < _event.id)
+                    {
+                        m_graph.resize(_event.id);
+                    }
+
+                    m_graph[_event.id - 1].reset(new replay_signal());
+                    break;
+                }
+
+                case recorder_type::record_connect:
+                {
+                    replay_signal& s = *m_graph[_event.id - 1];
+                    signal_type* target = find(_event.target);
+                    if (target == nullptr)
+                    {
+                        if (s.pool.empty())
+                        {
+                            s.pool.emplace_back(new slot_type(m_target));
+                        }
+
+                        s.slots.push_back(::std::move(s.pool.back()));
+                        s.pool.pop_back();
+                        s.sgnl.connect(*s.slots.back(), _event.priority);
+                    }
+                    else
+                    {
+                        s.sgnl.connect(target->to_slot(), _event.priority);
+                    }
+                    break;
+                }
+
+                case recorder_type::record_disconnect:
+                {
+                    replay_signal& s = *m_graph[_event.id - 1];
+                    signal_type* target = find(_event.target);
+                    if (target == nullptr)
+                    {
+                        if (!s.slots.empty())
+                        {
+                            s.slots.back()->disconnect();
+                            s.pool.push_back(::std::move(s.slots.back()));
+                            s.slots.pop_back();
+                        }
+                    }
+                    else
+                    {
+                        s.sgnl.disconnect(target->to_slot());
+                    }
+                    break;
+                }
+
+                case recorder_type::record_emit:
+                {
+                    m_graph[_event.id - 1]->sgnl(m_arguments.data() + _event.arguments, m_signals[_event.id - 1].arguments);
+                    break;
+                }
+            }
+        }
+
+        /** \brief Rebuilds signal graph from scratch and replays the whole trace at full speed.
+
+        \retval Number of replayed emissions. */
+        unsigned long long replay()
+        {
+            reset();
+
+            unsigned long long emits = 0;
+            for (const event& e : m_events)
+            {
+                play(e);
+                if (e.type == recorder_type::record_emit)
+                {
+                    ++emits;
+                }
+            }
+
+            return emits;
+        }
+
+    private:
+
+        inline bool truncated()
+        {
+            m_error = "trace is truncated";
+            return false;
+        }
+
+        static bool read_varint(const unsigned char*& _position, const unsigned char* _end, unsigned long long& _value)
+        {
+            _value = 0;
+            for (unsigned int shift = 0; _position < _end && shift < 64; shift += 7)
+            {
+                const unsigned char byte = *_position++;
+                _value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    }; // END class trace_player.
+
+    //////////////////////////////////////////////////////////////////////////
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__TRACE_PLAYER__HPP_
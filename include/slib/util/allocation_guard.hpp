@@ -0,0 +1,248 @@
+/***************************************************************************************
+* file        : allocation_guard.hpp
+*             :
+* description : This header contains declaration and definition of no_allocation_region class
+*             : and guarded_allocator class which are used to verify that marked regions
+*             : of code (for example, emission of a signal after slot::reserve() warm-up)
+*             : do not allocate memory.
+*             :
+*             : Every memory allocation made by signal or slot (subscribers, priority buckets,
+*             : connections index, flattening cache, profiling data, lock statistics, delivery
+*             : queues and thread-local scratch lists) goes through guarded_allocator or
+*             : guarded_new. If it happens inside no_allocation_region then it is counted and,
+*             : depending on region's policy, assertion fails.
+*             :
+*             : Thread pools, dispatchers, timer wheels and adaptors built on top of signals
+*             : (keyed_signal, topic_router and others) are not guarded.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__ALLOCATION_GUARD__HPP_
+#define SIGNALS_LIBRARY__ALLOCATION_GUARD__HPP_
+
+#include "shared_allocator/shared_allocator.hpp"
+#include <utility>
+#include <assert.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    namespace util {
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Defines what happens when memory is allocated inside no_allocation_region.
+
+        \ingroup util */
+        enum class allocation_policy : unsigned char
+        {
+            count = 0, ///< Allocation is only counted (see no_allocation_region::allocations())
+            assertion  ///< Allocation is counted and assertion fails (works only if NDEBUG is not defined)
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief State of allocation regions of current thread. */
+        struct allocation_region_state final
+        {
+            unsigned long long allocations; ///< Number of allocations made inside regions
+            unsigned int             depth; ///< Number of nested regions
+            allocation_policy       policy; ///< Policy of the innermost region
+        };
+
+        /** \brief Returns state of allocation regions for current thread. */
+        inline allocation_region_state& allocation_region()
+        {
+            static thread_local allocation_region_state s_state = {0ULL, 0U, allocation_policy::count};
+            return s_state;
+        }
+
+        /** \brief Notifies that memory is going to be allocated.
+
+        Used by guarded_allocator. Can be used by any other allocator which must be verified. */
+        inline void on_allocation()
+        {
+            allocation_region_state& state = allocation_region();
+            if (state.depth != 0)
+            {
+                ++state.allocations;
+                assert(state.policy != allocation_policy::assertion && "memory allocation inside no_allocation_region");
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Marks scope of code which must not allocate memory.
+
+        Region is bound to current thread. Regions can be nested.
+
+        Usage example:
+        \code
+        slt.reserve(16); // warm-up
+        {
+            slib::util::no_allocation_region region;
+            sgnl.connect(slt);
+            sgnl(10);
+            sgnl.disconnect(slt);
+            assert(region.allocations() == 0);
+        }
+        \endcode
+
+        \ingroup util */
+        class no_allocation_region final
+        {
+            unsigned long long       m_initial; ///< Number of allocations made before this region
+            allocation_policy m_previous_policy; ///< Policy of outer region
+
+            no_allocation_region(const no_allocation_region&) = delete;
+            no_allocation_region& operator = (const no_allocation_region&) = delete;
+
+        public:
+
+            explicit no_allocation_region(allocation_policy _policy = allocation_policy::count)
+            {
+                allocation_region_state& state = allocation_region();
+                m_initial = state.allocations;
+                m_previous_policy = state.policy;
+                state.policy = _policy;
+                ++state.depth;
+            }
+
+            ~no_allocation_region()
+            {
+                allocation_region_state& state = allocation_region();
+                state.policy = m_previous_policy;
+                --state.depth;
+            }
+
+            /** \brief Returns number of allocations made inside this region (including nested regions). */
+            inline unsigned long long allocations() const
+            {
+                return allocation_region().allocations - m_initial;
+            }
+
+        }; // END class no_allocation_region.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief shared_allocator which reports every real memory allocation to current no_allocation_region.
+
+        \ingroup util */
+        template <class T>
+        struct guarded_allocator : public ::salloc::shared_allocator<T>
+        {
+            typedef ::salloc::shared_allocator<T>  parent_type;
+            typedef guarded_allocator<T>                 other;
+
+            typedef typename parent_type::pointer      pointer;
+            typedef typename parent_type::size_type  size_type;
+
+            /** \brief Auxiliary struct to convert this type to guarded_allocator of other type. */
+            template <class U>
+            struct rebind
+            {
+                typedef guarded_allocator<U> other;
+            };
+
+            guarded_allocator() throw()
+            {
+            }
+
+            guarded_allocator(const other&) throw()
+            {
+            }
+
+            template <class U>
+            guarded_allocator(const guarded_allocator<U>&) throw()
+            {
+            }
+
+            /** \brief Returns this guarded_allocator.
+
+            \note Used since C++11 */
+            other select_on_container_copy_construction() const
+            {
+                return *this;
+            }
+
+            /** \brief Allocate array of elements.
+
+            \param _number Required number of elements in array. */
+            pointer allocate(size_type _number) const
+            {
+                on_allocation();
+                return parent_type::allocate(_number);
+            }
+
+            /** \brief Allocate array of elements using hint.
+
+            \note Allocation is reported only if hint memory is not big enough.
+
+            \param _number Required number of elements in array.
+            \param _currentMemory Pointer to memory allocated earlier (it contains size which will be used as a hint). */
+            pointer allocate(size_type _number, void* _currentMemory) const
+            {
+                if (_currentMemory == nullptr || shared_size(_currentMemory) < _number * sizeof(T))
+                {
+                    on_allocation();
+                }
+
+                return parent_type::allocate(_number, _currentMemory);
+            }
+
+            template <class U>
+            inline bool operator == (const guarded_allocator<U>&) const throw()
+            {
+                return true;
+            }
+
+            template <class U>
+            inline bool operator != (const guarded_allocator<U>&) const throw()
+            {
+                return false;
+            }
+
+        }; // END struct guarded_allocator<T>.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Creates new object on heap and reports allocation to current no_allocation_region.
+
+        Used by signal and slot instead of plain new-expression. Object is deleted by ordinary delete.
+
+        \ingroup util */
+        template <class T, class ... TArgs>
+        inline T* guarded_new(TArgs&&... _args)
+        {
+            on_allocation();
+            return new T(::std::forward<TArgs>(_args)...);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__ALLOCATION_GUARD__HPP_
@@ -0,0 +1,413 @@
+/***************************************************************************************
+* file        : delivery_queue.hpp
+*             :
+* description : This header contains declaration and definition of delivery_queue class
+*             : which is a bounded ring buffer of queued invocations of one thread-affine slot.
+*             :
+*             : Ring memory is allocated once (when slot gets it's queue), so queuing of an
+*             : invocation never allocates: arguments are copied into preallocated element.
+*             : Queue itself is the task which is submitted into slot's dispatcher, and it is
+*             : submitted only when the ring becomes non-empty.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__EXECUTORS__HPP_
+
+#error delivery_queue.hpp must be included only from executors.hpp!
+
+#elif !defined(SIGNALS_LIBRARY__DELIVERY_QUEUE__HPP_)
+
+#define SIGNALS_LIBRARY__DELIVERY_QUEUE__HPP_
+
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    namespace util {
+
+        /** \brief Counters of bounded queue of thread-affine slot.
+
+        \ingroup util */
+        struct queue_statistics final
+        {
+            size_t               capacity; ///< Maximum number of queued invocations (0 if queue is unbounded)
+            size_t                   size; ///< Number of currently queued invocations
+            unsigned long long  delivered; ///< Number of invocations executed by owner thread
+            unsigned long long    dropped; ///< Number of invocations dropped by drop_newest or drop_oldest policy
+            unsigned long long  coalesced; ///< Number of invocations merged into queued one by coalesce policy (or by block policy when it's reserve is exhausted)
+            unsigned long long      waits; ///< Number of invocations queued over capacity (emitting thread waits for them, block policy)
+
+            queue_statistics() : capacity(0), size(0), delivered(0), dropped(0), coalesced(0), waits(0)
+            {
+            }
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+
+        template <typename function_signature> class delivery_queue;
+
+        /** \brief Bounded ring buffer of queued invocations of one thread-affine slot.
+
+        With block policy invocations over capacity are kept in second preallocated ring of
+        capacity + reserved_emitters elements, so emission never allocates memory.
+
+        \ingroup util */
+        template <typename return_type, typename ... Args>
+        class delivery_queue < return_type(Args...) > final : public pool_task
+        {
+            typedef ::slib::delegate< return_type(Args...) >                                 delegate_type;
+            typedef ::slib::args_list< return_type(typename ::std::decay<Args>::type...) >       item_type;
+            typedef ::std::tuple<typename ::std::decay<Args>::type...>                          tuple_type;
+            typedef typename ::std::aligned_storage<sizeof(item_type), alignof(item_type)>::type storage_type;
+
+            mutable ::std::mutex                  m_mutex; ///< Protects ring and counters
+            ::std::condition_variable             m_space; ///< Emitters wait on it until invocations over capacity are taken into ring (block policy)
+            ::std::unique_ptr<storage_type[]>   m_storage; ///< Preallocated ring elements followed by preallocated overflow elements
+            const delegate_type&                 m_target; ///< Invoked slot
+            dispatcher&                      m_dispatcher; ///< Dispatcher of owner thread
+            const size_t                       m_capacity; ///< Number of ring elements
+            const size_t                        m_reserve; ///< Number of overflow elements (0 if policy is not block)
+            size_t                                 m_head; ///< Index of the oldest queued invocation
+            size_t                                 m_size; ///< Number of queued invocations in ring
+            size_t                        m_overflow_head; ///< Index of the oldest invocation over capacity
+            size_t                        m_overflow_size; ///< Number of invocations queued over capacity by emitting threads (block policy)
+            size_t                              m_waiters; ///< Number of deferred waits for this queue
+            queue_statistics                      m_stats; ///< Counters
+            const overflow_policy                m_policy; ///< What happens when ring is full
+            bool                              m_scheduled; ///< True if queue is submitted into dispatcher
+            bool                                 m_closed; ///< True if queue is being destroyed (deferred waits are finished at once)
+
+            delivery_queue(const delivery_queue&) = delete;
+            delivery_queue& operator = (const delivery_queue&) = delete;
+
+        public:
+
+            enum : size_t { reserved_emitters = 8 }; ///< Number of overflow elements reserved in addition to capacity (block policy)
+
+            delivery_queue(const delegate_type& _target, dispatcher& _dispatcher, size_t _capacity, overflow_policy _policy)
+                : pool_task(&delivery_queue::run)
+                , m_target(_target)
+                , m_dispatcher(_dispatcher)
+                , m_capacity(_capacity == 0 ? 1 : _capacity)
+                , m_reserve(_policy == overflow_policy::block ? m_capacity + reserved_emitters : 0)
+                , m_head(0)
+                , m_size(0)
+                , m_overflow_head(0)
+                , m_overflow_size(0)
+                , m_waiters(0)
+                , m_policy(_policy)
+                , m_scheduled(false)
+                , m_closed(false)
+            {
+                on_allocation(); // rings of invocations are reported to no_allocation_region
+                m_storage.reset(new storage_type[m_capacity + m_reserve]);
+                m_stats.capacity = m_capacity;
+            }
+
+            /** \brief Destroys invocations which have not been delivered.
+
+            Emitting threads which still wait for this queue are released first.
+
+            \warning Queue must not be submitted into dispatcher (all invocations must be processed). */
+            ~delivery_queue()
+            {
+                // Deferred wait of current thread is released here, or it would never finish
+                deferred_waits_state& own = deferred_waits();
+                for (unsigned int i = 0; i < own.size; ++i)
+                {
+                    if (own.waits[i].queue == this)
+                    {
+                        finish_wait(this, false);
+                        own.waits[i] = own.waits[--own.size];
+                        break;
+                    }
+                }
+
+                {
+                    ::std::unique_lock<::std::mutex> lock(m_mutex);
+                    m_closed = true;
+                    m_space.notify_all();
+                    m_space.wait(lock, [this]() { return m_waiters == 0; });
+                }
+
+                for (; m_size != 0; --m_size)
+                {
+                    item(m_head)->~item_type();
+                    m_head = next(m_head);
+                }
+
+                for (; m_overflow_size != 0; --m_overflow_size)
+                {
+                    overflow_item(0)->~item_type();
+                    m_overflow_head = next_overflow(m_overflow_head);
+                }
+            }
+
+            /** \brief Returns dispatcher of owner thread. */
+            inline dispatcher& owner() const
+            {
+                return m_dispatcher;
+            }
+
+            /** \brief Queues invocation with copies of specified arguments according to overflow policy.
+
+            Emitting thread never waits here while it emits thread-safe signals: it may hold their mutexes, which
+            owner thread may need to make free space (by emitting the same signal or by connecting to it). When ring
+            is full and policy is block, invocation is queued over capacity and emitting thread waits until it is
+            taken into ring after all thread-safe signals emitted by it are unlocked (see emission_scope).
+
+            Invocations over capacity never allocate memory: if preallocated overflow is full, then emitting thread
+            outside of emission waits for free element, and nested emission (or owner thread) coalesces invocation
+            into the newest queued one. The same happens when thread already waits for too many queues
+            (see deferred_waits_state::capacity). Such invocations are counted as coalesced.
+
+            \note This method is thread-safe. */
+            template <class ... TArgs>
+            void push(TArgs&&... _args)
+            {
+                ::std::unique_lock<::std::mutex> lock(m_mutex);
+
+                deferred_waits_state* deferred = nullptr;
+                if (m_size == m_capacity)
+                {
+                    switch (m_policy)
+                    {
+                        case overflow_policy::drop_newest:
+                            ++m_stats.dropped;
+                            return;
+
+                        case overflow_policy::drop_oldest:
+                            item(m_head)->~item_type();
+                            m_head = next(m_head);
+                            --m_size;
+                            ++m_stats.dropped;
+                            break;
+
+                        case overflow_policy::coalesce:
+                            coalesce(::std::forward<TArgs>(_args)...);
+                            return;
+
+                        default:
+                        {
+                            deferred_waits_state& state = deferred_waits();
+                            if (m_overflow_size == m_reserve && state.depth == 0 && !m_dispatcher.is_current())
+                            {
+                                // No signal is locked by emission_scope, so it is safe to wait here
+                                m_space.wait(lock, [this]() { return m_overflow_size != m_reserve || m_closed; });
+                            }
+
+                            if (m_size != m_capacity)
+                            {
+                                break; // overflow has been delivered meanwhile
+                            }
+
+                            if (m_overflow_size == m_reserve || !defer(state))
+                            {
+                                coalesce(::std::forward<TArgs>(_args)...);
+                                return;
+                            }
+
+                            new (overflow_item(m_overflow_size)) item_type(tuple_type(::std::forward<TArgs>(_args)...));
+                            ++m_overflow_size;
+                            ++m_stats.waits;
+                            deferred = &state;
+                            break;
+                        }
+                    }
+                }
+
+                if (deferred == nullptr)
+                {
+                    new (item((m_head + m_size) % m_capacity)) item_type(tuple_type(::std::forward<TArgs>(_args)...));
+                    ++m_size;
+                }
+
+                const bool schedule = !m_scheduled;
+                m_scheduled = true;
+                lock.unlock();
+
+                if (schedule)
+                {
+                    m_dispatcher.submit(this);
+                }
+
+                if (deferred != nullptr && deferred->depth == 0)
+                {
+                    finish_deferred_waits(*deferred, true); // no signal is locked by emission_scope
+                }
+            }
+
+            /** \brief Returns counters.
+
+            \note This method is thread-safe. */
+            queue_statistics statistics() const
+            {
+                ::std::lock_guard<::std::mutex> lg(m_mutex);
+                queue_statistics result = m_stats;
+                result.size = m_size + m_overflow_size;
+                return result;
+            }
+
+        private:
+
+            inline item_type* item(size_t _index)
+            {
+                return reinterpret_cast<item_type*>(&m_storage[_index]);
+            }
+
+            /** \brief Returns _number-th invocation over capacity (counting from the oldest one). */
+            inline item_type* overflow_item(size_t _number)
+            {
+                return item(m_capacity + (m_overflow_head + _number) % m_reserve);
+            }
+
+            inline size_t next(size_t _index) const
+            {
+                return _index + 1 == m_capacity ? 0 : _index + 1;
+            }
+
+            inline size_t next_overflow(size_t _index) const
+            {
+                return _index + 1 == m_reserve ? 0 : _index + 1;
+            }
+
+            /** \brief Replaces arguments of the newest queued invocation. */
+            template <class ... TArgs>
+            void coalesce(TArgs&&... _args)
+            {
+                item_type* newest = m_overflow_size != 0 ? overflow_item(m_overflow_size - 1) : item((m_head + m_size - 1) % m_capacity);
+                newest->~item_type();
+                new (newest) item_type(tuple_type(::std::forward<TArgs>(_args)...));
+                ++m_stats.coalesced;
+            }
+
+            /** \brief Adds deferred wait for this queue into the list of current thread (if it is not there yet).
+
+            \retval false if the list is full. */
+            bool defer(deferred_waits_state& _state)
+            {
+                for (unsigned int i = 0; i < _state.size; ++i)
+                {
+                    if (_state.waits[i].queue == this)
+                    {
+                        return true;
+                    }
+                }
+
+                if (_state.size == deferred_waits_state::capacity)
+                {
+                    return false;
+                }
+
+                _state.waits[_state.size++] = deferred_wait {this, &delivery_queue::finish_wait};
+                ++m_waiters;
+                return true;
+            }
+
+            /** \brief Delivers invocations which were queued before this call (executed by dispatcher on owner thread).
+
+            Every invocation is moved out of the ring before slot is invoked, so emitters are never
+            blocked by slot execution. Freed element is taken by the oldest invocation over capacity.
+            If new invocations are queued meanwhile, queue submits itself again. */
+            static void run(pool_task* _task)
+            {
+                delivery_queue* that = static_cast<delivery_queue*>(_task);
+
+                ::std::unique_lock<::std::mutex> lock(that->m_mutex);
+                for (size_t number = that->m_size + that->m_overflow_size; number != 0 && that->m_size != 0; --number)
+                {
+                    item_type* front = that->item(that->m_head);
+                    item_type invocation(::std::move(front->args()));
+                    front->~item_type();
+                    that->m_head = that->next(that->m_head);
+                    --that->m_size;
+                    ++that->m_stats.delivered;
+
+                    bool notify = false;
+                    if (that->m_overflow_size != 0)
+                    {
+                        item_type* oldest = that->overflow_item(0);
+                        new (that->item((that->m_head + that->m_size) % that->m_capacity)) item_type(::std::move(oldest->args()));
+                        oldest->~item_type();
+                        that->m_overflow_head = that->next_overflow(that->m_overflow_head);
+                        notify = that->m_overflow_size-- == that->m_reserve || that->m_overflow_size == 0; // free element or everything is absorbed
+                        ++that->m_size;
+                    }
+
+                    lock.unlock();
+
+                    if (notify)
+                    {
+                        that->m_space.notify_all();
+                    }
+
+                    invocation(that->m_target);
+
+                    lock.lock();
+                }
+
+                if (that->m_size == 0)
+                {
+                    that->m_scheduled = false;
+                    return;
+                }
+
+                lock.unlock();
+                that->m_dispatcher.submit(that); // invocations queued during delivery are left for the next process()
+            }
+
+            /** \brief Waits until all invocations over capacity are taken into ring (if _wait is true) and releases deferred wait.
+
+            Owner thread never waits for it's own queue. */
+            static void finish_wait(pool_task* _task, bool _wait)
+            {
+                delivery_queue* that = static_cast<delivery_queue*>(_task);
+
+                ::std::unique_lock<::std::mutex> lock(that->m_mutex);
+                if (_wait && !that->m_dispatcher.is_current())
+                {
+                    that->m_space.wait(lock, [that]() { return that->m_overflow_size == 0 || that->m_closed; });
+                }
+
+                --that->m_waiters;
+                if (that->m_closed)
+                {
+                    that->m_space.notify_all(); // destructor waits for the last deferred wait
+                }
+            }
+
+        }; // END class delivery_queue.
+
+        //////////////////////////////////////////////////////////////////////////
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // ifdef SIGNALS_LIBRARY__EXECUTORS__HPP_ && !defined(SIGNALS_LIBRARY__DELIVERY_QUEUE__HPP_)
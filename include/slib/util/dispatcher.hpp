@@ -0,0 +1,216 @@
+/***************************************************************************************
+* file        : dispatcher.hpp
+*             :
+* description : This header contains declaration and definition of dispatcher class
+*             : which is a queue of calls executed by one owner thread (usually by it's event loop).
+*             :
+*             : Slots which are made thread-affine by slot::set_affinity are invoked directly
+*             : when signal is emitted on the owner thread of their dispatcher, otherwise their
+*             : invocation (copy of slot's delegate and copies of arguments) is queued into
+*             : dispatcher and executed by owner thread on the next process() call.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__EXECUTORS__HPP_
+
+#error dispatcher.hpp must be included only from executors.hpp!
+
+#elif !defined(SIGNALS_LIBRARY__DISPATCHER__HPP_)
+
+#define SIGNALS_LIBRARY__DISPATCHER__HPP_
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    namespace util {
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Queue of calls which are executed by one owner thread.
+
+        Usage example:
+        \code
+        slib::util::dispatcher gui; // owned by the constructing (GUI) thread
+        widget.on_progress.set_affinity(&gui);
+        worker.progress.connect(widget.on_progress); // emitted by worker thread
+        // ... GUI event loop:
+        gui.wait(std::chrono::milliseconds(10));
+        \endcode
+
+        Queued calls use intrusive pool_task nodes, so calls posted by post() are taken
+        from the same task cache as asynchronous emissions (no allocation after warm-up).
+
+        \ingroup util */
+        class dispatcher final
+        {
+            mutable ::std::mutex      m_mutex; ///< Protects queue
+            ::std::condition_variable m_ready; ///< Owner thread waits on it for new calls
+            pool_task*                m_first; ///< The oldest queued call
+            pool_task*                 m_last; ///< The newest queued call
+            ::std::thread::id         m_owner; ///< Owner thread
+
+            dispatcher(const dispatcher&) = delete;
+            dispatcher& operator = (const dispatcher&) = delete;
+
+        public:
+
+            /** \brief Constructs dispatcher owned by calling thread. */
+            dispatcher() : m_first(nullptr), m_last(nullptr), m_owner(::std::this_thread::get_id())
+            {
+            }
+
+            /** \brief Executes calls which are still queued.
+
+            \warning Dispatcher must be destroyed by it's owner thread. */
+            ~dispatcher()
+            {
+                process();
+            }
+
+            /** \brief Makes calling thread the owner of dispatcher.
+
+            \warning This method is NOT thread-safe. Use this on initialization (for example, when dispatcher
+            is created before it's event loop thread is started). */
+            inline void attach()
+            {
+                m_owner = ::std::this_thread::get_id();
+            }
+
+            /** \brief Returns id of the owner thread. */
+            inline ::std::thread::id owner() const
+            {
+                return m_owner;
+            }
+
+            /** \brief Returns true if calling thread is the owner thread. */
+            inline bool is_current() const
+            {
+                return m_owner == ::std::this_thread::get_id();
+            }
+
+            /** \brief Queues task for execution on the owner thread.
+
+            \note This method is thread-safe.
+
+            \note Task must stay alive until it's function is finished. */
+            void submit(pool_task* _task)
+            {
+                _task->next = nullptr;
+
+                {
+                    ::std::lock_guard<::std::mutex> lg(m_mutex);
+                    if (m_last != nullptr)
+                    {
+                        m_last->next = _task;
+                    }
+                    else
+                    {
+                        m_first = _task;
+                    }
+                    m_last = _task;
+                }
+
+                m_ready.notify_one();
+            }
+
+            /** \brief Queues invocation of delegate with copies of specified arguments on the owner thread.
+
+            \note This method is thread-safe.
+
+            \warning Object of the delegate must stay alive until invocation. */
+            template <typename return_type, typename ... Args, class ... TArgs>
+            inline void post(const ::slib::delegate<return_type(Args...)>& _delegate, TArgs&&... _args)
+            {
+                typedef async_task< return_type(Args...) > task_type;
+                submit(new (task_type::cache_type::instance().allocate()) task_type(_delegate, ::std::forward<TArgs>(_args)...));
+            }
+
+            /** \brief Executes all calls queued before this call in order of their queuing.
+
+            Calls queued by executed calls are left for the next process().
+
+            \warning Must be called only by the owner thread.
+
+            \retval Number of executed calls. */
+            size_t process()
+            {
+                pool_task* task;
+                {
+                    ::std::lock_guard<::std::mutex> lg(m_mutex);
+                    task = m_first;
+                    m_first = nullptr;
+                    m_last = nullptr;
+                }
+
+                size_t number = 0;
+                while (task != nullptr)
+                {
+                    pool_task* next = task->next; // task may be destroyed by it's function
+                    task->function(task);
+                    task = next;
+                    ++number;
+                }
+
+                return number;
+            }
+
+            /** \brief Waits until at least one call is queued (or until timeout) and executes queued calls.
+
+            \warning Must be called only by the owner thread.
+
+            \retval Number of executed calls. */
+            template <class rep_type, class period_type>
+            size_t wait(const ::std::chrono::duration<rep_type, period_type>& _timeout)
+            {
+                {
+                    ::std::unique_lock<::std::mutex> lock(m_mutex);
+                    m_ready.wait_for(lock, _timeout, [this] { return m_first != nullptr; });
+                }
+
+                return process();
+            }
+
+            /** \brief Returns true if there are no queued calls.
+
+            \note This method is thread-safe. */
+            inline bool empty() const
+            {
+                ::std::lock_guard<::std::mutex> lg(m_mutex);
+                return m_first == nullptr;
+            }
+
+        }; // END class dispatcher.
+
+        //////////////////////////////////////////////////////////////////////////
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // ifdef SIGNALS_LIBRARY__EXECUTORS__HPP_ && !defined(SIGNALS_LIBRARY__DISPATCHER__HPP_)
@@ -0,0 +1,128 @@
+/***************************************************************************************
+* file        : emission_scope.hpp
+*             :
+* description : This header contains declaration and definition of emission_scope class
+*             : and deferred waits of current thread.
+*             :
+*             : Emitting thread never waits for a full queue of thread-affine slot while it
+*             : holds locked signals: such waits are deferred until the outermost emission
+*             : of thread-safe signal is finished (see delivery_queue).
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__SIGNALS__HPP_
+
+#error emission_scope.hpp must be included only from signals.hpp!
+
+#elif !defined(SIGNALS_LIBRARY__EMISSION_SCOPE__HPP_)
+
+#define SIGNALS_LIBRARY__EMISSION_SCOPE__HPP_
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    namespace util {
+
+        struct pool_task;
+
+        /** \brief Bounded queue which emitting thread must wait for after it has unlocked emitted signals. */
+        struct deferred_wait final
+        {
+            pool_task*                         queue; ///< Queue with invocations over capacity
+            void (*finish)(pool_task*, bool _wait); ///< Waits for the queue (if _wait is true) and releases it
+        };
+
+        /** \brief Deferred waits of one thread.
+
+        Every queue is waited for once, so the list is bounded by the number of different queues
+        which became full during one emission. */
+        struct deferred_waits_state final
+        {
+            enum : unsigned int { capacity = 16 }; ///< Maximum number of queues one thread can wait for
+
+            deferred_wait waits[capacity]; ///< Queues to wait for
+            unsigned int            size; ///< Number of queues to wait for
+            unsigned int           depth; ///< Number of emissions of thread-safe signals in progress
+        };
+
+        /** \brief Returns deferred waits of current thread. */
+        inline deferred_waits_state& deferred_waits()
+        {
+            static thread_local deferred_waits_state s_state = {{}, 0U, 0U};
+            return s_state;
+        }
+
+        /** \brief Finishes all deferred waits of current thread.
+
+        \param _wait If false, then queues are released without waiting (used by parallel emission chunks). */
+        inline void finish_deferred_waits(deferred_waits_state& _state, bool _wait)
+        {
+            for (unsigned int i = 0; i < _state.size; ++i)
+            {
+                _state.waits[i].finish(_state.waits[i].queue, _wait);
+            }
+
+            _state.size = 0;
+        }
+
+        /** \brief Marks emission of a thread-safe signal: waits for full queues are deferred until the outermost scope ends.
+
+        Scope must be constructed before signal's mutex is locked, so deferred waits are finished after it is unlocked.
+
+        \ingroup util */
+        class emission_scope final
+        {
+            deferred_waits_state* m_state; ///< Deferred waits of current thread (nullptr if scope is inactive)
+            const bool             m_wait; ///< False if queues are released without waiting
+
+            emission_scope(const emission_scope&) = delete;
+            emission_scope& operator = (const emission_scope&) = delete;
+
+        public:
+
+            explicit emission_scope(bool _active, bool _wait = true) : m_state(_active ? &deferred_waits() : nullptr), m_wait(_wait)
+            {
+                if (m_state != nullptr)
+                {
+                    ++m_state->depth;
+                }
+            }
+
+            ~emission_scope()
+            {
+                if (m_state != nullptr && --m_state->depth == 0 && m_state->size != 0)
+                {
+                    finish_deferred_waits(*m_state, m_wait);
+                }
+            }
+
+        }; // END class emission_scope.
+
+        //////////////////////////////////////////////////////////////////////////
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // ifdef SIGNALS_LIBRARY__SIGNALS__HPP_ && !defined(SIGNALS_LIBRARY__EMISSION_SCOPE__HPP_)
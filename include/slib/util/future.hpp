@@ -0,0 +1,646 @@
+/***************************************************************************************
+* file        : future.hpp
+*             :
+* description : This header contains declaration and definition of future class and it's
+*             : shared state which is returned by slot::post, slot::invoke_async and signal::post.
+*             :
+*             : Shared state of the future is the queued task itself: {delegate, args_list} pair
+*             : plus storage of the result. Task nodes are reused through task_cache (the same way as
+*             : async_task nodes), so queued invocation with a future does not allocate after warm-up.
+*             : Future holds a reference to the node and the node is returned into the cache when both
+*             : the future and the executed task have released it.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__EXECUTORS__HPP_
+
+#error future.hpp must be included only from executors.hpp!
+
+#elif !defined(SIGNALS_LIBRARY__FUTURE__HPP_)
+
+#define SIGNALS_LIBRARY__FUTURE__HPP_
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
+#include <tuple>
+#include <type_traits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    template <class result_type> class future;
+
+    namespace util {
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Storage of result of queued invocation.
+
+        \ingroup util */
+        template <class result_type>
+        class future_result
+        {
+            static_assert(!::std::is_reference<result_type>::value, "future can not carry a reference");
+
+            typedef typename ::std::aligned_storage<sizeof(result_type), alignof(result_type)>::type storage_type;
+
+            storage_type m_storage; ///< Result (constructed by invoke)
+
+        public:
+
+            typedef ::slib::delegate<void(const result_type&)> continuation_type;
+
+            inline const result_type& value() const
+            {
+                return *reinterpret_cast<const result_type*>(&m_storage);
+            }
+
+            template <class some_delegate_type, class arguments_type>
+            inline void invoke(const some_delegate_type& _delegate, const arguments_type& _arguments)
+            {
+                new (&m_storage) result_type(_arguments(_delegate));
+            }
+
+            inline void destroy()
+            {
+                reinterpret_cast<result_type*>(&m_storage)->~result_type();
+            }
+
+            inline void call(const continuation_type& _continuation) const
+            {
+                _continuation(value());
+            }
+
+        }; // END class future_result<result_type>.
+
+        /** \brief Storage of result of queued invocation (nothing to store for void).
+
+        \ingroup util */
+        template <>
+        class future_result<void>
+        {
+        public:
+
+            typedef ::slib::delegate<void()> continuation_type;
+
+            template <class some_delegate_type, class arguments_type>
+            inline void invoke(const some_delegate_type& _delegate, const arguments_type& _arguments)
+            {
+                _arguments(_delegate);
+            }
+
+            inline void destroy()
+            {
+            }
+
+            inline void call(const continuation_type& _continuation) const
+            {
+                _continuation();
+            }
+
+        }; // END class future_result<void>.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Shared state of future: completion flag, result and continuation.
+
+        Concrete states (future_task) set release function which returns their memory into their cache.
+
+        \ingroup util */
+        template <class result_type>
+        class future_state
+        {
+            template <class> friend class ::slib::future;
+
+        public:
+
+            typedef future_result<result_type>                          result_holder;
+            typedef typename result_holder::continuation_type continuation_type;
+
+        protected:
+
+            ::std::mutex                        m_mutex; ///< Protects m_waiting and continuation
+            ::std::condition_variable           m_ready; ///< Waiting threads sleep on it
+            ::std::atomic<unsigned int>    m_references; ///< Number of owners (future and queued task)
+            ::std::atomic<bool>                  m_done; ///< True if result (or exception) has been stored
+            ::std::exception_ptr            m_exception; ///< Exception thrown by invoked delegate (result is not stored then)
+            continuation_type            m_continuation; ///< Delegate invoked on completion
+            result_holder                      m_result; ///< Result of invocation
+            void (*m_release)(future_state* _state); ///< Returns memory of the state into it's cache
+            bool                              m_waiting; ///< True if some thread waits on m_ready
+            bool                      m_has_continuation; ///< True if m_continuation is set
+
+            future_state(const future_state&) = delete;
+            future_state& operator = (const future_state&) = delete;
+
+            explicit future_state(void (*_release)(future_state*))
+                : m_references(2) // future and queued task
+                , m_done(false)
+                , m_release(_release)
+                , m_waiting(false)
+                , m_has_continuation(false)
+            {
+            }
+
+            ~future_state()
+            {
+                if (m_done.load(::std::memory_order_relaxed) && !m_exception)
+                {
+                    m_result.destroy();
+                }
+            }
+
+            /** \brief Invokes delegate, stores it's result, wakes waiting threads and invokes continuation.
+
+            If delegate throws, then exception is stored instead of result (it is rethrown by future::get)
+            and continuation is not invoked. State is completed anyway, so waiting threads are woken. */
+            template <class some_delegate_type, class arguments_type>
+            void complete(const some_delegate_type& _delegate, const arguments_type& _arguments)
+            {
+                try
+                {
+                    m_result.invoke(_delegate, _arguments);
+                }
+                catch (...)
+                {
+                    m_exception = ::std::current_exception();
+                }
+
+                continuation_type continuation;
+                bool has_continuation;
+                {
+                    ::std::lock_guard<::std::mutex> lg(m_mutex);
+                    m_done.store(true, ::std::memory_order_release);
+                    has_continuation = m_has_continuation && !m_exception;
+                    if (has_continuation)
+                    {
+                        continuation = m_continuation;
+                    }
+
+                    if (m_waiting)
+                    {
+                        m_ready.notify_all();
+                    }
+                }
+
+                if (has_continuation)
+                {
+                    m_result.call(continuation);
+                }
+            }
+
+            /** \brief Releases one reference (the last one returns state into it's cache). */
+            inline void release()
+            {
+                if (m_references.fetch_sub(1, ::std::memory_order_acq_rel) == 1)
+                {
+                    m_release(this);
+                }
+            }
+
+            inline void reference()
+            {
+                m_references.fetch_add(1, ::std::memory_order_relaxed);
+            }
+
+            inline bool ready() const
+            {
+                return m_done.load(::std::memory_order_acquire);
+            }
+
+            /** \brief Rethrows exception of invoked delegate (must be called after ready() has returned true). */
+            inline void rethrow() const
+            {
+                if (m_exception)
+                {
+                    ::std::rethrow_exception(m_exception);
+                }
+            }
+
+            void wait()
+            {
+                if (ready())
+                {
+                    return;
+                }
+
+                ::std::unique_lock<::std::mutex> lock(m_mutex);
+                m_waiting = true;
+                m_ready.wait(lock, [this]() { return m_done.load(::std::memory_order_relaxed); });
+            }
+
+            template <class rep_type, class period_type>
+            bool wait_for(const ::std::chrono::duration<rep_type, period_type>& _timeout)
+            {
+                if (ready())
+                {
+                    return true;
+                }
+
+                ::std::unique_lock<::std::mutex> lock(m_mutex);
+                m_waiting = true;
+                return m_ready.wait_for(lock, _timeout, [this]() { return m_done.load(::std::memory_order_relaxed); });
+            }
+
+            void then(const continuation_type& _continuation)
+            {
+                {
+                    ::std::lock_guard<::std::mutex> lg(m_mutex);
+                    if (!m_done.load(::std::memory_order_relaxed))
+                    {
+                        m_continuation = _continuation;
+                        m_has_continuation = true;
+                        return;
+                    }
+                }
+
+                if (!m_exception)
+                {
+                    m_result.call(_continuation); // already completed: continuation is invoked by calling thread
+                }
+            }
+
+        }; // END class future_state.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        template <typename function_signature> class future_task;
+
+        /** \brief Queued invocation of delegate which is the shared state of it's future.
+
+        Arguments are stored by value (decayed types), so delegate must not take non-const lvalue references.
+
+        \ingroup util */
+        template <typename return_type, typename ... Args>
+        class future_task < return_type(Args...) > final : public pool_task, public future_state<return_type>
+        {
+            typedef future_state<return_type>                                                   state_type;
+            typedef ::slib::delegate< return_type(Args...) >                                 delegate_type;
+            typedef ::slib::args_list< return_type(typename ::std::decay<Args>::type...) > arguments_type;
+            typedef ::std::tuple<typename ::std::decay<Args>::type...>                          tuple_type;
+
+            delegate_type    m_target; ///< Invoked delegate
+            arguments_type m_arguments; ///< Copies of arguments
+
+        public:
+
+            typedef task_cache<future_task> cache_type;
+
+            template <class ... TArgs>
+            future_task(const delegate_type& _target, TArgs&&... _args)
+                : pool_task(&future_task::run)
+                , state_type(&future_task::release_state)
+                , m_target(_target)
+                , m_arguments(tuple_type(::std::forward<TArgs>(_args)...))
+            {
+            }
+
+            static void run(pool_task* _task)
+            {
+                future_task* that = static_cast<future_task*>(_task);
+                that->complete(that->m_target, that->m_arguments);
+                that->release();
+            }
+
+        private:
+
+            static void release_state(state_type* _state)
+            {
+                // state is never nullptr: reference cast has no null check, which confuses -Wstringop-overflow after inlining
+                cache_type::instance().deallocate(&static_cast<future_task&>(*_state));
+            }
+
+        }; // END class future_task.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Queues invocation of delegate into executor (thread_pool or dispatcher) and returns it's future.
+
+        \param _executor Pointer to executor (nullptr means delegate is invoked immediately by calling thread).
+
+        \warning Object of the delegate must stay alive until invocation. */
+        template <class executor_type, typename return_type, typename ... Args, class ... TArgs>
+        inline ::slib::future<return_type> invoke_async(executor_type* _executor, const ::slib::delegate<return_type(Args...)>& _delegate, TArgs&&... _args);
+
+    } // END namespace util.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** \brief Result of queued invocation.
+
+    Usage example:
+    \code
+    slib::future<double> price = pricer.on_quote.post(pool, instrument);
+    // ... do something else
+    double value = price.get();
+    \endcode
+
+    Future is a pointer to pooled shared state, so it is cheap to copy and it does not allocate
+    after warm-up. Any number of threads may wait on copies of the same future.
+
+    \ingroup slib */
+    template <class result_type>
+    class future final
+    {
+    public:
+
+        typedef ::slib::util::future_state<result_type>            state_type;
+        typedef typename state_type::continuation_type continuation_type;
+
+    private:
+
+        state_type* m_state; ///< Shared state (nullptr for invalid future)
+
+    public:
+
+        /** \brief Constructs invalid future. */
+        future() : m_state(nullptr)
+        {
+        }
+
+        /** \brief Adopts one reference of shared state. */
+        explicit future(state_type* _state) : m_state(_state)
+        {
+        }
+
+        future(const future& _other) : m_state(_other.m_state)
+        {
+            if (m_state != nullptr)
+            {
+                m_state->reference();
+            }
+        }
+
+        future(future&& _other) : m_state(_other.m_state)
+        {
+            _other.m_state = nullptr;
+        }
+
+        future& operator = (const future& _other)
+        {
+            future copy(_other);
+            ::std::swap(m_state, copy.m_state);
+            return *this;
+        }
+
+        future& operator = (future&& _other)
+        {
+            ::std::swap(m_state, _other.m_state);
+            return *this;
+        }
+
+        ~future()
+        {
+            if (m_state != nullptr)
+            {
+                m_state->release();
+            }
+        }
+
+        /** \brief Returns true if future refers to a queued invocation. */
+        inline bool valid() const
+        {
+            return m_state != nullptr;
+        }
+
+        /** \brief Returns true if invocation has finished (result is available).
+
+        \note This method is thread-safe. */
+        inline bool ready() const
+        {
+            return m_state->ready();
+        }
+
+        /** \brief Waits until invocation is finished.
+
+        \warning Waiting on the thread which must execute the invocation (for example, on dispatcher's
+        owner thread) is a deadlock. */
+        inline void wait() const
+        {
+            m_state->wait();
+        }
+
+        /** \brief Waits until invocation is finished or until timeout.
+
+        \retval true if invocation has finished. */
+        template <class rep_type, class period_type>
+        inline bool wait_for(const ::std::chrono::duration<rep_type, period_type>& _timeout) const
+        {
+            return m_state->wait_for(_timeout);
+        }
+
+        /** \brief Waits until invocation is finished and returns it's result.
+
+        \throw Rethrows exception thrown by invoked delegate. */
+        inline const result_type& get() const
+        {
+            m_state->wait();
+            m_state->rethrow();
+            return m_state->m_result.value();
+        }
+
+        /** \brief Copies result into _result if invocation has finished. Never blocks.
+
+        \throw Rethrows exception thrown by invoked delegate.
+
+        \retval true if result has been copied. */
+        inline bool try_get(result_type& _result) const
+        {
+            if (!m_state->ready())
+            {
+                return false;
+            }
+
+            m_state->rethrow();
+            _result = m_state->m_result.value();
+            return true;
+        }
+
+        /** \brief Sets delegate which is invoked with the result when invocation finishes.
+
+        Continuation is invoked by the thread which finishes invocation, or immediately by calling thread
+        if invocation has already finished. Shared state has one continuation (next then() replaces it).
+        Continuation is not invoked if delegate has thrown an exception.
+
+        \warning Object of the delegate must stay alive until invocation. */
+        inline void then(const continuation_type& _continuation) const
+        {
+            m_state->then(_continuation);
+        }
+
+    }; // END class future<result_type>.
+
+    /** \brief Completion of queued invocation which returns nothing (see future<result_type>).
+
+    \ingroup slib */
+    template <>
+    class future<void> final
+    {
+    public:
+
+        typedef ::slib::util::future_state<void>                   state_type;
+        typedef state_type::continuation_type             continuation_type;
+
+    private:
+
+        state_type* m_state; ///< Shared state (nullptr for invalid future)
+
+    public:
+
+        /** \brief Constructs invalid future. */
+        future() : m_state(nullptr)
+        {
+        }
+
+        /** \brief Adopts one reference of shared state. */
+        explicit future(state_type* _state) : m_state(_state)
+        {
+        }
+
+        future(const future& _other) : m_state(_other.m_state)
+        {
+            if (m_state != nullptr)
+            {
+                m_state->reference();
+            }
+        }
+
+        future(future&& _other) : m_state(_other.m_state)
+        {
+            _other.m_state = nullptr;
+        }
+
+        future& operator = (const future& _other)
+        {
+            future copy(_other);
+            ::std::swap(m_state, copy.m_state);
+            return *this;
+        }
+
+        future& operator = (future&& _other)
+        {
+            ::std::swap(m_state, _other.m_state);
+            return *this;
+        }
+
+        ~future()
+        {
+            if (m_state != nullptr)
+            {
+                m_state->release();
+            }
+        }
+
+        /** \brief Returns true if future refers to a queued invocation. */
+        inline bool valid() const
+        {
+            return m_state != nullptr;
+        }
+
+        /** \brief Returns true if invocation has finished.
+
+        \note This method is thread-safe. */
+        inline bool ready() const
+        {
+            return m_state->ready();
+        }
+
+        /** \brief Waits until invocation is finished (see future<result_type>::wait). */
+        inline void wait() const
+        {
+            m_state->wait();
+        }
+
+        /** \brief Waits until invocation is finished or until timeout.
+
+        \retval true if invocation has finished. */
+        template <class rep_type, class period_type>
+        inline bool wait_for(const ::std::chrono::duration<rep_type, period_type>& _timeout) const
+        {
+            return m_state->wait_for(_timeout);
+        }
+
+        /** \brief Waits until invocation is finished.
+
+        \throw Rethrows exception thrown by invoked delegate. */
+        inline void get() const
+        {
+            m_state->wait();
+            m_state->rethrow();
+        }
+
+        /** \brief Returns true if invocation has finished. Never blocks.
+
+        \throw Rethrows exception thrown by invoked delegate. */
+        inline bool try_get() const
+        {
+            if (!m_state->ready())
+            {
+                return false;
+            }
+
+            m_state->rethrow();
+            return true;
+        }
+
+        /** \brief Sets delegate which is invoked when invocation finishes (see future<result_type>::then). */
+        inline void then(const continuation_type& _continuation) const
+        {
+            m_state->then(_continuation);
+        }
+
+    }; // END class future<void>.
+
+    //////////////////////////////////////////////////////////////////////////
+
+    namespace util {
+
+        template <class executor_type, typename return_type, typename ... Args, class ... TArgs>
+        inline ::slib::future<return_type> invoke_async(executor_type* _executor, const ::slib::delegate<return_type(Args...)>& _delegate, TArgs&&... _args)
+        {
+            typedef future_task< return_type(Args...) > task_type;
+
+            task_type* task = new (task_type::cache_type::instance().allocate()) task_type(_delegate, ::std::forward<TArgs>(_args)...);
+            ::slib::future<return_type> result(task); // future adopts one of two references
+
+            if (_executor != nullptr)
+            {
+                _executor->submit(task);
+            }
+            else
+            {
+                task_type::run(task);
+            }
+
+            return result;
+        }
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // ifdef SIGNALS_LIBRARY__EXECUTORS__HPP_ && !defined(SIGNALS_LIBRARY__FUTURE__HPP_)
@@ -0,0 +1,288 @@
+/***************************************************************************************
+* file        : latency_histogram.hpp
+*             :
+* description : This header contains declaration and definition of latency_histogram class
+*             : which is used by signal to collect per-connection timings of slot invocations.
+*             : Histogram uses log-linear buckets (HDR-style): values are grouped by their
+*             : highest bit and every group is divided into equal sub-buckets, so relative
+*             : error of every recorded value is constant (about 6%) for the whole range.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__LATENCY_HISTOGRAM__HPP_
+#define SIGNALS_LIBRARY__LATENCY_HISTOGRAM__HPP_
+
+#include <string.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    namespace util {
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Latency histogram with constant relative precision.
+
+        Values from 0 to 31 are stored exactly. Greater values are stored in one of 16 sub-buckets
+        of their power-of-two range. Values greater than max_value() are clamped to max_value().
+
+        \note It does not use dynamic memory allocation.
+
+        \note Time units are not specified by histogram itself. Signal records nanoseconds.
+
+        \ingroup util */
+        class latency_histogram final
+        {
+        public:
+
+            typedef unsigned long long value_type;
+            typedef unsigned int       count_type;
+
+            enum : unsigned int
+            {
+                sub_bucket_bits = 5,                                            ///< Number of significant bits stored for every value
+                sub_bucket_count = 1 << sub_bucket_bits,                        ///< Number of exactly stored values
+                sub_bucket_half = sub_bucket_count >> 1,                        ///< Number of sub-buckets in every power-of-two range
+                max_value_bits = 40,                                            ///< Values up to 2^40 (about 18 minutes in nanoseconds)
+                bucket_count = sub_bucket_count + (max_value_bits - sub_bucket_bits) * sub_bucket_half
+            };
+
+        private:
+
+            count_type m_buckets[bucket_count]; ///< Number of recorded values for every bucket
+            value_type                 m_total; ///< Total number of recorded values
+            value_type                   m_sum; ///< Sum of all recorded values (used to calculate mean)
+            value_type                   m_min; ///< Minimum recorded value
+            value_type                   m_max; ///< Maximum recorded value
+
+        public:
+
+            latency_histogram()
+            {
+                reset();
+            }
+
+            /** \brief Returns the greatest value which can be stored without clamping. */
+            static inline value_type max_value()
+            {
+                return (1ULL << max_value_bits) - 1;
+            }
+
+            /** \brief Removes all recorded values. */
+            inline void reset()
+            {
+                memset(m_buckets, 0, sizeof(m_buckets));
+                m_total = 0;
+                m_sum = 0;
+                m_min = 0;
+                m_max = 0;
+            }
+
+            /** \brief Records one value.
+
+            \param _value Value to be recorded (nanoseconds for signal's statistics). */
+            inline void record(value_type _value)
+            {
+                if (_value > max_value())
+                {
+                    _value = max_value();
+                }
+
+                ++m_buckets[bucket_index(_value)];
+
+                if (m_total == 0 || _value < m_min)
+                {
+                    m_min = _value;
+                }
+
+                if (_value > m_max)
+                {
+                    m_max = _value;
+                }
+
+                m_sum += _value;
+                ++m_total;
+            }
+
+            /** \brief Adds all values recorded by another histogram.
+
+            \param _other Reference to another histogram. */
+            inline void merge(const latency_histogram& _other)
+            {
+                if (_other.m_total == 0)
+                {
+                    return;
+                }
+
+                for (unsigned int i = 0; i < bucket_count; ++i)
+                {
+                    m_buckets[i] += _other.m_buckets[i];
+                }
+
+                if (m_total == 0 || _other.m_min < m_min)
+                {
+                    m_min = _other.m_min;
+                }
+
+                if (_other.m_max > m_max)
+                {
+                    m_max = _other.m_max;
+                }
+
+                m_sum += _other.m_sum;
+                m_total += _other.m_total;
+            }
+
+            /** \brief Returns number of recorded values. */
+            inline value_type count() const
+            {
+                return m_total;
+            }
+
+            /** \brief Returns minimum recorded value (exact). */
+            inline value_type min() const
+            {
+                return m_min;
+            }
+
+            /** \brief Returns maximum recorded value (exact). */
+            inline value_type max() const
+            {
+                return m_max;
+            }
+
+            /** \brief Returns mean of all recorded values (exact). */
+            inline value_type mean() const
+            {
+                return m_total == 0 ? 0 : m_sum / m_total;
+            }
+
+            /** \brief Returns value at specified percentile.
+
+            \param _percentile Percentile in range [0, 100].
+
+            \retval Upper bound of the bucket containing requested percentile (but not greater than max()). */
+            value_type percentile(double _percentile) const
+            {
+                if (m_total == 0)
+                {
+                    return 0;
+                }
+
+                if (_percentile >= 100.0)
+                {
+                    return m_max;
+                }
+
+                value_type required = static_cast<value_type>(_percentile * 0.01 * static_cast<double>(m_total) + 0.5);
+                if (required == 0)
+                {
+                    required = 1;
+                }
+
+                value_type accumulated = 0;
+                for (unsigned int i = 0; i < bucket_count; ++i)
+                {
+                    accumulated += m_buckets[i];
+                    if (accumulated >= required)
+                    {
+                        const value_type upper = bucket_upper_bound(i);
+                        return upper < m_max ? upper : m_max;
+                    }
+                }
+
+                return m_max;
+            }
+
+        private:
+
+            /** \brief Returns index of the highest non-zero bit. */
+            static inline unsigned int highest_bit(value_type _value)
+            {
+#ifdef __GNUC__
+                return 63 - static_cast<unsigned int>(__builtin_clzll(_value));
+#else
+                unsigned int bit = 0;
+                while (_value >>= 1)
+                {
+                    ++bit;
+                }
+                return bit;
+#endif
+            }
+
+            /** \brief Returns index of the bucket for specified value. */
+            static inline unsigned int bucket_index(value_type _value)
+            {
+                if (_value < sub_bucket_count)
+                {
+                    return static_cast<unsigned int>(_value);
+                }
+
+                const unsigned int shift = highest_bit(_value) - sub_bucket_bits + 1;
+                const unsigned int sub_bucket = static_cast<unsigned int>(_value >> shift) - sub_bucket_half;
+                return sub_bucket_count + (shift - 1) * sub_bucket_half + sub_bucket;
+            }
+
+            /** \brief Returns the greatest value which is stored in specified bucket. */
+            static inline value_type bucket_upper_bound(unsigned int _index)
+            {
+                if (_index < sub_bucket_count)
+                {
+                    return _index;
+                }
+
+                const unsigned int shift = (_index - sub_bucket_count) / sub_bucket_half + 1;
+                const value_type sub_bucket = (_index - sub_bucket_count) % sub_bucket_half + sub_bucket_half;
+                return ((sub_bucket + 1) << shift) - 1;
+            }
+
+        }; // END class latency_histogram.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Latency statistics of one connection.
+
+        It is returned by signal::slowest().
+
+        \ingroup util */
+        template <class slot_type>
+        struct slot_latency final
+        {
+            const slot_type*            slot; ///< Pointer to connected slot (use it for identification only)
+            latency_histogram      histogram; ///< Copy of connection's histogram
+
+            slot_latency(const slot_type* _slot, const latency_histogram& _histogram) : slot(_slot), histogram(_histogram)
+            {
+            }
+
+        }; // END struct slot_latency.
+
+        //////////////////////////////////////////////////////////////////////////
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__LATENCY_HISTOGRAM__HPP_
@@ -7,6 +7,9 @@
 *             :
 * description : This header contains declaration and definition for dynamic_mutex, lock_guard and
 *             : atomic_boolean classes which are used by signal and slot for multithreading protection.
+*             : dynamic_mutex can also collect lock contention statistics (lock_statistics).
+*             : dynamic_mutex is recursive, so slots may connect and disconnect signals which
+*             : are being emitted by the same thread.
 *             :
 * license     : This file is part of SignalsLibrary.
 *             :
@@ -36,6 +39,7 @@
 
 #include <mutex>
 #include <atomic>
+#include <chrono>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -46,6 +50,40 @@ namespace slib {
 
         //////////////////////////////////////////////////////////////////////////
 
+        /** \brief Lock contention statistics of one or several mutexes.
+
+        \note All times are in nanoseconds.
+
+        \ingroup util */
+        struct lock_statistics final
+        {
+            unsigned long long acquisitions; ///< Total number of lock acquisitions
+            unsigned long long    contended; ///< Number of acquisitions which had to wait for another owner
+            unsigned long long    wait_time; ///< Total time spent waiting for contended acquisitions
+            unsigned long long    hold_time; ///< Total time the mutex was held
+            unsigned long long max_hold_time; ///< Maximum time the mutex was held by one owner
+
+            lock_statistics() : acquisitions(0), contended(0), wait_time(0), hold_time(0), max_hold_time(0)
+            {
+            }
+
+            /** \brief Adds statistics of another mutex (used to aggregate statistics per signal/slot). */
+            inline void merge(const lock_statistics& _other)
+            {
+                acquisitions += _other.acquisitions;
+                contended += _other.contended;
+                wait_time += _other.wait_time;
+                hold_time += _other.hold_time;
+                if (_other.max_hold_time > max_hold_time)
+                {
+                    max_hold_time = _other.max_hold_time;
+                }
+            }
+
+        }; // END struct lock_statistics.
+
+        //////////////////////////////////////////////////////////////////////////
+
         /** \brief Dynamic mutex.
 
         Used to dynamically change behavior of a mutex.
@@ -54,19 +92,44 @@ namespace slib {
         Then lock and unlock methods will work properly (locking and unlocking mutex).
         This is done to provide unified interface without virtual methods
         (vtable call is slower than if-else).
+
+        Mutex is recursive: emission of a signal holds it's mutex while slots are invoked,
+        and slot may disconnect itself (or any other slot) from the same signal.
         
         \ingroup util */
         class dynamic_mutex final
         {
-            ::std::mutex         m_mutex; ///< Mutex (used only if m_is_threadsafe == true)
-            bool         m_is_threadsafe; ///< Thread-safety flag (false by default). Changes behavior of lock and unlock methods.
+            typedef ::std::chrono::steady_clock clock_type;
+
+            /** \brief Contention statistics together with state of their measurement.
+
+            Kept out of the mutex, so mutex without statistics is not larger than std::recursive_mutex with a flag. */
+            struct instrumentation final
+            {
+                lock_statistics          statistics; ///< Collected values
+                clock_type::time_point    locked_at; ///< Time of the last acquisition
+                unsigned int              recursion; ///< Number of nested acquisitions by the owner
+
+                instrumentation() : recursion(0)
+                {
+                }
+            };
+
+            ::std::recursive_mutex         m_mutex; ///< Mutex (used only if m_is_threadsafe == true)
+            instrumentation*          m_statistics; ///< Contention statistics (nullptr if statistics are disabled)
+            bool                   m_is_threadsafe; ///< Thread-safety flag (false by default). Changes behavior of lock and unlock methods.
 
         public:
 
-            dynamic_mutex(bool _is_threadsafe = false) : m_is_threadsafe(_is_threadsafe)
+            dynamic_mutex(bool _is_threadsafe = false) : m_statistics(nullptr), m_is_threadsafe(_is_threadsafe)
             {
             }
 
+            ~dynamic_mutex()
+            {
+                delete m_statistics;
+            }
+
             /** \brief Returns thread-safety flag.
             
             \sa m_is_threadsafe */
@@ -85,7 +148,14 @@ namespace slib {
                 // if-else works equal (under Release build) or faster (under other builds) than virtual function call
                 if (m_is_threadsafe)
                 {
-                    m_mutex.lock();
+                    if (m_statistics == nullptr)
+                    {
+                        m_mutex.lock();
+                    }
+                    else
+                    {
+                        instrumented_lock();
+                    }
                 }
             }
 
@@ -99,10 +169,32 @@ namespace slib {
                 // if-else works equal (under Release build) or faster (under other builds) than virtual function call
                 if (m_is_threadsafe)
                 {
+                    if (m_statistics != nullptr)
+                    {
+                        instrumented_unlock();
+                    }
+
                     m_mutex.unlock();
                 }
             }
 
+            /** \brief Tries to lock mutex without waiting.
+
+            \note Always succeeds if m_is_threadsafe == false.
+
+            \return True if mutex has been locked (it must be unlocked with unlock).
+
+            \sa m_is_threadsafe, lock, unlock */
+            inline bool try_lock()
+            {
+                if (m_is_threadsafe)
+                {
+                    return m_statistics == nullptr ? m_mutex.try_lock() : instrumented_try_lock();
+                }
+
+                return true;
+            }
+
             /** \brief Changes behavior of lock and unlock methods.
 
             \warning This method is NOT thread-safe! Use this on initialization.
@@ -115,6 +207,114 @@ namespace slib {
                 m_is_threadsafe = _is_threadsafe;
             }
 
+            /** \brief Turns collecting of contention statistics on/off.
+
+            Statistics are collected only if m_is_threadsafe == true (otherwise there is nothing to wait for).
+            Turning statistics off removes all collected values.
+
+            \warning This method is NOT thread-safe! Use this on initialization.
+
+            \sa statistics */
+            inline void set_statistics_enabled(bool _enabled)
+            {
+                if (!_enabled)
+                {
+                    delete m_statistics;
+                    m_statistics = nullptr;
+                }
+                else if (m_statistics == nullptr)
+                {
+                    m_statistics = ::slib::util::guarded_new<instrumentation>();
+                }
+            }
+
+            /** \brief Returns true if contention statistics are being collected. */
+            inline bool statistics_enabled() const
+            {
+                return m_statistics != nullptr;
+            }
+
+            /** \brief Returns copy of collected contention statistics.
+
+            \note Returns empty statistics if statistics are disabled.
+
+            \warning Must not be called by the owner of this mutex. */
+            inline lock_statistics statistics() const
+            {
+                if (m_statistics == nullptr)
+                {
+                    return lock_statistics();
+                }
+
+                // Statistics are modified only by mutex owner
+                lock_guard_type lg(const_cast<::std::recursive_mutex&>(m_mutex));
+                return m_statistics->statistics;
+            }
+
+        private:
+
+            typedef ::std::lock_guard<::std::recursive_mutex> lock_guard_type;
+
+            /** \brief Locks mutex and measures time spent waiting for it. */
+            void instrumented_lock()
+            {
+                if (instrumented_try_lock())
+                {
+                    return;
+                }
+
+                instrumentation& state = *m_statistics;
+
+                const auto start = clock_type::now();
+                m_mutex.lock();
+                state.recursion = 1;
+                state.locked_at = clock_type::now();
+                state.statistics.wait_time += elapsed(start, state.locked_at);
+                ++state.statistics.contended;
+                ++state.statistics.acquisitions;
+            }
+
+            /** \brief Locks mutex if it is free and starts measurement of hold time. */
+            bool instrumented_try_lock()
+            {
+                if (!m_mutex.try_lock())
+                {
+                    return false;
+                }
+
+                instrumentation& state = *m_statistics;
+                if (state.recursion++ == 0) // nested acquisition by the owner is not an acquisition
+                {
+                    state.locked_at = clock_type::now();
+                    ++state.statistics.acquisitions;
+                }
+
+                return true;
+            }
+
+            /** \brief Measures time the mutex was held. Mutex must be unlocked after that. */
+            void instrumented_unlock()
+            {
+                instrumentation& state = *m_statistics;
+
+                if (--state.recursion != 0)
+                {
+                    return;
+                }
+
+                const auto hold_time = elapsed(state.locked_at, clock_type::now());
+                state.statistics.hold_time += hold_time;
+                if (hold_time > state.statistics.max_hold_time)
+                {
+                    state.statistics.max_hold_time = hold_time;
+                }
+            }
+
+            static inline unsigned long long elapsed(clock_type::time_point _from, clock_type::time_point _to)
+            {
+                return static_cast<unsigned long long>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(_to - _from).count());
+            }
+
         }; // END class dynamic_mutex.
 
         //////////////////////////////////////////////////////////////////////////
@@ -148,6 +348,15 @@ namespace slib {
 
             /** \brief Constructor.
 
+            Takes ownership of mutex which has been already locked by the caller.
+
+            \param _mutex_reference Reference to locked mutex. */
+            lock_guard(mutex_type& _mutex_reference, ::std::adopt_lock_t) : m_mutex(_mutex_reference), m_is_locked(true)
+            {
+            }
+
+            /** \brief Constructor.
+
             Automatically locks mutex.
 
             \param _mutex_reference Reference to mutex. */
@@ -181,6 +390,14 @@ namespace slib {
                 }
             }
 
+            /** \brief Forgets locked mutex without unlocking it.
+
+            Used when mutex has been unlocked and destroyed by it's owner (signal destroyed by it's own slot). */
+            inline void release()
+            {
+                m_is_locked = false;
+            }
+
             /** \brief Returns lock status. */
             inline bool locked() const
             {
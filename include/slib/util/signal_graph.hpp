@@ -0,0 +1,299 @@
+/***************************************************************************************
+* file        : signal_graph.hpp
+*             :
+* description : This header contains declaration and definition of signal_graph class which
+*             : keeps incremental topological order of signal-to-signal connections
+*             : (Pearce-Kelly algorithm). Signal uses it to detect cycles at connect time:
+*             : connection which keeps the order is accepted in O(1), otherwise only signals
+*             : between connected signals in the current order are visited.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__SIGNAL_GRAPH__HPP_
+#define SIGNALS_LIBRARY__SIGNAL_GRAPH__HPP_
+
+#include "slib/util/allocation_guard.hpp"
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    namespace util {
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Node of signal-to-signal connections graph.
+
+        Signal gets it's node on the first connection to (or of) another signal.
+
+        \ingroup util */
+        struct graph_node final
+        {
+            typedef ::std::vector<graph_node*, guarded_allocator<graph_node*> > edges_type;
+
+            edges_type downstreams; ///< Signals connected to this signal (one element per connection)
+            edges_type   upstreams; ///< Signals to which this signal is connected (one element per connection)
+            long long        order; ///< Position in topological order (every upstream signal has lesser order)
+            unsigned long long visit; ///< Number of the last search which has visited this node
+
+            explicit graph_node(long long _order) : order(_order), visit(0)
+            {
+            }
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Incremental topological order of signal-to-signal connections.
+
+        Every node has unique order and every connection goes from lesser order to greater one.
+        New connection x -> y which keeps the order (or which starts from a node without upstreams,
+        or ends at a node without downstreams) is inserted in O(1). Otherwise signals reachable from y
+        with order less than x's order are searched for x (it is a cycle if x is found), and
+        signals reaching x with order greater than y's order are moved after them.
+
+        Graph is protected by one process-wide mutex. It is always locked the last
+        (graph does not call signals), so it can be locked under locked signal.
+
+        Search lists keep their memory, so searches do not allocate after warm-up.
+
+        \ingroup util */
+        class signal_graph final
+        {
+            typedef ::std::vector<graph_node*, guarded_allocator<graph_node*> > nodes_type;
+            typedef ::std::vector<long long, guarded_allocator<long long> >    orders_type;
+
+            ::std::mutex          m_mutex; ///< Protects all nodes
+            nodes_type          m_forward; ///< Nodes reachable from downstream node of inserted connection
+            nodes_type         m_backward; ///< Nodes reaching upstream node of inserted connection
+            nodes_type            m_stack; ///< Stack of search
+            orders_type          m_orders; ///< Orders of moved nodes
+            long long             m_first; ///< The least order ever given
+            long long              m_last; ///< The greatest order ever given
+            unsigned long long    m_visit; ///< Number of the last search
+
+            signal_graph() : m_first(0), m_last(0), m_visit(0)
+            {
+            }
+
+            signal_graph(const signal_graph&) = delete;
+            signal_graph& operator = (const signal_graph&) = delete;
+
+        public:
+
+            /** \brief Inserts connection _from -> _to unless it creates a cycle.
+
+            Nodes are created if they do not exist yet.
+
+            \retval false if _to reaches _from (connection is not inserted). */
+            static bool insert(graph_node*& _from, graph_node*& _to)
+            {
+                signal_graph& graph = instance();
+                ::std::lock_guard<::std::mutex> lg(graph.m_mutex);
+
+                if (_from == nullptr)
+                {
+                    _from = guarded_new<graph_node>(--graph.m_first); // new upstream node goes before all nodes
+                }
+
+                if (_to == nullptr)
+                {
+                    _to = guarded_new<graph_node>(++graph.m_last); // new downstream node goes after all nodes
+                }
+
+                graph_node* from = _from;
+                graph_node* to = _to;
+
+                if (from == to)
+                {
+                    return false;
+                }
+
+                if (to->order < from->order)
+                {
+                    if (from->upstreams.empty())
+                    {
+                        from->order = --graph.m_first;
+                    }
+                    else if (to->downstreams.empty())
+                    {
+                        to->order = ++graph.m_last;
+                    }
+                    else if (!graph.reorder(from, to))
+                    {
+                        return false;
+                    }
+                }
+
+                from->downstreams.push_back(to);
+                to->upstreams.push_back(from);
+
+                return true;
+            }
+
+            /** \brief Removes one connection _from -> _to. */
+            static void erase(graph_node* _from, graph_node* _to)
+            {
+                signal_graph& graph = instance();
+                ::std::lock_guard<::std::mutex> lg(graph.m_mutex);
+
+                remove(_from->downstreams, _to);
+                remove(_to->upstreams, _from);
+            }
+
+            /** \brief Destroys node which has no connections. */
+            static void release(graph_node*& _node)
+            {
+                if (_node != nullptr)
+                {
+                    signal_graph& graph = instance();
+                    ::std::lock_guard<::std::mutex> lg(graph.m_mutex);
+
+                    delete _node;
+                    _node = nullptr;
+                }
+            }
+
+        private:
+
+            /** \brief Returns the graph (it is never destroyed, so it outlives static signals). */
+            static signal_graph& instance()
+            {
+                static signal_graph* s_graph = create();
+                return *s_graph;
+            }
+
+            static signal_graph* create()
+            {
+                on_allocation();
+                return new signal_graph();
+            }
+
+            static void remove(graph_node::edges_type& _edges, graph_node* _node)
+            {
+                *::std::find(_edges.begin(), _edges.end(), _node) = _edges.back();
+                _edges.pop_back();
+            }
+
+            static bool less_order(const graph_node* _left, const graph_node* _right)
+            {
+                return _left->order < _right->order;
+            }
+
+            /** \brief Restores order before insertion of connection _from -> _to (_to has lesser order).
+
+            \retval false if _to reaches _from. */
+            bool reorder(graph_node* _from, graph_node* _to)
+            {
+                const long long upper = _from->order;
+                const long long lower = _to->order;
+                const unsigned long long visit = ++m_visit;
+
+                // Nodes reachable from _to which have to stay after _from
+                m_forward.clear();
+                m_stack.clear();
+                m_stack.push_back(_to);
+                _to->visit = visit;
+                while (!m_stack.empty())
+                {
+                    graph_node* current = m_stack.back();
+                    m_stack.pop_back();
+                    m_forward.push_back(current);
+
+                    for (graph_node* downstream : current->downstreams)
+                    {
+                        if (downstream == _from)
+                        {
+                            return false;
+                        }
+
+                        if (downstream->visit != visit && downstream->order < upper)
+                        {
+                            downstream->visit = visit;
+                            m_stack.push_back(downstream);
+                        }
+                    }
+                }
+
+                // Nodes reaching _from which have to stay before _to (they can not be reached from _to)
+                m_backward.clear();
+                m_stack.push_back(_from);
+                _from->visit = visit;
+                while (!m_stack.empty())
+                {
+                    graph_node* current = m_stack.back();
+                    m_stack.pop_back();
+                    m_backward.push_back(current);
+
+                    for (graph_node* upstream : current->upstreams)
+                    {
+                        if (upstream->visit != visit && upstream->order > lower)
+                        {
+                            upstream->visit = visit;
+                            m_stack.push_back(upstream);
+                        }
+                    }
+                }
+
+                // Visited nodes share their orders: backward nodes take the least ones
+                ::std::sort(m_forward.begin(), m_forward.end(), less_order);
+                ::std::sort(m_backward.begin(), m_backward.end(), less_order);
+
+                m_orders.clear();
+                for (const graph_node* node : m_backward)
+                {
+                    m_orders.push_back(node->order);
+                }
+
+                for (const graph_node* node : m_forward)
+                {
+                    m_orders.push_back(node->order);
+                }
+
+                ::std::sort(m_orders.begin(), m_orders.end());
+
+                size_t position = 0;
+                for (graph_node* node : m_backward)
+                {
+                    node->order = m_orders[position++];
+                }
+
+                for (graph_node* node : m_forward)
+                {
+                    node->order = m_orders[position++];
+                }
+
+                return true;
+            }
+
+        }; // END class signal_graph.
+
+        //////////////////////////////////////////////////////////////////////////
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__SIGNAL_GRAPH__HPP_
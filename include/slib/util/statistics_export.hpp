@@ -0,0 +1,110 @@
+/***************************************************************************************
+* file        : statistics_export.hpp
+*             :
+* description : This header contains functions which write collected signal statistics
+*             : (slot invocation latencies and lock contention) into std::ostream.
+*             : Every record is written on a separate line as a set of key=value pairs,
+*             : so the output can be easily parsed by scripts or merged from several processes.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__STATISTICS_EXPORT__HPP_
+#define SIGNALS_LIBRARY__STATISTICS_EXPORT__HPP_
+
+#include "slib/signals.hpp"
+#include <ostream>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    namespace util {
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Writes latency histogram summary.
+
+        Output example: "count=10 min=120 mean=150 p50=143 p90=191 p99=255 max=260"
+
+        \param _stream Output stream.
+        \param _histogram Reference to histogram. */
+        inline void write_statistics(::std::ostream& _stream, const latency_histogram& _histogram)
+        {
+            _stream << "count=" << _histogram.count()
+                    << " min=" << _histogram.min()
+                    << " mean=" << _histogram.mean()
+                    << " p50=" << _histogram.percentile(50.0)
+                    << " p90=" << _histogram.percentile(90.0)
+                    << " p99=" << _histogram.percentile(99.0)
+                    << " max=" << _histogram.max();
+        }
+
+        /** \brief Writes lock contention statistics.
+
+        Output example: "acquisitions=100 contended=3 wait_ns=5000 hold_ns=20000 max_hold_ns=900"
+
+        \param _stream Output stream.
+        \param _statistics Reference to statistics. */
+        inline void write_statistics(::std::ostream& _stream, const lock_statistics& _statistics)
+        {
+            _stream << "acquisitions=" << _statistics.acquisitions
+                    << " contended=" << _statistics.contended
+                    << " wait_ns=" << _statistics.wait_time
+                    << " hold_ns=" << _statistics.hold_time
+                    << " max_hold_ns=" << _statistics.max_hold_time;
+        }
+
+        /** \brief Writes all statistics collected by signal.
+
+        First line contains lock statistics of the signal, next lines contain latency statistics
+        of the slowest connections (if profiling is enabled):
+
+        signal=<name> locks acquisitions=...
+        signal=<name> slot=<address> count=...
+
+        \param _stream Output stream.
+        \param _name Name of the signal used to identify records.
+        \param _signal Reference to the signal.
+        \param _slowest_number Maximum number of connections to write. */
+        template <class signal_type>
+        void write_statistics(::std::ostream& _stream, const char* _name, const signal_type& _signal, size_t _slowest_number = 10)
+        {
+            _stream << "signal=" << _name << " locks ";
+            write_statistics(_stream, _signal.lock_statistics());
+            _stream << '\n';
+
+            for (const auto& connection : _signal.slowest(_slowest_number))
+            {
+                _stream << "signal=" << _name << " slot=" << static_cast<const void*>(connection.slot) << ' ';
+                write_statistics(_stream, connection.histogram);
+                _stream << '\n';
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // SIGNALS_LIBRARY__STATISTICS_EXPORT__HPP_
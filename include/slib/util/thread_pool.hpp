@@ -0,0 +1,760 @@
+/***************************************************************************************
+* file        : thread_pool.hpp
+*             :
+* description : This header contains declaration and definition of thread_pool class
+*             : which executes intrusive pool_task objects on a fixed set of worker threads,
+*             : and task_latch class which is used to wait for completion of a set of tasks.
+*             :
+*             : Every worker owns Chase-Lev work-stealing deque (work_deque). Tasks submitted by
+*             : a worker go to it's own deque, tasks submitted by other threads go to the shared inbox.
+*             : Idle worker steals tasks from deques of other workers before parking.
+*             :
+*             : Tasks are not allocated by the pool: every pool_task is owned by it's submitter
+*             : (usually it lives on the submitter's stack until completion is awaited).
+*             : Asynchronous invocations (thread_pool::post, signal::emit_async) use async_task
+*             : nodes ({delegate, args_list} pairs) which are reused through task_cache.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__EXECUTORS__HPP_
+
+#error thread_pool.hpp must be included only from executors.hpp!
+
+#elif !defined(SIGNALS_LIBRARY__THREAD_POOL__HPP_)
+
+#define SIGNALS_LIBRARY__THREAD_POOL__HPP_
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <new>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    namespace util {
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Intrusive task of thread_pool.
+
+        Concrete tasks derive from pool_task and set function which casts task back to derived type.
+
+        \ingroup util */
+        struct pool_task
+        {
+            void      (*function)(pool_task* _task); ///< Task body
+            pool_task*                          next; ///< Next task in worker's queue (used by pool)
+
+            explicit pool_task(void (*_function)(pool_task*) = nullptr) : function(_function), next(nullptr)
+            {
+            }
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Counter of unfinished tasks.
+
+        \ingroup util */
+        class task_latch final
+        {
+            ::std::atomic<unsigned int> m_count; ///< Number of unfinished tasks
+
+            task_latch(const task_latch&) = delete;
+            task_latch& operator = (const task_latch&) = delete;
+
+        public:
+
+            explicit task_latch(unsigned int _count = 0) : m_count(_count)
+            {
+            }
+
+            /** \brief Adds unfinished tasks. */
+            inline void add(unsigned int _count)
+            {
+                m_count.fetch_add(_count, ::std::memory_order_relaxed);
+            }
+
+            /** \brief Marks one task as finished. */
+            inline void count_down()
+            {
+                m_count.fetch_sub(1, ::std::memory_order_release);
+            }
+
+            /** \brief Returns true if all tasks have been finished. */
+            inline bool done() const
+            {
+                return m_count.load(::std::memory_order_acquire) == 0;
+            }
+
+        }; // END class task_latch.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Chase-Lev work-stealing deque of pool tasks.
+
+        Owner thread pushes and pops tasks at the bottom (LIFO, good for cache locality),
+        other threads steal tasks from the top (FIFO). Only steal and pop of the last task use CAS.
+        Buffer grows by doubling; old buffers are kept until destruction because thieves may still read them.
+
+        \ingroup util */
+        class work_deque final
+        {
+            /** \brief Circular buffer of tasks. */
+            struct buffer final
+            {
+                const long                               mask; ///< Capacity - 1 (capacity is power of 2)
+                ::std::unique_ptr<::std::atomic<pool_task*>[]> tasks; ///< Elements
+                ::std::unique_ptr<buffer>             previous; ///< Buffer which has been replaced by this one
+
+                explicit buffer(long _capacity) : mask(_capacity - 1), tasks(new ::std::atomic<pool_task*>[_capacity])
+                {
+                }
+
+                inline pool_task* get(long _index) const
+                {
+                    return tasks[_index & mask].load(::std::memory_order_relaxed);
+                }
+
+                inline void put(long _index, pool_task* _task)
+                {
+                    tasks[_index & mask].store(_task, ::std::memory_order_relaxed);
+                }
+            };
+
+            ::std::atomic<long>         m_top; ///< Index of the oldest task (changed by thieves and by owner)
+            ::std::atomic<long>      m_bottom; ///< Index after the newest task (changed only by owner)
+            ::std::atomic<buffer*>   m_buffer; ///< Current buffer
+
+            work_deque(const work_deque&) = delete;
+            work_deque& operator = (const work_deque&) = delete;
+
+        public:
+
+            explicit work_deque(long _capacity = 256) : m_top(0), m_bottom(0), m_buffer(new buffer(_capacity))
+            {
+            }
+
+            ~work_deque()
+            {
+                delete m_buffer.load(::std::memory_order_relaxed); // deletes all previous buffers
+            }
+
+            /** \brief Pushes task to the bottom. Must be called only by owner. */
+            void push(pool_task* _task)
+            {
+                const long b = m_bottom.load(::std::memory_order_relaxed);
+                const long t = m_top.load(::std::memory_order_acquire);
+                buffer* a = m_buffer.load(::std::memory_order_relaxed);
+
+                if (b - t > a->mask)
+                {
+                    a = grow(a, t, b);
+                }
+
+                a->put(b, _task);
+                m_bottom.store(b + 1, ::std::memory_order_release);
+            }
+
+            /** \brief Pops the newest task. Must be called only by owner.
+
+            \retval nullptr if deque is empty. */
+            pool_task* pop()
+            {
+                const long b = m_bottom.load(::std::memory_order_relaxed) - 1;
+                buffer* a = m_buffer.load(::std::memory_order_relaxed);
+                m_bottom.store(b, ::std::memory_order_relaxed);
+                ::std::atomic_thread_fence(::std::memory_order_seq_cst);
+                long t = m_top.load(::std::memory_order_relaxed);
+
+                if (t > b)
+                {
+                    m_bottom.store(b + 1, ::std::memory_order_relaxed); // empty
+                    return nullptr;
+                }
+
+                pool_task* task = a->get(b);
+                if (t == b)
+                {
+                    // the last task: race with thieves
+                    if (!m_top.compare_exchange_strong(t, t + 1, ::std::memory_order_seq_cst, ::std::memory_order_relaxed))
+                    {
+                        task = nullptr;
+                    }
+
+                    m_bottom.store(b + 1, ::std::memory_order_relaxed);
+                }
+
+                return task;
+            }
+
+            /** \brief Steals the oldest task. Can be called by any thread.
+
+            \retval nullptr if deque is empty or another thread has taken the task first. */
+            pool_task* steal()
+            {
+                long t = m_top.load(::std::memory_order_acquire);
+                ::std::atomic_thread_fence(::std::memory_order_seq_cst);
+                const long b = m_bottom.load(::std::memory_order_acquire);
+
+                if (t >= b)
+                {
+                    return nullptr;
+                }
+
+                pool_task* task = m_buffer.load(::std::memory_order_acquire)->get(t);
+                if (!m_top.compare_exchange_strong(t, t + 1, ::std::memory_order_seq_cst, ::std::memory_order_relaxed))
+                {
+                    return nullptr;
+                }
+
+                return task;
+            }
+
+            /** \brief Returns true if deque looks empty (result may be outdated immediately). */
+            inline bool empty() const
+            {
+                return m_bottom.load(::std::memory_order_relaxed) <= m_top.load(::std::memory_order_relaxed);
+            }
+
+        private:
+
+            buffer* grow(buffer* _old, long _top, long _bottom)
+            {
+                buffer* a = new buffer((_old->mask + 1) * 2);
+                for (long i = _top; i < _bottom; ++i)
+                {
+                    a->put(i, _old->get(i));
+                }
+
+                a->previous.reset(_old);
+                m_buffer.store(a, ::std::memory_order_release);
+                return a;
+            }
+
+        }; // END class work_deque.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Fixed-size pool of worker threads with work stealing.
+
+        Every worker owns a work_deque: tasks submitted by worker itself (for example, by slots
+        invoked on it) are pushed there without locking. Tasks submitted by other threads go to
+        the shared inbox. Idle worker takes tasks from it's own deque, then from the inbox,
+        then steals from other workers and parks only after that.
+
+        Submission does not touch parking mutex unless some worker is parked.
+
+        Usage example:
+        \code
+        slib::util::thread_pool pool; // hardware_concurrency() - 1 workers
+        strategies_recalc.emit_parallel(pool, tick);
+        trades_logged.emit_async(pool, trade);
+        \endcode
+
+        \ingroup util */
+        class thread_pool final
+        {
+            /** \brief State of one worker. */
+            struct worker final
+            {
+                work_deque        tasks; ///< Tasks submitted by this worker
+                ::std::thread    thread; ///< Worker thread
+            };
+
+            ::std::vector<::std::unique_ptr<worker> > m_workers; ///< Workers
+            ::std::mutex                          m_inbox_mutex; ///< Protects inbox
+            ::std::atomic<pool_task*>             m_inbox_first; ///< The oldest task submitted from outside
+            pool_task*                             m_inbox_last; ///< The newest task submitted from outside
+            ::std::mutex                           m_park_mutex; ///< Mutex for parking of idle workers
+            ::std::condition_variable                    m_park; ///< Idle workers wait on it
+            ::std::atomic<long>                       m_pending; ///< Number of queued tasks
+            ::std::atomic<unsigned int>              m_sleeping; ///< Number of parked workers
+            ::std::atomic<bool>                          m_stop; ///< Stop flag for workers
+
+            thread_pool(const thread_pool&) = delete;
+            thread_pool& operator = (const thread_pool&) = delete;
+
+        public:
+
+            /** \brief Starts workers.
+
+            \param _threads Number of worker threads (0 means hardware_concurrency() - 1, but at least 1). */
+            explicit thread_pool(unsigned int _threads = 0)
+                : m_inbox_first(nullptr)
+                , m_inbox_last(nullptr)
+                , m_pending(0)
+                , m_sleeping(0)
+                , m_stop(false)
+            {
+                if (_threads == 0)
+                {
+                    const unsigned int hardware = ::std::thread::hardware_concurrency();
+                    _threads = hardware > 1 ? hardware - 1 : 1;
+                }
+
+                m_workers.reserve(_threads);
+                for (unsigned int i = 0; i < _threads; ++i)
+                {
+                    m_workers.emplace_back(new worker());
+                }
+
+                for (unsigned int i = 0; i < _threads; ++i)
+                {
+                    m_workers[i]->thread = ::std::thread(&thread_pool::work, this, i);
+                }
+            }
+
+            /** \brief Stops workers.
+
+            \warning All submitted tasks must be finished before destruction. */
+            ~thread_pool()
+            {
+                {
+                    ::std::lock_guard<::std::mutex> lg(m_park_mutex);
+                    m_stop = true;
+                }
+
+                m_park.notify_all();
+                for (auto& w : m_workers)
+                {
+                    w->thread.join();
+                }
+            }
+
+            /** \brief Returns number of worker threads. */
+            inline unsigned int size() const
+            {
+                return static_cast<unsigned int>(m_workers.size());
+            }
+
+            /** \brief Queues task for execution.
+
+            \note Task must stay alive until it's function is finished. */
+            void submit(pool_task* _task)
+            {
+                const unsigned int index = current_worker(this);
+                if (index != no_worker)
+                {
+                    m_workers[index]->tasks.push(_task);
+                }
+                else
+                {
+                    _task->next = nullptr;
+
+                    ::std::lock_guard<::std::mutex> lg(m_inbox_mutex);
+                    if (m_inbox_last != nullptr)
+                    {
+                        m_inbox_last->next = _task;
+                    }
+                    else
+                    {
+                        m_inbox_first.store(_task, ::std::memory_order_relaxed);
+                    }
+                    m_inbox_last = _task;
+                }
+
+                m_pending.fetch_add(1, ::std::memory_order_seq_cst);
+                if (m_sleeping.load(::std::memory_order_seq_cst) != 0)
+                {
+                    // lock is needed to not lose notification of a worker which is going to park
+                    ::std::lock_guard<::std::mutex> lg(m_park_mutex);
+                    m_park.notify_one();
+                }
+            }
+
+            /** \brief Invokes delegate with copies of specified arguments on the pool.
+
+            Task node is taken from the cache of async_task nodes (no allocation after warm-up).
+
+            \warning Object of the delegate must stay alive until invocation. */
+            template <typename return_type, typename ... Args, class ... TArgs>
+            inline void post(const ::slib::delegate<return_type(Args...)>& _delegate, TArgs&&... _args);
+
+            /** \brief Executes one queued task on calling thread.
+
+            Used by threads which wait for completion of their tasks (they help instead of blocking).
+
+            \retval false if there were no queued tasks. */
+            bool run_one()
+            {
+                const unsigned int index = current_worker(this);
+                pool_task* task = take(index == no_worker ? 0 : index, index != no_worker);
+                if (task == nullptr)
+                {
+                    return false;
+                }
+
+                task->function(task);
+                return true;
+            }
+
+            /** \brief Waits for completion of tasks counted by latch helping the pool meanwhile. */
+            void wait(const task_latch& _latch)
+            {
+                while (!_latch.done())
+                {
+                    if (!run_one())
+                    {
+                        ::std::this_thread::yield();
+                    }
+                }
+            }
+
+        private:
+
+            enum : unsigned int { no_worker = ~0U };
+
+            /** \brief Returns index of calling worker thread in specified pool (or no_worker). */
+            static unsigned int& current_worker_index()
+            {
+                static thread_local unsigned int index = no_worker;
+                return index;
+            }
+
+            static const thread_pool*& current_pool()
+            {
+                static thread_local const thread_pool* pool = nullptr;
+                return pool;
+            }
+
+            static inline unsigned int current_worker(const thread_pool* _pool)
+            {
+                return current_pool() == _pool ? current_worker_index() : no_worker;
+            }
+
+            /** \brief Takes task from own deque (if _owner), from the inbox or steals it from other workers. */
+            pool_task* take(unsigned int _index, bool _owner)
+            {
+                pool_task* task = _owner ? m_workers[_index]->tasks.pop() : nullptr;
+
+                if (task == nullptr && m_inbox_first.load(::std::memory_order_relaxed) != nullptr)
+                {
+                    task = take_inbox(_index, _owner);
+                }
+
+                const unsigned int number = size();
+                for (unsigned int i = 1; task == nullptr && i <= number; ++i)
+                {
+                    const unsigned int victim = (_index + i) % number;
+                    if (victim != _index || !_owner)
+                    {
+                        task = m_workers[victim]->tasks.steal();
+                    }
+                }
+
+                if (task != nullptr)
+                {
+                    m_pending.fetch_sub(1, ::std::memory_order_relaxed);
+                }
+
+                return task;
+            }
+
+            /** \brief Takes the oldest task from the inbox.
+
+            Worker takes the whole inbox at once (one lock for many tasks) and moves the rest of tasks
+            into it's own deque (in reverse order, so it pops them in order of submission). */
+            pool_task* take_inbox(unsigned int _index, bool _owner)
+            {
+                pool_task* task;
+
+                {
+                    ::std::lock_guard<::std::mutex> lg(m_inbox_mutex);
+                    task = m_inbox_first.load(::std::memory_order_relaxed);
+                    if (task == nullptr)
+                    {
+                        return nullptr;
+                    }
+
+                    if (_owner)
+                    {
+                        m_inbox_first.store(nullptr, ::std::memory_order_relaxed);
+                        m_inbox_last = nullptr;
+                    }
+                    else
+                    {
+                        m_inbox_first.store(task->next, ::std::memory_order_relaxed);
+                        if (task->next == nullptr)
+                        {
+                            m_inbox_last = nullptr;
+                        }
+
+                        return task;
+                    }
+                }
+
+                pool_task* reversed = nullptr;
+                for (pool_task* current = task->next; current != nullptr;)
+                {
+                    pool_task* next = current->next;
+                    current->next = reversed;
+                    reversed = current;
+                    current = next;
+                }
+
+                work_deque& own = m_workers[_index]->tasks;
+                while (reversed != nullptr)
+                {
+                    pool_task* next = reversed->next; // pushed task may be stolen and finished immediately
+                    own.push(reversed);
+                    reversed = next;
+                }
+
+                return task;
+            }
+
+            void work(unsigned int _index)
+            {
+                current_pool() = this;
+                current_worker_index() = _index;
+
+                while (true)
+                {
+                    pool_task* task = take(_index, true);
+                    if (task != nullptr)
+                    {
+                        task->function(task);
+                        continue;
+                    }
+
+                    if (m_pending.load(::std::memory_order_relaxed) > 0)
+                    {
+                        ::std::this_thread::yield(); // task is being pushed or it has been stolen meanwhile
+                        continue;
+                    }
+
+                    ::std::unique_lock<::std::mutex> lock(m_park_mutex);
+                    m_sleeping.fetch_add(1, ::std::memory_order_seq_cst);
+                    m_park.wait(lock, [this]() { return m_stop || m_pending.load(::std::memory_order_seq_cst) > 0; });
+                    m_sleeping.fetch_sub(1, ::std::memory_order_relaxed);
+
+                    if (m_stop)
+                    {
+                        return;
+                    }
+                }
+            }
+
+        }; // END class thread_pool.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Thread-safe cache of memory of tasks of one type.
+
+        Memory of finished tasks is kept in free lists and reused by next tasks of the same type,
+        so asynchronous invocations do not allocate after warm-up.
+
+        Every thread has it's own free list which is used without locking. Tasks are usually created
+        by one thread and finished by another, so threads exchange free blocks with the shared list
+        in batches: one lock per batch_size tasks.
+
+        \ingroup util */
+        template <class task_type>
+        class task_cache final
+        {
+            enum : unsigned int { batch_size = 64 };
+
+            /** \brief Free memory block. */
+            struct free_block final
+            {
+                free_block* next;
+            };
+
+            /** \brief Free list of one thread. */
+            struct local_list final
+            {
+                free_block*  first; ///< Free blocks
+                unsigned int  size; ///< Number of free blocks
+
+                local_list() : first(nullptr), size(0)
+                {
+                }
+
+                ~local_list()
+                {
+                    if (first != nullptr)
+                    {
+                        instance().give(first, size);
+                    }
+                }
+            };
+
+            ::std::mutex   m_mutex; ///< Protects shared list
+            free_block*     m_free; ///< Shared list
+            unsigned int    m_size; ///< Number of blocks in shared list
+
+            task_cache() : m_free(nullptr), m_size(0)
+            {
+            }
+
+            task_cache(const task_cache&) = delete;
+            task_cache& operator = (const task_cache&) = delete;
+
+        public:
+
+            ~task_cache()
+            {
+                while (m_free != nullptr)
+                {
+                    free_block* block = m_free;
+                    m_free = block->next;
+                    ::operator delete(block);
+                }
+            }
+
+            /** \brief Returns cache of task_type. */
+            static task_cache& instance()
+            {
+                static task_cache cache;
+                return cache;
+            }
+
+            /** \brief Returns memory for one task. */
+            void* allocate()
+            {
+                local_list& local = local_free_list();
+                if (local.first == nullptr)
+                {
+                    // take the whole shared list
+                    ::std::lock_guard<::std::mutex> lg(m_mutex);
+                    local.first = m_free;
+                    local.size = m_size;
+                    m_free = nullptr;
+                    m_size = 0;
+                }
+
+                free_block* block = local.first;
+                if (block == nullptr)
+                {
+                    static_assert(sizeof(task_type) >= sizeof(free_block), "task is too small");
+                    return ::operator new(sizeof(task_type));
+                }
+
+                local.first = block->next;
+                --local.size;
+                return block;
+            }
+
+            /** \brief Destroys task and returns it's memory into cache. */
+            void deallocate(task_type* _task)
+            {
+                _task->~task_type();
+                free_block* block = reinterpret_cast<free_block*>(_task);
+
+                local_list& local = local_free_list();
+                block->next = local.first;
+                local.first = block;
+
+                if (++local.size >= batch_size)
+                {
+                    give(local.first, local.size);
+                    local.first = nullptr;
+                    local.size = 0;
+                }
+            }
+
+        private:
+
+            static local_list& local_free_list()
+            {
+                static thread_local local_list local;
+                return local;
+            }
+
+            /** \brief Moves list of free blocks into shared list. */
+            void give(free_block* _first, unsigned int _size)
+            {
+                free_block* last = _first;
+                while (last->next != nullptr)
+                {
+                    last = last->next;
+                }
+
+                ::std::lock_guard<::std::mutex> lg(m_mutex);
+                last->next = m_free;
+                m_free = _first;
+                m_size += _size;
+            }
+
+        }; // END class task_cache.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        template <typename function_signature> struct async_task;
+
+        /** \brief Asynchronous invocation of delegate: a {delegate, args_list} pair.
+
+        Arguments are stored by value (decayed types), so delegate must not take non-const lvalue references.
+
+        \ingroup util */
+        template <typename return_type, typename ... Args>
+        struct async_task < return_type(Args...) > final : public pool_task
+        {
+            typedef ::slib::delegate< return_type(Args...) >                                 delegate_type;
+            typedef ::slib::args_list< return_type(typename ::std::decay<Args>::type...) > arguments_type;
+            typedef ::std::tuple<typename ::std::decay<Args>::type...>                          tuple_type;
+            typedef task_cache<async_task>                                                       cache_type;
+
+            delegate_type    target; ///< Invoked delegate
+            arguments_type arguments; ///< Copies of arguments
+
+            template <class ... TArgs>
+            async_task(const delegate_type& _target, TArgs&&... _args)
+                : pool_task(&async_task::run)
+                , target(_target)
+                , arguments(tuple_type(::std::forward<TArgs>(_args)...))
+            {
+            }
+
+            static void run(pool_task* _task)
+            {
+                async_task* that = static_cast<async_task*>(_task);
+                that->arguments(that->target);
+                cache_type::instance().deallocate(that);
+            }
+
+        }; // END struct async_task.
+
+        //////////////////////////////////////////////////////////////////////////
+
+        template <typename return_type, typename ... Args, class ... TArgs>
+        inline void thread_pool::post(const ::slib::delegate<return_type(Args...)>& _delegate, TArgs&&... _args)
+        {
+            typedef async_task< return_type(Args...) > task_type;
+            submit(new (task_type::cache_type::instance().allocate()) task_type(_delegate, ::std::forward<TArgs>(_args)...));
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // ifdef SIGNALS_LIBRARY__EXECUTORS__HPP_ && !defined(SIGNALS_LIBRARY__THREAD_POOL__HPP_)
@@ -0,0 +1,457 @@
+/***************************************************************************************
+* file        : timer_wheel.hpp
+*             :
+* description : This header contains declaration and definition of timer_wheel class
+*             : which is a hierarchical timing wheel of intrusive timer_node objects.
+*             :
+*             : Time is counted in ticks of fixed resolution. Every level has 64 slots, every
+*             : slot of level N covers 64^N ticks. Timer is linked into slot of the lowest level
+*             : which covers it's deadline, so schedule and cancel are O(1) (link/unlink of
+*             : an intrusive list). When slot index of a level wraps around, timers of the
+*             : corresponding slot of the next level are redistributed to lower levels
+*             : (every timer is moved at most once per level).
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__SIGNALS__HPP_
+
+#error timer_wheel.hpp must be included only after signals.hpp!
+
+#elif !defined(SIGNALS_LIBRARY__TIMER_WHEEL__HPP_)
+
+#define SIGNALS_LIBRARY__TIMER_WHEEL__HPP_
+
+#include <chrono>
+#include <thread>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    namespace util {
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Intrusive timer of timer_wheel.
+
+        Concrete timers derive from timer_node and set function which casts timer back to derived type
+        (the same way as pool_task).
+
+        \ingroup util */
+        struct timer_node
+        {
+            timer_node*                           prev; ///< Previous element in wheel's slot (used by wheel)
+            timer_node*                           next; ///< Next element in wheel's slot (nullptr if timer is not scheduled)
+            unsigned long long                deadline; ///< Tick at which timer expires
+            void        (*function)(timer_node* _timer); ///< Expiration handler
+
+            explicit timer_node(void (*_function)(timer_node*) = nullptr) : prev(nullptr), next(nullptr), deadline(0), function(_function)
+            {
+            }
+
+            /** \brief Returns true if timer is scheduled (it has not expired and it has not been cancelled). */
+            inline bool scheduled() const
+            {
+                return next != nullptr;
+            }
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Hierarchical timing wheel.
+
+        Usage example:
+        \code
+        slib::util::timer_wheel wheel(std::chrono::milliseconds(1));
+        wheel.schedule_after(&timer, std::chrono::milliseconds(250));
+        // ... event loop:
+        wheel.advance(); // expired timers are invoked
+        \endcode
+
+        Timers are invoked by advance() in order of their deadlines (timers of the same tick are
+        invoked in order of scheduling). Expiration handler is invoked without locked wheel mutex,
+        so it may schedule or cancel any timers (including itself).
+
+        \warning Timers must be cancelled (or expired) before their destruction.
+
+        \ingroup util */
+        class timer_wheel final
+        {
+        public:
+
+            typedef ::std::chrono::steady_clock clock_type;
+
+            /** \brief Function which is called by schedule() with deadline of scheduled timer (see set_wake_function). */
+            typedef void (*wake_function)(void* _context, clock_type::time_point _deadline);
+
+        private:
+
+            enum : unsigned int { level_bits = 6, level_slots = 1U << level_bits, levels = 6 };
+
+            typedef ::slib::util::dynamic_mutex          dynamic_mutex;
+            typedef ::slib::util::lock_guard<dynamic_mutex> lock_guard;
+
+            timer_node       m_slots[levels][level_slots]; ///< Heads of circular lists of slots
+            clock_type::time_point                m_start; ///< Time of tick 0
+            clock_type::duration             m_resolution; ///< Duration of one tick
+            unsigned long long                      m_now; ///< The last processed tick
+            size_t                                 m_size; ///< Number of scheduled timers
+            const timer_node*                   m_current; ///< Timer which handler is being invoked by advance()
+            ::std::thread::id                   m_invoker; ///< Thread which invokes m_current
+            wake_function                          m_wake; ///< Function called by schedule() (nullptr if it is not set)
+            void*                          m_wake_context; ///< Argument of m_wake
+            dynamic_mutex                         m_mutex; ///< Mutex for multithreading protection (it is not multithreated by default)
+
+            timer_wheel(const timer_wheel&) = delete;
+            timer_wheel& operator = (const timer_wheel&) = delete;
+
+        public:
+
+            /** \brief Constructs empty wheel.
+
+            \param _resolution Duration of one tick (timers expire with this precision).
+            \param _is_threadsafe Thread-safety flag. */
+            template <class rep_type = long long, class period_type = ::std::milli>
+            explicit timer_wheel(const ::std::chrono::duration<rep_type, period_type>& _resolution = ::std::chrono::milliseconds(1), bool _is_threadsafe = false)
+                : m_start(clock_type::now())
+                , m_resolution(::std::chrono::duration_cast<clock_type::duration>(_resolution))
+                , m_now(0)
+                , m_size(0)
+                , m_current(nullptr)
+                , m_wake(nullptr)
+                , m_wake_context(nullptr)
+                , m_mutex(_is_threadsafe)
+            {
+                if (m_resolution <= clock_type::duration::zero())
+                {
+                    m_resolution = clock_type::duration(1);
+                }
+
+                for (auto& level : m_slots)
+                {
+                    for (auto& head : level)
+                    {
+                        head.prev = &head;
+                        head.next = &head;
+                    }
+                }
+            }
+
+            /** \brief Returns thread-safety flag. */
+            inline bool threadsafe() const
+            {
+                return m_mutex.threadsafe();
+            }
+
+            /** \brief Returns duration of one tick. */
+            inline clock_type::duration resolution() const
+            {
+                return m_resolution;
+            }
+
+            /** \brief Returns time of the last processed tick.
+
+            Expiration handlers may use it as current time (it is not later than clock_type::now()). */
+            inline clock_type::time_point time() const
+            {
+                lock_guard lg(m_mutex);
+                return m_start + m_resolution * static_cast<clock_type::rep>(m_now);
+            }
+
+            /** \brief Returns number of scheduled timers. */
+            inline size_t size() const
+            {
+                lock_guard lg(m_mutex);
+                return m_size;
+            }
+
+            /** \brief Sets function which is called by every schedule() after timer is scheduled (wheel is not locked then).
+
+            Thread which sleeps until next_expiry() uses it to wake up when earlier timer is scheduled,
+            so timers scheduled directly through the wheel are not missed (see timer_scheduler).
+
+            \warning This method is NOT thread-safe. Use this on initialization. */
+            inline void set_wake_function(wake_function _function, void* _context)
+            {
+                m_wake = _function;
+                m_wake_context = _context;
+            }
+
+            /** \brief Schedules timer (reschedules it if it is already scheduled).
+
+            Timer expires on the first tick which is not earlier than _deadline (but not earlier than the next tick).
+
+            \note Complexity is O(1).
+
+            \note This method is thread-safe if threadsafe() is true. */
+            void schedule(timer_node* _timer, clock_type::time_point _deadline)
+            {
+                {
+                    lock_guard lg(m_mutex);
+
+                    if (_timer->next != nullptr)
+                    {
+                        unlink(_timer);
+                    }
+
+                    const clock_type::duration offset = _deadline - m_start;
+                    unsigned long long tick = offset <= clock_type::duration::zero() ? 0ULL
+                        : static_cast<unsigned long long>((offset + m_resolution - clock_type::duration(1)) / m_resolution);
+
+                    if (tick <= m_now)
+                    {
+                        tick = m_now + 1;
+                    }
+
+                    _timer->deadline = tick;
+                    place(_timer);
+                    ++m_size;
+                }
+
+                if (m_wake != nullptr)
+                {
+                    m_wake(m_wake_context, _deadline);
+                }
+            }
+
+            /** \brief Schedules timer to expire after specified delay.
+
+            \note This method is thread-safe if threadsafe() is true. */
+            template <class rep_type, class period_type>
+            inline void schedule_after(timer_node* _timer, const ::std::chrono::duration<rep_type, period_type>& _delay)
+            {
+                schedule(_timer, clock_type::now() + ::std::chrono::duration_cast<clock_type::duration>(_delay));
+            }
+
+            /** \brief Cancels timer.
+
+            \note Complexity is O(1).
+
+            \note This method is thread-safe if threadsafe() is true.
+
+            \retval false if timer was not scheduled (it has already expired or it is being invoked). */
+            bool cancel(timer_node* _timer)
+            {
+                lock_guard lg(m_mutex);
+
+                if (_timer->next == nullptr)
+                {
+                    return false;
+                }
+
+                unlink(_timer);
+                return true;
+            }
+
+            /** \brief Cancels timer and waits until it's handler is finished if it is being invoked by another thread.
+
+            Use this before destruction of a timer which may expire on another thread.
+
+            \note This method is thread-safe if threadsafe() is true. It may be called from timer's own handler. */
+            void cancel_and_wait(timer_node* _timer)
+            {
+                m_mutex.lock();
+
+                if (_timer->next != nullptr)
+                {
+                    unlink(_timer);
+                }
+
+                while (m_current == _timer && m_invoker != ::std::this_thread::get_id())
+                {
+                    m_mutex.unlock();
+                    ::std::this_thread::yield();
+                    m_mutex.lock();
+                }
+
+                m_mutex.unlock();
+            }
+
+            /** \brief Returns time of the earliest tick at which advance() invokes or redistributes timers.
+
+            Event loop (or timer thread) may sleep until this time. It is not later than the earliest
+            deadline, but it may be earlier (when far timers have to be moved to lower levels).
+
+            \note Complexity is O(number of slots) in the worst case.
+
+            \retval clock_type::time_point::max() if there are no scheduled timers. */
+            clock_type::time_point next_expiry() const
+            {
+                lock_guard lg(m_mutex);
+
+                if (m_size == 0)
+                {
+                    return clock_type::time_point::max();
+                }
+
+                // timers of level 0 expire during the next level_slots - 1 ticks
+                unsigned long long tick = ~0ULL;
+                for (unsigned int k = 1; k < level_slots; ++k)
+                {
+                    const timer_node& head = m_slots[0][(m_now + k) & (level_slots - 1)];
+                    if (head.next != &head)
+                    {
+                        tick = m_now + k;
+                        break;
+                    }
+                }
+
+                // timers of higher levels are redistributed when their slot comes
+                for (unsigned int level = 1; level < levels; ++level)
+                {
+                    const unsigned int shift = level * level_bits;
+                    const unsigned long long base = m_now >> shift;
+                    for (unsigned int k = 1; k <= level_slots && ((base + k) << shift) < tick; ++k)
+                    {
+                        const timer_node& head = m_slots[level][(base + k) & (level_slots - 1)];
+                        if (head.next != &head)
+                        {
+                            tick = (base + k) << shift;
+                            break;
+                        }
+                    }
+                }
+
+                return m_start + m_resolution * static_cast<clock_type::rep>(tick);
+            }
+
+            /** \brief Processes all ticks up to specified time and invokes expired timers.
+
+            \note This method is thread-safe if threadsafe() is true, but it must not be called concurrently
+            from several threads (timers would be invoked by different threads).
+
+            \retval Number of invoked timers. */
+            size_t advance(clock_type::time_point _now = clock_type::now())
+            {
+                const clock_type::duration offset = _now - m_start;
+                const unsigned long long target = offset <= clock_type::duration::zero() ? 0ULL
+                    : static_cast<unsigned long long>(offset / m_resolution);
+
+                size_t number = 0;
+
+                m_mutex.lock();
+                m_invoker = ::std::this_thread::get_id();
+                while (m_now < target)
+                {
+                    if (m_size == 0)
+                    {
+                        m_now = target; // nothing to cascade or invoke
+                        break;
+                    }
+
+                    ++m_now;
+
+                    // redistribute timers of higher levels which expire during the next 64^N ticks
+                    for (unsigned int level = 1; level < levels && (m_now & ((1ULL << (level * level_bits)) - 1)) == 0; ++level)
+                    {
+                        cascade(level);
+                    }
+
+                    timer_node& head = m_slots[0][m_now & (level_slots - 1)];
+                    while (head.next != &head)
+                    {
+                        timer_node* timer = head.next;
+                        unlink(timer);
+                        m_current = timer;
+
+                        m_mutex.unlock();
+                        timer->function(timer); // timer may be rescheduled or destroyed by it's handler
+                        m_mutex.lock();
+
+                        m_current = nullptr;
+                        ++number;
+                    }
+                }
+                m_mutex.unlock();
+
+                return number;
+            }
+
+        private:
+
+            /** \brief Links timer into slot of the lowest level which covers it's deadline.
+
+            \note Must be called under locked m_mutex. Deadline must not be earlier than m_now. */
+            inline void place(timer_node* _timer)
+            {
+                const unsigned long long delta = _timer->deadline - m_now;
+
+                unsigned int level = 0;
+                while (level + 1 < levels && delta >= (1ULL << ((level + 1) * level_bits)))
+                {
+                    ++level;
+                }
+
+                unsigned long long deadline = _timer->deadline;
+                if (level + 1 == levels && delta >= (1ULL << (levels * level_bits)))
+                {
+                    deadline = m_now + (1ULL << (levels * level_bits)) - 1; // too far: it is placed again on cascade
+                }
+
+                timer_node& head = m_slots[level][(deadline >> (level * level_bits)) & (level_slots - 1)];
+                _timer->prev = head.prev;
+                _timer->next = &head;
+                head.prev->next = _timer;
+                head.prev = _timer;
+            }
+
+            /** \brief Unlinks timer from it's slot.
+
+            \note Must be called under locked m_mutex. */
+            inline void unlink(timer_node* _timer)
+            {
+                _timer->prev->next = _timer->next;
+                _timer->next->prev = _timer->prev;
+                _timer->prev = nullptr;
+                _timer->next = nullptr;
+                --m_size;
+            }
+
+            /** \brief Moves timers of current slot of specified level to lower levels.
+
+            \note Must be called under locked m_mutex. */
+            void cascade(unsigned int _level)
+            {
+                timer_node& head = m_slots[_level][(m_now >> (_level * level_bits)) & (level_slots - 1)];
+
+                timer_node* timer = head.next;
+                head.prev = &head;
+                head.next = &head;
+
+                while (timer != &head)
+                {
+                    timer_node* next = timer->next;
+                    place(timer);
+                    timer = next;
+                }
+            }
+
+        }; // END class timer_wheel.
+
+        //////////////////////////////////////////////////////////////////////////
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // ifdef SIGNALS_LIBRARY__SIGNALS__HPP_ && !defined(SIGNALS_LIBRARY__TIMER_WHEEL__HPP_)
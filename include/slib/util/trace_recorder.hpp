@@ -0,0 +1,332 @@
+/***************************************************************************************
+* file        : trace_recorder.hpp
+*             :
+* description : This header contains declaration and definition of trace_recorder class
+*             : which writes emissions of signals (and changes of their connections) into
+*             : compact binary file. Such file can be replayed later by trace_player (signals_replay tool)
+*             : to benchmark SignalsLibrary using real traffic.
+*             :
+*             : File format (all integers except header are LEB128 varints):
+*             :
+*             :   header     : "SLIBTRC2"
+*             :   record     : type (1 byte), time delta in nanoseconds from previous record, payload
+*             :   signal     : id, arguments size in bytes, name length, name
+*             :   connect    : id, target signal id (0 if target is an ordinary slot), priority (zigzag)
+*             :   disconnect : id, target signal id (0 if target is an ordinary slot)
+*             :   emit       : id, arguments bytes (raw copy of every trivially copyable argument)
+*             :
+*             : Arguments which are not trivially copyable (for example, std::string) are not written.
+*             : Connections which exist at the moment of registration are written as connect records
+*             : right after signal record, so the whole signal graph can be rebuilt by trace_player.
+*             :
+* license     : This file is part of SignalsLibrary.
+*             :
+*             : SignalsLibrary is free software: you can redistribute it and/or modify
+*             : it under the terms of the GNU General Public License as published by
+*             : the Free Software Foundation, either version 3 of the License, or
+*             : (at your option) any later version.
+*             :
+*             : SignalsLibrary is distributed in the hope that it will be useful,
+*             : but WITHOUT ANY WARRANTY; without even the implied warranty of
+*             : MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*             : GNU General Public License for more details.
+*             :
+*             : You should have received a copy of the GNU General Public License
+*             : along with SignalsLibrary. If not, see <http://www.gnu.org/licenses/>.
+*             :
+*             : A copy of the GNU General Public License can be found in file LICENSE.
+****************************************************************************************/
+
+#ifndef SIGNALS_LIBRARY__RECORDING__HPP_
+
+#error trace_recorder.hpp must be included only from recording.hpp!
+
+#elif !defined(SIGNALS_LIBRARY__TRACE_RECORDER__HPP_)
+
+#define SIGNALS_LIBRARY__TRACE_RECORDER__HPP_
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+#include <type_traits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace slib {
+
+    namespace util {
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Auxiliary struct which copies trivially copyable arguments into trace buffer. */
+        template <class ... T> struct trace_arguments;
+
+        template <> struct trace_arguments<>
+        {
+            enum : unsigned int { size = 0 };
+
+            static inline unsigned char* write(unsigned char* _buffer)
+            {
+                return _buffer;
+            }
+        };
+
+        template <class T, class ... TRest> struct trace_arguments<T, TRest...>
+        {
+            typedef typename ::std::decay<T>::type value_type;
+            typedef ::std::integral_constant<bool, ::std::is_trivially_copyable<value_type>::value> is_trivial;
+
+            enum : unsigned int { size = (is_trivial::value ? sizeof(value_type) : 0) + trace_arguments<TRest...>::size };
+
+            static inline unsigned char* write(unsigned char* _buffer, const value_type& _value, const typename ::std::decay<TRest>::type&... _rest)
+            {
+                return trace_arguments<TRest...>::write(write_one(_buffer, _value, is_trivial()), _rest...);
+            }
+
+        private:
+
+            static inline unsigned char* write_one(unsigned char* _buffer, const value_type& _value, ::std::true_type)
+            {
+                memcpy(_buffer, &_value, sizeof(value_type));
+                return _buffer + sizeof(value_type);
+            }
+
+            static inline unsigned char* write_one(unsigned char* _buffer, const value_type&, ::std::false_type)
+            {
+                return _buffer;
+            }
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+
+        /** \brief Writes emission trace into binary file.
+
+        Usage:
+        \code
+        slib::util::trace_recorder recorder("emissions.trace");
+        price_signal.record(&recorder, "price");
+        order_signal.record(&recorder, "order");
+        // ... run
+        \endcode
+
+        \warning Recorder must not be destroyed while recorded signals use it (call signal::record(nullptr) first).
+
+        \ingroup util */
+        class trace_recorder final
+        {
+            typedef ::std::chrono::steady_clock clock_type;
+
+            ::std::vector<unsigned char> m_buffer; ///< Buffer for records (flushed to file when full)
+            dynamic_mutex                 m_mutex; ///< Mutex for multi-threading protection (it is not thread-safe by default)
+            clock_type::time_point    m_last_time; ///< Time of the last record
+            FILE*                          m_file; ///< Output file
+            size_t                         m_size; ///< Number of used bytes in m_buffer
+            unsigned int                m_last_id; ///< The last registered signal id
+
+            trace_recorder(const trace_recorder&) = delete;
+            trace_recorder& operator = (const trace_recorder&) = delete;
+
+        public:
+
+            enum record_type : unsigned char
+            {
+                record_signal = 1,
+                record_connect,
+                record_disconnect,
+                record_emit
+            };
+
+            /** \brief Opens trace file and writes header.
+
+            \param _filename Name of the trace file.
+            \param _is_threadsafe Thread-safety flag (use true if recorded signals are emitted from several threads).
+            \param _buffer_size Size of memory buffer. */
+            explicit trace_recorder(const char* _filename, bool _is_threadsafe = false, size_t _buffer_size = 1 << 16)
+                : m_buffer(_buffer_size < 1024 ? 1024 : _buffer_size)
+                , m_mutex(_is_threadsafe)
+                , m_last_time(clock_type::now())
+                , m_file(fopen(_filename, "wb"))
+                , m_size(0)
+                , m_last_id(0)
+            {
+                if (m_file != nullptr)
+                {
+                    fwrite("SLIBTRC2", 1, 8, m_file);
+                }
+            }
+
+            ~trace_recorder()
+            {
+                if (m_file != nullptr)
+                {
+                    flush();
+                    fclose(m_file);
+                }
+            }
+
+            /** \brief Returns true if trace file has been opened successfully. */
+            inline bool is_open() const
+            {
+                return m_file != nullptr;
+            }
+
+            /** \brief Writes buffered records into file. */
+            void flush()
+            {
+                lock_guard<dynamic_mutex> lg(m_mutex);
+                private_flush();
+            }
+
+            /** \brief Registers new signal and returns it's id.
+
+            \param _name Name of the signal (used only for reports).
+            \param _arguments_size Size of recorded arguments of one emission in bytes. */
+            unsigned int register_signal(const char* _name, unsigned int _arguments_size)
+            {
+                const size_t name_length = _name == nullptr ? 0 : strlen(_name);
+
+                lock_guard<dynamic_mutex> lg(m_mutex);
+
+                const unsigned int id = ++m_last_id;
+                if (m_file == nullptr)
+                {
+                    return id;
+                }
+
+                private_flush();
+                unsigned char* position = begin_record(record_signal);
+                position = write_varint(position, id);
+                position = write_varint(position, _arguments_size);
+                position = write_varint(position, name_length);
+                m_size = position - m_buffer.data();
+
+                fwrite(m_buffer.data(), 1, m_size, m_file);
+                if (name_length != 0)
+                {
+                    fwrite(_name, 1, name_length, m_file);
+                }
+                m_size = 0;
+
+                return id;
+            }
+
+            /** \brief Records new connection of signal.
+
+            \param _id Signal id.
+            \param _target Id of connected signal (or 0 if an ordinary slot has been connected).
+            \param _priority Emission priority of the connection. */
+            inline void connect(unsigned int _id, unsigned int _target, int _priority)
+            {
+                lock_guard<dynamic_mutex> lg(m_mutex);
+
+                if (m_file != nullptr)
+                {
+                    unsigned char* position = write_varint(begin_record(record_connect, 15), _id);
+                    position = write_varint(position, _target);
+                    m_size = write_varint(position, zigzag(_priority)) - m_buffer.data();
+                }
+            }
+
+            /** \brief Records disconnection of signal.
+
+            \param _id Signal id.
+            \param _target Id of disconnected signal (or 0 if an ordinary slot has been disconnected). */
+            inline void disconnect(unsigned int _id, unsigned int _target)
+            {
+                lock_guard<dynamic_mutex> lg(m_mutex);
+
+                if (m_file != nullptr)
+                {
+                    unsigned char* position = write_varint(begin_record(record_disconnect, 10), _id);
+                    m_size = write_varint(position, _target) - m_buffer.data();
+                }
+            }
+
+            /** \brief Records emission of signal.
+
+            \param _id Signal id.
+            \param _args Emission arguments. */
+            template <class ... T>
+            inline void emit_(unsigned int _id, const T&... _args)
+            {
+                lock_guard<dynamic_mutex> lg(m_mutex);
+
+                if (m_file != nullptr)
+                {
+                    unsigned char* position = write_varint(begin_record(record_emit, trace_arguments<T...>::size + 5), _id);
+                    position = trace_arguments<T...>::write(position, _args...);
+                    m_size = position - m_buffer.data();
+                }
+            }
+
+        private:
+
+            /** \brief Writes buffered records into file. Must be called under locked m_mutex. */
+            inline void private_flush()
+            {
+                if (m_file != nullptr && m_size != 0)
+                {
+                    fwrite(m_buffer.data(), 1, m_size, m_file);
+                    m_size = 0;
+                }
+            }
+
+            /** \brief Makes space for new record and writes it's type and time.
+
+            \param _type Type of the record.
+            \param _payload Maximum size of record's payload in bytes.
+
+            \retval Pointer to payload. */
+            inline unsigned char* begin_record(record_type _type, size_t _payload = 30)
+            {
+                const size_t required = 1 + 10 + _payload;
+                if (m_size + required > m_buffer.size())
+                {
+                    private_flush();
+                    if (required > m_buffer.size())
+                    {
+                        m_buffer.resize(required);
+                    }
+                }
+
+                const auto now = clock_type::now();
+                const auto delta = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(now - m_last_time).count();
+                m_last_time = now;
+
+                unsigned char* position = m_buffer.data() + m_size;
+                *position = _type;
+                return write_varint(position + 1, delta > 0 ? static_cast<unsigned long long>(delta) : 0ULL);
+            }
+
+            /** \brief Maps signed value to unsigned one so that small negative values get short varints. */
+            static inline unsigned int zigzag(int _value)
+            {
+                return (static_cast<unsigned int>(_value) << 1) ^ static_cast<unsigned int>(_value < 0 ? -1 : 0);
+            }
+
+            static inline unsigned char* write_varint(unsigned char* _buffer, unsigned long long _value)
+            {
+                while (_value >= 0x80)
+                {
+                    *_buffer++ = static_cast<unsigned char>(_value | 0x80);
+                    _value >>= 7;
+                }
+
+                *_buffer++ = static_cast<unsigned char>(_value);
+                return _buffer;
+            }
+
+        }; // END class trace_recorder.
+
+        //////////////////////////////////////////////////////////////////////////
+
+    } // END namespace util.
+
+} // END namespace slib.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif // ifdef SIGNALS_LIBRARY__RECORDING__HPP_ && !defined(SIGNALS_LIBRARY__TRACE_RECORDER__HPP_)
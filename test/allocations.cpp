@@ -0,0 +1,590 @@
+/*
+* Allocation-free hot path tests.
+*
+* This executable interposes global operator new, malloc/calloc/realloc (glibc only) and
+* shared_allocate to count every memory allocation made while counting is enabled.
+* It checks that emit, connect and disconnect do not allocate after slot::reserve() warm-up,
+* that emission into full queue of thread-affine slot does not allocate
+* and that slib::util::no_allocation_region detects allocations made by the library.
+*/
+
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <new>
+#include <stdlib.h>
+#include "slib/signals.hpp"
+#include "slib/executors.hpp"
+#include "slib/recording.hpp"
+
+#if defined(__GLIBC__)
+# include <dlfcn.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    std::atomic<bool>            COUNTING(false);
+    std::atomic<unsigned long> NEW_COUNT(0);
+    std::atomic<unsigned long> MALLOC_COUNT(0);
+    std::atomic<unsigned long> SHARED_COUNT(0);
+
+    unsigned long total_allocations()
+    {
+        return NEW_COUNT.load() + MALLOC_COUNT.load() + SHARED_COUNT.load();
+    }
+
+    /** \brief Counts every allocation made during it's lifetime. */
+    class allocation_counter final
+    {
+        unsigned long m_initial;
+
+    public:
+
+        allocation_counter() : m_initial(total_allocations())
+        {
+            COUNTING = true;
+        }
+
+        ~allocation_counter()
+        {
+            COUNTING = false;
+        }
+
+        unsigned long allocations() const
+        {
+            return total_allocations() - m_initial;
+        }
+    };
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+// Interposed allocation functions (all forms are replaced, so every new is matched by delete of the same family)
+
+#if defined(_MSC_VER)
+# define COUNTED_NOINLINE __declspec(noinline)
+#else
+# define COUNTED_NOINLINE __attribute__((noinline))
+#endif
+
+namespace {
+
+    /** \brief Counts allocation and allocates memory (returns nullptr on failure). */
+    void* counted_allocate(size_t _size, size_t _alignment = 0) noexcept
+    {
+        if (COUNTING)
+        {
+            ++NEW_COUNT;
+        }
+
+        if (_size == 0)
+        {
+            _size = 1;
+        }
+
+        if (_alignment == 0)
+        {
+            return malloc(_size);
+        }
+
+#if defined(_WIN32)
+        return nullptr; // aligned forms are not replaced on Windows
+#else
+        void* memory = nullptr;
+        return posix_memalign(&memory, _alignment < sizeof(void*) ? sizeof(void*) : _alignment, _size) == 0 ? memory : nullptr;
+#endif
+    }
+
+    void* checked_allocate(size_t _size, size_t _alignment = 0)
+    {
+        void* memory = counted_allocate(_size, _alignment);
+        if (memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        return memory;
+    }
+
+    /** \brief Releases memory of counted_allocate (it is not inlined, so compiler does not pair free() with new). */
+    COUNTED_NOINLINE void counted_release(void* _memory) noexcept
+    {
+        free(_memory);
+    }
+
+} // END namespace <noname>.
+
+void* operator new(size_t _size)
+{
+    return checked_allocate(_size);
+}
+
+void* operator new[](size_t _size)
+{
+    return checked_allocate(_size);
+}
+
+void* operator new(size_t _size, const std::nothrow_t&) noexcept
+{
+    return counted_allocate(_size);
+}
+
+void* operator new[](size_t _size, const std::nothrow_t&) noexcept
+{
+    return counted_allocate(_size);
+}
+
+void operator delete(void* _memory) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete[](void* _memory) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete(void* _memory, size_t) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete[](void* _memory, size_t) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete(void* _memory, const std::nothrow_t&) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete[](void* _memory, const std::nothrow_t&) noexcept
+{
+    counted_release(_memory);
+}
+
+#if defined(__cpp_aligned_new) && !defined(_WIN32)
+
+void* operator new(size_t _size, std::align_val_t _alignment)
+{
+    return checked_allocate(_size, static_cast<size_t>(_alignment));
+}
+
+void* operator new[](size_t _size, std::align_val_t _alignment)
+{
+    return checked_allocate(_size, static_cast<size_t>(_alignment));
+}
+
+void* operator new(size_t _size, std::align_val_t _alignment, const std::nothrow_t&) noexcept
+{
+    return counted_allocate(_size, static_cast<size_t>(_alignment));
+}
+
+void* operator new[](size_t _size, std::align_val_t _alignment, const std::nothrow_t&) noexcept
+{
+    return counted_allocate(_size, static_cast<size_t>(_alignment));
+}
+
+void operator delete(void* _memory, std::align_val_t) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete[](void* _memory, std::align_val_t) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete(void* _memory, size_t, std::align_val_t) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete[](void* _memory, size_t, std::align_val_t) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete(void* _memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete[](void* _memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    counted_release(_memory);
+}
+
+#endif // defined(__cpp_aligned_new) && !defined(_WIN32)
+
+#if defined(__GLIBC__)
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+
+    void* malloc(size_t _size)
+    {
+        if (COUNTING)
+        {
+            ++MALLOC_COUNT;
+        }
+
+        return __libc_malloc(_size);
+    }
+
+    void* calloc(size_t _number, size_t _size)
+    {
+        if (COUNTING)
+        {
+            ++MALLOC_COUNT;
+        }
+
+        return __libc_calloc(_number, _size);
+    }
+
+    void* realloc(void* _memory, size_t _size)
+    {
+        if (COUNTING)
+        {
+            ++MALLOC_COUNT;
+        }
+
+        return __libc_realloc(_memory, _size);
+    }
+
+    void* shared_allocate(size_t _bytesNumber, void* _currentMemory)
+    {
+        typedef void* (*shared_allocate_type)(size_t, void*);
+        static const shared_allocate_type original = reinterpret_cast<shared_allocate_type>(dlsym(RTLD_NEXT, "shared_allocate"));
+
+        if (COUNTING && (_currentMemory == nullptr || shared_size(_currentMemory) < _bytesNumber))
+        {
+            ++SHARED_COUNT;
+        }
+
+        return original(_bytesNumber, _currentMemory);
+    }
+}
+
+#endif // defined(__GLIBC__)
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+int STATIC_INT = 0;
+
+int static_function(int a)
+{
+    return STATIC_INT += a;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test_emit()
+{
+    // Emission must never allocate
+
+    slib::signal<int(int)> sgnl;
+    slib::signal<int(int)> sgnl2;
+    slib::slot<int(int)> slots[8];
+
+    for (auto& slt : slots)
+    {
+        slt.bind<static_function>();
+        slib::connect(sgnl, slt);
+    }
+
+    slib::connect(sgnl, sgnl2);
+    slib::connect(sgnl2, slots[0]);
+
+    allocation_counter counter;
+    slib::util::no_allocation_region region;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        sgnl(i);
+    }
+
+    if (counter.allocations() != 0 || region.allocations() != 0)
+    {
+        std::cout << "emit allocates memory. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+std::atomic<int> QUEUED_SUM(0);
+
+void queued_function(int a)
+{
+    QUEUED_SUM += a;
+}
+
+bool test_full_block_queue()
+{
+    // Emission into full queue with block policy must not allocate (invocations over capacity are preallocated)
+
+    const int connections = 64;
+    const unsigned long long capacity = 2;
+    const unsigned long long reserve = capacity + slib::util::delivery_queue<void(int)>::reserved_emitters;
+
+    slib::util::dispatcher owner;
+    slib::signal<void(int)> sgnl(true);
+    slib::slot<void(int)> slt(true);
+    slt.bind<queued_function>();
+    slt.set_affinity(&owner, capacity, slib::overflow_policy::block);
+
+    // Every connection queues one invocation, so one nested emission fills ring and overflow
+    for (int i = 0; i < connections; ++i)
+    {
+        slib::connect(sgnl, slt);
+    }
+
+    // Owner thread starts delivery only when the whole reserve is exhausted
+    std::atomic<bool> attached(false), stop(false);
+    std::thread consumer([&] {
+        owner.attach();
+        attached = true;
+        while (slt.queue_statistics().coalesced == 0)
+        {
+            std::this_thread::yield();
+        }
+        while (!stop)
+        {
+            owner.wait(std::chrono::milliseconds(1));
+        }
+    });
+
+    while (!attached)
+    {
+        std::this_thread::yield();
+    }
+
+    unsigned long allocations = 0, region_allocations = 0;
+    {
+        allocation_counter counter;
+        slib::util::no_allocation_region region;
+        sgnl(1); // waits for overflow after emission
+        allocations = counter.allocations();
+        region_allocations = region.allocations();
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (slt.queue_statistics().size != 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+
+    stop = true;
+    consumer.join();
+
+    if (allocations != 0 || region_allocations != 0)
+    {
+        std::cout << "emission into full queue allocates memory. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    const auto stats = slt.queue_statistics();
+    if (stats.waits != reserve || stats.coalesced != connections - capacity - reserve || stats.delivered != capacity + reserve || QUEUED_SUM != static_cast<int>(capacity + reserve))
+    {
+        std::cout << "full queue counters test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test_reserved_connect_disconnect()
+{
+    // Connect and disconnect must not allocate after warm-up
+
+    slib::signal<int(int)> signals[4];
+    slib::slot<int(int)> slt;
+    slt.bind<static_function>();
+    slt.reserve(4);
+
+    allocation_counter counter;
+    slib::util::no_allocation_region region;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        slib::connection handle = slib::connect(signals[0], slt);
+        handle.disconnect();
+
+        for (auto& sgnl : signals)
+        {
+            slib::connect(sgnl, slt);
+        }
+
+        for (auto& sgnl : signals)
+        {
+            sgnl(i);
+        }
+
+        slib::disconnect(signals[1], slt);
+        signals[2].disconnect(slt);
+        signals[3].disconnect();
+        slt.disconnect();
+    }
+
+    if (counter.allocations() != 0 || region.allocations() != 0)
+    {
+        std::cout << "reserved connect/disconnect allocates memory. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test_region_detects_allocations()
+{
+    // Connecting more signals than reserved must be detected by library itself
+
+    slib::signal<int(int)> signals[4];
+    slib::slot<int(int)> slt;
+
+    slib::util::no_allocation_region region;
+
+    for (auto& sgnl : signals)
+    {
+        slib::connect(sgnl, slt);
+    }
+
+    if (region.allocations() == 0)
+    {
+        std::cout << "no_allocation_region does not detect allocations. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test_region_detects_container_allocations()
+{
+    // Library-owned containers and objects (not only subscribers) must be reported too
+
+    slib::signal<int(int)> sgnl;
+    slib::slot<int(int)> slots[2];
+    slots[0].reserve(1);
+    slots[1].reserve(1);
+
+    {
+        slib::util::no_allocation_region region;
+        sgnl.set_unique_connections(slib::unique_connections::by_slot);
+        if (region.allocations() == 0)
+        {
+            std::cout << "connections index allocation is not detected. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    {
+        slib::util::no_allocation_region region;
+        sgnl.connect(slots[0], 1);
+        sgnl.connect(slots[1], 2);
+        if (region.allocations() == 0)
+        {
+            std::cout << "priority buckets allocation is not detected. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    {
+        slib::util::no_allocation_region region;
+        sgnl.enable_profiling();
+        if (region.allocations() == 0)
+        {
+            std::cout << "profiling data allocation is not detected. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test_harness_detects_allocations()
+{
+    // Make sure that interposed functions really count allocations
+
+    allocation_counter counter;
+
+    int* value = new int(1);
+    delete value;
+
+    void* memory = shared_allocate(16, nullptr);
+    shared_deallocate(memory);
+
+    if (counter.allocations() < 2)
+    {
+        std::cout << "allocation counter does not detect allocations. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+typedef bool(*pTest)();
+
+const pTest tests[] = {
+    test_harness_detects_allocations,
+    test_emit,
+    test_full_block_queue,
+    test_reserved_connect_disconnect,
+    test_region_detects_allocations,
+    test_region_detects_container_allocations
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+    std::cout << "Begin allocation testing...\n";
+
+    int result = 0;
+
+    int i = 0;
+
+    for (auto test : tests)
+    {
+        ++i;
+
+        std::cout << "--- Test" << i << ": ";
+        if (!test())
+        {
+            result = 1;
+            std::cout << "FAILED!";
+        }
+        else
+        {
+            std::cout << "OK!";
+        }
+
+        std::cout << std::endl;
+    }
+
+    std::cout << "Testing complete.\n";
+
+    return result;
+}
@@ -0,0 +1,408 @@
+/*
+* C++20 coroutine tests.
+*
+* This executable is built only if compiler supports C++20 coroutines (see CMakeLists.txt).
+* It checks co_await awaitable_signal::next(), slib::emission_stream and that awaiting does not allocate
+* (global operator new is interposed to count allocations).
+*/
+
+#include <iostream>
+#include <atomic>
+#include <new>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include "slib/coroutine.hpp"
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    std::atomic<bool>            COUNTING(false);
+    std::atomic<unsigned long> NEW_COUNT(0);
+
+    /** \brief Minimal coroutine type: starts immediately, frame is destroyed with the task. */
+    class task final
+    {
+    public:
+
+        struct promise_type
+        {
+            task get_return_object()
+            {
+                return task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { abort(); }
+        };
+
+        explicit task(std::coroutine_handle<promise_type> _handle) : m_handle(_handle)
+        {
+        }
+
+        task(task&& _other) noexcept : m_handle(_other.m_handle)
+        {
+            _other.m_handle = nullptr;
+        }
+
+        ~task()
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+        }
+
+        bool done() const
+        {
+            return m_handle.done();
+        }
+
+    private:
+
+        std::coroutine_handle<promise_type> m_handle;
+
+        task(const task&) = delete;
+        task& operator = (const task&) = delete;
+    };
+
+} // END namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+// Interposed allocation functions (all forms are replaced, so every new is matched by delete of the same family)
+
+namespace {
+
+    void* counted_allocate(size_t _size)
+    {
+        if (COUNTING)
+        {
+            ++NEW_COUNT;
+        }
+
+        void* memory = malloc(_size == 0 ? 1 : _size);
+        if (memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        return memory;
+    }
+
+    void counted_release(void* _memory) noexcept
+    {
+        free(_memory);
+    }
+
+} // END namespace <noname>.
+
+void* operator new(size_t _size)
+{
+    return counted_allocate(_size);
+}
+
+void* operator new[](size_t _size)
+{
+    return counted_allocate(_size);
+}
+
+void operator delete(void* _memory) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete[](void* _memory) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete(void* _memory, size_t) noexcept
+{
+    counted_release(_memory);
+}
+
+void operator delete[](void* _memory, size_t) noexcept
+{
+    counted_release(_memory);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+typedef slib::awaitable_signal<void(int, const std::string&)> message_signal;
+typedef slib::awaitable_signal<void(int)> int_signal;
+
+task receive_messages(const message_signal& _signal, int _number, std::vector<std::string>& _received)
+{
+    for (int i = 0; i < _number; ++i)
+    {
+        auto [id, text] = co_await _signal.next();
+        _received.push_back(std::to_string(id) + text);
+    }
+}
+
+task receive_once(const int_signal& _signal, int _id, std::vector<int>& _order)
+{
+    auto [value] = co_await _signal.next();
+    _order.push_back(_id * 100 + value);
+}
+
+task receive_stream(slib::emission_stream<void(int)>& _stream, std::vector<int>& _received)
+{
+    while (auto value = co_await _stream.next())
+    {
+        _received.push_back(std::get<0>(*value));
+    }
+}
+
+task count_emissions(const int_signal& _signal, int& _sum)
+{
+    for (;;)
+    {
+        auto [value] = co_await _signal.next();
+        _sum += value;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test_next()
+{
+    // Every emission is received once, arguments are copied into coroutine
+
+    message_signal sgnl;
+    std::vector<std::string> received;
+
+    task receiver = receive_messages(sgnl, 3, received);
+
+    if (!received.empty())
+    {
+        std::cout << "coroutine is resumed without emission. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    std::string text = "a";
+    sgnl(1, text);
+    text.assign(1, 'b'); // received copy of "a" is not changed
+    sgnl(2, text);
+    sgnl(3, "c");
+    sgnl(4, "d"); // coroutine has finished already
+
+    if (!receiver.done() || received.size() != 3 || received[0] != "1a" || received[1] != "2b" || received[2] != "3c")
+    {
+        std::cout << "wrong emissions received. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test_order_and_chains()
+{
+    // Awaiters are resumed in order of awaiting, also by flattened emission of upstream signal
+
+    slib::signal<void(int)> upstream;
+    int_signal sgnl;
+    upstream.set_flattening(true);
+    slib::connect(upstream, sgnl);
+    sgnl.disconnect(); // internal slot which resumes awaiters stays connected
+
+    std::vector<int> order;
+    task first = receive_once(sgnl, 1, order);
+    task second = receive_once(sgnl, 2, order);
+
+    upstream(7);
+
+    if (!first.done() || !second.done() || order.size() != 2 || order[0] != 107 || order[1] != 207)
+    {
+        std::cout << "wrong order of awaiters. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test_destroyed_frame()
+{
+    // Awaiter of destroyed coroutine frame is unlinked from the signal
+
+    int_signal sgnl;
+    std::vector<int> order;
+
+    {
+        task destroyed = receive_once(sgnl, 1, order);
+    }
+
+    task alive = receive_once(sgnl, 2, order);
+    sgnl(5);
+
+    if (!alive.done() || order.size() != 1 || order[0] != 205)
+    {
+        std::cout << "destroyed coroutine is resumed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    {
+        // Signal destroyed before suspended coroutine: coroutine is never resumed
+        int_signal* temporary = new int_signal();
+        task orphan = receive_once(*temporary, 3, order);
+        delete temporary;
+    }
+
+    return order.size() == 1;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test_stream()
+{
+    // Emissions are buffered by the stream until consumer takes them
+
+    slib::signal<void(int)> sgnl;
+    slib::emission_stream<void(int)> stream(sgnl, 4, slib::overflow_policy::drop_oldest);
+
+    for (int i = 0; i < 6; ++i)
+    {
+        sgnl(i);
+    }
+
+    if (stream.size() != 4 || stream.dropped() != 2)
+    {
+        std::cout << "wrong overflow handling. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    std::vector<int> received;
+    task consumer = receive_stream(stream, received);
+
+    sgnl(6);
+    sgnl(7);
+    stream.close();
+    sgnl(8); // stream is disconnected
+
+    const std::vector<int> expected = {2, 3, 4, 5, 6, 7};
+    if (!consumer.done() || !stream.closed() || received != expected)
+    {
+        std::cout << "wrong emissions generated by stream. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    slib::emission_stream<void(int)> newest(sgnl, 2, slib::overflow_policy::drop_newest);
+    slib::emission_stream<void(int)> coalesced(sgnl, 2, slib::overflow_policy::coalesce);
+    for (int i = 0; i < 4; ++i)
+    {
+        sgnl(i);
+    }
+
+    received.clear();
+    newest.close();
+    coalesced.close();
+    task newest_consumer = receive_stream(newest, received);
+    task coalesced_consumer = receive_stream(coalesced, received);
+
+    const std::vector<int> expected2 = {0, 1, 0, 3};
+    if (received != expected2 || newest.dropped() != 2 || coalesced.dropped() != 2)
+    {
+        std::cout << "wrong overflow policy. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test_no_allocations()
+{
+    // Awaiting must not allocate after coroutine frame has been created
+
+    int_signal sgnl;
+    slib::emission_stream<void(int)> stream(sgnl, 16);
+
+    int sum = 0;
+    std::vector<int> received;
+    received.reserve(1000);
+
+    task counter = count_emissions(sgnl, sum);
+    task consumer = receive_stream(stream, received);
+
+    const unsigned long initial = NEW_COUNT.load();
+    COUNTING = true;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        sgnl(1);
+    }
+
+    COUNTING = false;
+
+    if (NEW_COUNT.load() != initial)
+    {
+        std::cout << "awaiting allocates memory. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    stream.close();
+
+    if (sum != 1000 || received.size() != 1000 || !consumer.done())
+    {
+        std::cout << "wrong number of emissions received. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+typedef bool(*pTest)();
+
+const pTest tests[] = {
+    test_next,
+    test_order_and_chains,
+    test_destroyed_frame,
+    test_stream,
+    test_no_allocations
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+    std::cout << "Begin coroutine testing...\n";
+
+    int result = 0;
+
+    int i = 0;
+
+    for (auto test : tests)
+    {
+        ++i;
+
+        std::cout << "--- Test" << i << ": ";
+        if (!test())
+        {
+            result = 1;
+            std::cout << "FAILED!";
+        }
+        else
+        {
+            std::cout << "OK!";
+        }
+
+        std::cout << std::endl;
+    }
+
+    std::cout << "Testing complete.\n";
+
+    return result;
+}
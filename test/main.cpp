@@ -6,8 +6,26 @@
 #include "slib/delegate.hpp"
 #include "slib/args_list.hpp"
 #include "slib/signals.hpp"
+#include "slib/executors.hpp"
+#include "slib/recording.hpp"
+#include "slib/keyed_signal.hpp"
+#include "slib/topic_router.hpp"
+#include "slib/coalescing_signal.hpp"
+#include "slib/rate_limited_signal.hpp"
+#include "slib/timer_signal.hpp"
+#include "slib/trace_player.hpp"
+#include "slib/util/statistics_export.hpp"
 #include <chrono>
 #include <functional>
+#include <thread>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <stdio.h>
 
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -167,6 +185,2362 @@ bool test2()
     return true;
 }
 
+//////////////////////////////////////////////////////////////////////////
+
+int SLOW_SLOTS_COUNT = 0;
+
+int slow_function(int a)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    return a;
+}
+
+void on_slow_slot(const slib::slot<int(int)>&, unsigned long long)
+{
+    ++SLOW_SLOTS_COUNT;
+}
+
+bool test3()
+{
+    // Testing slot invocations profiling
+
+    std::cout << std::endl;
+
+    slib::slot<int(int)> fast_slot, slow_slot;
+    fast_slot.bind<static_function>();
+    slow_slot.bind<slow_function>();
+
+    slib::signal<int(int)> sgnl;
+    slib::connect(sgnl, fast_slot);
+    slib::connect(sgnl, slow_slot);
+
+    // Time every emission, budget is 1 millisecond
+    sgnl.enable_profiling(1, 1000000, slib::signal<int(int)>::slow_slot_handler::from_function<on_slow_slot>());
+
+    sgnl(1);
+    sgnl(2);
+    sgnl(3);
+
+    // Only slow slot must exceed the budget
+    if (SLOW_SLOTS_COUNT != 3)
+    {
+        std::cout << "SLOW_SLOTS_COUNT != 3 // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    auto slowest = sgnl.slowest(1);
+    if (slowest.size() != 1 || slowest[0].slot != &slow_slot || slowest[0].histogram.count() != 3)
+    {
+        std::cout << "slowest connection test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    if (slowest[0].histogram.percentile(50.0) < 2000000)
+    {
+        std::cout << "histogram percentile test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Time every second emission only
+    sgnl.enable_profiling(2, 1000000, slib::signal<int(int)>::slow_slot_handler::from_function<on_slow_slot>());
+
+    sgnl(4);
+    sgnl(5);
+    sgnl(6);
+
+    if (SLOW_SLOTS_COUNT != 5)
+    {
+        std::cout << "SLOW_SLOTS_COUNT != 5 // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    sgnl.disable_profiling();
+    if (sgnl.profiling() || !sgnl.slowest(10).empty())
+    {
+        std::cout << "disable_profiling test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test4()
+{
+    // Testing lock contention statistics
+
+    std::cout << std::endl;
+
+    slib::slot<int(int)> slt(true);
+    slt.bind<static_function>();
+
+    slib::signal<int(int)> sgnl(true);
+    slib::connect(sgnl, slt);
+
+    sgnl.enable_lock_statistics(true);
+
+    auto emitter = [&sgnl]()
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            sgnl(i);
+        }
+    };
+
+    std::thread thread1(emitter), thread2(emitter);
+    thread1.join();
+    thread2.join();
+
+    const auto statistics = sgnl.lock_statistics();
+    if (statistics.acquisitions != 2000 || statistics.contended > statistics.acquisitions)
+    {
+        std::cout << "lock statistics test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    std::ostringstream output;
+    slib::util::write_statistics(output, "sgnl", sgnl);
+    if (output.str().find("signal=sgnl locks acquisitions=2000") != 0)
+    {
+        std::cout << "statistics export test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Non thread-safe mutexes have nothing to measure
+    slib::signal<int(int)> sgnl2;
+    sgnl2.enable_lock_statistics(true);
+    sgnl2(1);
+    if (sgnl2.lock_statistics().acquisitions != 0)
+    {
+        std::cout << "lock statistics test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+unsigned int REPLAYED = 0;
+
+void count_replayed(const unsigned char*, unsigned int _size)
+{
+    if (_size == sizeof(int))
+    {
+        ++REPLAYED;
+    }
+}
+
+bool test5()
+{
+    // Testing emission trace recording and replay
+
+    std::cout << std::endl;
+
+    const char* filename = "slib_test5.trace";
+
+    {
+        slib::slot<int(int)> slt, slt2;
+        slt.bind<static_function>();
+        slt2.bind<static_function>();
+
+        // Connections and signal-to-signal link exist before recording starts
+        slib::signal<int(int)> sgnl, sgnl2;
+        slib::connect(sgnl, slt);
+        sgnl.connect(sgnl2.to_slot(), 5);
+        slib::connect(sgnl2, slt2);
+
+        slib::util::trace_recorder recorder(filename);
+        if (!recorder.is_open())
+        {
+            std::cout << "can not open trace file. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        sgnl.record(&recorder, "first"); // sgnl2 is registered too
+
+        sgnl(1);
+        sgnl(2);
+        sgnl.block();
+        sgnl(3); // blocked emission is not recorded
+        sgnl.unblock();
+        slib::disconnect(sgnl, slt);
+        sgnl(4);
+
+        sgnl.record(nullptr);
+        sgnl2.record(nullptr);
+    }
+
+    std::ifstream file(filename, std::ios::binary);
+    const std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    remove(filename);
+
+    if (data.size() < 9 || std::string(data.begin(), data.begin() + 8) != "SLIBTRC2")
+    {
+        std::cout << "trace header test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Count records: 2 signals, 3 connects, 1 disconnect and 3 emits
+    size_t position = 8;
+    unsigned int counts[5] = {0, 0, 0, 0, 0};
+    unsigned int arguments = 0;
+    while (position < data.size())
+    {
+        const unsigned char type = data[position++];
+        if (type == 0 || type > 4)
+        {
+            std::cout << "trace record type test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        ++counts[type];
+
+        unsigned long long values[4] = {0, 0, 0, 0};
+        const unsigned int varints = type == slib::util::trace_recorder::record_disconnect ? 3 : (type == slib::util::trace_recorder::record_emit ? 2 : 4);
+        for (unsigned int i = 0; i < varints; ++i)
+        {
+            unsigned long long value = 0;
+            for (unsigned int shift = 0; position < data.size(); shift += 7)
+            {
+                const unsigned char byte = data[position++];
+                value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    break;
+                }
+            }
+
+            values[i] = value;
+        }
+
+        if (type == slib::util::trace_recorder::record_signal)
+        {
+            arguments = static_cast<unsigned int>(values[2]);
+            position += static_cast<size_t>(values[3]);
+        }
+        else if (type == slib::util::trace_recorder::record_emit)
+        {
+            position += arguments;
+        }
+    }
+
+    if (counts[1] != 2 || counts[2] != 3 || counts[3] != 1 || counts[4] != 3 || arguments != sizeof(int))
+    {
+        std::cout << "trace records test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Replay must rebuild the graph: 2 + 2 invocations by the first two emissions and 1 by the last one
+    slib::trace_player player(slib::trace_player::delegate_type::from_function<count_replayed>());
+    if (!player.parse(data.data(), data.size()))
+    {
+        std::cout << "trace parsing failed: " << player.error() << ". // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    bool link_found = false;
+    for (const slib::trace_player::event& e : player.events())
+    {
+        link_found = link_found || (e.type == slib::util::trace_recorder::record_connect && e.target != 0 && e.priority == 5);
+    }
+
+    for (unsigned int loop = 0; loop < 2; ++loop)
+    {
+        REPLAYED = 0;
+        if (player.replay() != 3 || REPLAYED != 5 || !link_found)
+        {
+            std::cout << "trace replay test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+int COUNTER = 0;
+
+int counter_function(int a)
+{
+    return COUNTER += a;
+}
+
+int throwing_function(int a)
+{
+    throw a;
+}
+
+bool test6()
+{
+    // Testing connection handles
+
+    std::cout << std::endl;
+
+    slib::slot<int(int)> slt;
+    slt.bind<counter_function>();
+    slt.reserve(4);
+
+    slib::signal<int(int)> signals[4];
+    slib::connection connections[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        connections[i] = slib::connect(signals[i], slt);
+    }
+
+    // Disconnect exactly one connection
+    connections[2].disconnect();
+    if (connections[2].connected() || !connections[1].connected() || signals[2].connected() || !signals[3].connected())
+    {
+        std::cout << "connection disconnect test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    COUNTER = 0;
+    for (auto& sgnl : signals)
+    {
+        sgnl(1);
+    }
+
+    if (COUNTER != 3)
+    {
+        std::cout << "COUNTER != 3 // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Old handle must not disconnect new connection which reuses the same subscriber object
+    slib::connection old_connection = connections[1];
+    connections[1].disconnect();
+    connections[1] = slib::connect(signals[1], slt);
+    old_connection.disconnect();
+    if (!connections[1].connected() || !signals[1].connected())
+    {
+        std::cout << "stale connection test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Connection handle becomes invalid if signal has disconnected all slots
+    signals[0].disconnect();
+    if (connections[0].connected())
+    {
+        std::cout << "connection state test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Scoped connection disconnects automatically
+    {
+        slib::scoped_connection scoped = slib::connect(signals[2], slt);
+        if (!signals[2].connected())
+        {
+            std::cout << "scoped connection test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    if (signals[2].connected())
+    {
+        std::cout << "scoped connection test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Scoped connection may outlive it's slot (members are destroyed in reverse order)
+    struct receiver
+    {
+        slib::scoped_connection connection;
+        slib::slot<int(int)> slt;
+    };
+
+    {
+        std::unique_ptr<receiver> owner(new receiver());
+        owner->slt.bind<counter_function>();
+        owner->connection = slib::connect(signals[3], owner->slt);
+        slib::connection copy = owner->connection.get();
+        owner.reset();
+
+        // subscriber's memory is reused by another slot, but old handle does not match it
+        slib::slot<int(int)> other;
+        other.bind<counter_function>();
+        slib::connect(signals[3], other);
+        copy.disconnect();
+        if (copy.connected() || !other.connected())
+        {
+            std::cout << "connection after slot destruction test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    // Handles of thread-safe slots are used while another thread destroys the slots
+    {
+        const int number = 64;
+        slib::connection_group group;
+        slib::signal<int(int)> shared(true);
+
+        for (int round = 0; round < 20; ++round)
+        {
+            std::vector<std::unique_ptr<slib::slot<int(int)> > > receivers;
+            std::vector<slib::connection> handles;
+            for (int i = 0; i < number; ++i)
+            {
+                receivers.emplace_back(new slib::slot<int(int)>(true));
+                receivers.back()->bind<counter_function>();
+                handles.push_back(slib::connect(shared, *receivers.back()));
+            }
+
+            std::atomic<bool> started(false), destroyed(false);
+            std::thread user([&handles, &group, &started, &destroyed]()
+            {
+                started = true;
+                while (!destroyed)
+                {
+                    for (auto& handle : handles)
+                    {
+                        if (handle.connected())
+                        {
+                            if (handle.blocked())
+                            {
+                                handle.unblock();
+                            }
+                            else
+                            {
+                                handle.block();
+                            }
+
+                            group.add(handle);
+                        }
+                    }
+                }
+
+                for (size_t i = 0; i < handles.size(); i += 2)
+                {
+                    handles[i].disconnect();
+                }
+            });
+
+            while (!started);
+            receivers.clear();
+            destroyed = true;
+            user.join();
+
+            for (auto& handle : handles)
+            {
+                if (handle.connected())
+                {
+                    std::cout << "connection used during slot destruction test failed. // LINE = " << __LINE__ << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        if (shared.connected())
+        {
+            std::cout << "connection used during slot destruction test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test7()
+{
+    // Testing duplicate connections detection
+
+    std::cout << std::endl;
+
+    slib::signal<int(int)> sgnl;
+    slib::slot<int(int)> slots[40];
+    for (auto& slt : slots)
+    {
+        slt.bind<counter_function>();
+    }
+
+    // Duplicates are allowed by default
+    slib::connect(sgnl, slots[0]);
+    slib::connect(sgnl, slots[0]);
+    COUNTER = 0;
+    sgnl(1);
+    if (COUNTER != 2)
+    {
+        std::cout << "COUNTER != 2 // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    sgnl.disconnect();
+    sgnl.set_unique_connections(slib::unique_connections::by_slot);
+
+    // Enough slots to make index grow
+    for (auto& slt : slots)
+    {
+        if (slib::connect(sgnl, slt).empty() || !slib::connect(sgnl, slt).empty())
+        {
+            std::cout << "by_slot connect test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    COUNTER = 0;
+    sgnl(1);
+    if (COUNTER != 40)
+    {
+        std::cout << "COUNTER != 40 // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Disconnected slot can be connected again
+    sgnl.disconnect(slots[7]);
+    if (slots[7].connected() || slib::connect(sgnl, slots[7]).empty())
+    {
+        std::cout << "by_slot disconnect test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Removing every other slot must keep the rest of the index reachable
+    for (size_t i = 0; i < 40; i += 2)
+    {
+        sgnl.disconnect(slots[i]);
+    }
+
+    for (size_t i = 0; i < 40; ++i)
+    {
+        if (slib::connect(sgnl, slots[i]).empty() != (i % 2 != 0))
+        {
+            std::cout << "by_slot reconnect test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    COUNTER = 0;
+    sgnl(1);
+    if (COUNTER != 40)
+    {
+        std::cout << "COUNTER != 40 // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Different slots binded to the same function are duplicates by delegate
+    sgnl.set_unique_connections(slib::unique_connections::by_delegate);
+    sgnl.disconnect();
+    if (slib::connect(sgnl, slots[0]).empty() || !slib::connect(sgnl, slots[1]).empty() || slots[1].connected())
+    {
+        std::cout << "by_delegate connect test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    COUNTER = 0;
+    sgnl(1);
+    if (COUNTER != 1 || sgnl.uniqueness() != slib::unique_connections::by_delegate)
+    {
+        std::cout << "by_delegate emit test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+std::vector<int> ORDER;
+
+struct order_receiver
+{
+    int index;
+
+    int receive(int)
+    {
+        ORDER.push_back(index);
+        return index;
+    }
+};
+
+bool test8()
+{
+    // Testing bulk connect and disconnect
+
+    std::cout << std::endl;
+
+    const int number = 100;
+    order_receiver receivers[number];
+    slib::slot<int(int)> slots[number];
+    for (int i = 0; i < number; ++i)
+    {
+        receivers[i].index = i;
+        slots[i].BIND(order_receiver, &receivers[i], receive);
+    }
+
+    // Bulk connect must give the same emission order as sequential connect
+    slib::signal<int(int)> sequential, bulk;
+    for (auto& slt : slots)
+    {
+        sequential.connect(slt);
+    }
+
+    slib::connection connections[number];
+    if (bulk.connect(slots, slots + number, connections) != number)
+    {
+        std::cout << "bulk connect test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    ORDER.clear();
+    sequential(0);
+    const std::vector<int> expected = ORDER;
+
+    ORDER.clear();
+    bulk(0);
+    if (ORDER != expected || static_cast<int>(ORDER.size()) != number)
+    {
+        std::cout << "bulk connect order test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    connections[5].disconnect();
+    ORDER.clear();
+    bulk(0);
+    if (static_cast<int>(ORDER.size()) != number - 1)
+    {
+        std::cout << "bulk connection handle test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Bulk disconnect removes every connection of specified slots
+    sequential.connect(slots[1]);
+    if (slib::disconnect_all(sequential, slots[0], slots[1], slots[2]) != 4 || slots[0].connected() != true)
+    {
+        std::cout << "disconnect_all test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    std::vector<slib::slot<int(int)>*> range;
+    for (int i = 10; i < number; ++i)
+    {
+        range.push_back(&slots[i]);
+    }
+
+    if (slib::disconnect_range(bulk, range.begin(), range.end()) != static_cast<size_t>(number - 10))
+    {
+        std::cout << "disconnect_range test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    ORDER.clear();
+    bulk(0);
+    if (ORDER.size() != 9)
+    {
+        std::cout << "disconnect_range emit test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Range connected with greater priority is invoked before previously connected slots
+    if (slib::connect_range(bulk, range.begin(), range.end(), nullptr, 1) != static_cast<size_t>(number - 10))
+    {
+        std::cout << "connect_range test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    ORDER.clear();
+    bulk(0);
+    if (static_cast<int>(ORDER.size()) != number - 1 || ORDER.front() != 10 || ORDER.back() != 9)
+    {
+        std::cout << "connect_range priority test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Duplicates are rejected inside one batch too
+    slib::signal<int(int)> unique;
+    unique.set_unique_connections(slib::unique_connections::by_slot);
+    if (slib::connect_all(unique, slots[0], slots[1], slots[0]) != 2)
+    {
+        std::cout << "connect_all duplicates test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test9()
+{
+    // Testing priority-ordered emission
+
+    std::cout << std::endl;
+
+    const int number = 8;
+    order_receiver receivers[number];
+    slib::slot<int(int)> slots[number];
+    for (int i = 0; i < number; ++i)
+    {
+        receivers[i].index = i;
+        slots[i].BIND(order_receiver, &receivers[i], receive);
+    }
+
+    // Slots with equal priority are invoked in order of connection
+    slib::signal<int(int)> sgnl;
+    slib::connect(sgnl, slots[0]);
+    slib::connect(sgnl, slots[1]);
+    slib::connect(sgnl, slots[2], 10);
+    slib::connect(sgnl, slots[3], -5);
+    slib::connect(sgnl, slots[4], 10);
+    slib::connection middle = slib::connect(sgnl, slots[5], 3);
+    slib::connect(sgnl, slots[6]);
+
+    ORDER.clear();
+    sgnl(0);
+    if (ORDER != std::vector<int>({2, 4, 5, 0, 1, 6, 3}))
+    {
+        std::cout << "priority order test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Removing the last slot of the bucket must keep the order of new connections
+    middle.disconnect();
+    slots[4].disconnect();
+    slib::connect(sgnl, slots[7], 10);
+    slib::connect(sgnl, slots[5], 3);
+    slots[3].disconnect();
+    slib::connect(sgnl, slots[3], -5);
+
+    ORDER.clear();
+    sgnl(0);
+    if (ORDER != std::vector<int>({2, 7, 5, 0, 1, 6, 3}))
+    {
+        std::cout << "priority order after disconnect test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Signal without slots forgets priorities
+    sgnl.disconnect();
+    slib::connect(sgnl, slots[1]);
+    slib::connect(sgnl, slots[0]);
+
+    ORDER.clear();
+    sgnl(0);
+    if (ORDER != std::vector<int>({1, 0}))
+    {
+        std::cout << "default order test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test10()
+{
+    // Testing keyed signal
+
+    std::cout << std::endl;
+
+    slib::keyed_signal<std::string, int(int)> sgnl;
+    slib::slot<int(int)> slots[3];
+    for (auto& slt : slots)
+    {
+        slt.bind<counter_function>();
+    }
+
+    sgnl.connect("eur", slots[0]);
+    sgnl.connect("eur", slots[1]);
+    sgnl.connect("usd", slots[2]);
+
+    COUNTER = 0;
+    sgnl("eur", 1);
+    sgnl("usd", 10);
+    sgnl("jpy", 100);
+    if (COUNTER != 12 || !sgnl.connected("usd") || sgnl.connected("jpy") || sgnl.find("jpy") != nullptr)
+    {
+        std::cout << "keyed emit test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Signal of a key is kept after disconnect until compact()
+    sgnl.disconnect("eur", slots[0]);
+    slots[2].disconnect();
+
+    COUNTER = 0;
+    sgnl("eur", 1);
+    sgnl("usd", 10);
+    if (COUNTER != 1 || sgnl.keys() != 2)
+    {
+        std::cout << "keyed disconnect test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    sgnl.compact();
+    if (sgnl.keys() != 1 || !sgnl.connected("eur"))
+    {
+        std::cout << "keyed compact test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test11()
+{
+    // Testing topic router
+
+    std::cout << std::endl;
+
+    slib::topic_router<int(int)> router;
+    slib::slot<int(int)> exact, single, rest;
+    exact.bind<counter_function>();
+    single.bind<counter_function>();
+    rest.bind<counter_function>();
+
+    router.subscribe("orders.eu.new", exact);
+    router.subscribe("orders.*.new", single);
+
+    COUNTER = 0;
+    router.publish("orders.eu.new", 1);
+    router.publish("orders.us.new", 10);
+    router.publish("orders.us.old", 100);
+    if (COUNTER != 12 || router.cached_topics() != 3)
+    {
+        std::cout << "topic router publish test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // New pattern must be connected to already cached topics
+    router.subscribe("orders.#", rest);
+
+    COUNTER = 0;
+    router.publish("orders.eu.new", 1);
+    router.publish("orders.us.old", 100);
+    router.publish("orders", 1000);
+    router.publish("trades.eu.new", 10000);
+    if (COUNTER != 1 + 1 + 1 + 100 + 1000)
+    {
+        std::cout << "topic router wildcard test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Removed pattern must be disconnected from cached topics
+    router.unsubscribe("orders.*.new");
+    router.unsubscribe("orders.#", rest);
+
+    COUNTER = 0;
+    router.publish("orders.eu.new", 1);
+    router.publish("orders.us.new", 10);
+    if (COUNTER != 1)
+    {
+        std::cout << "topic router unsubscribe test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    if (!slib::topic_router<int(int)>::matches("a.*.c.#", "a.b.c") || slib::topic_router<int(int)>::matches("a.*", "a.b.c"))
+    {
+        std::cout << "topic matching test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // "#" may be only the last segment of pattern
+    if (slib::topic_router<int(int)>::valid("a.#.c") || slib::topic_router<int(int)>::matches("a.#.c", "a.b.c") || !slib::topic_router<int(int)>::valid("a.*.#"))
+    {
+        std::cout << "topic pattern validation test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Removed pattern can be subscribed again (its trie nodes have been pruned)
+    router.subscribe("orders.*.new", single);
+    COUNTER = 0;
+    router.publish("orders.us.new", 10);
+    if (COUNTER != 10)
+    {
+        std::cout << "topic router resubscribe test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Topic cache is bounded
+    slib::topic_router<int(int)> bounded(false, 2);
+    bounded.subscribe("t.*", single);
+    COUNTER = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        bounded.publish("t.hot", 1);
+        bounded.publish("t." + std::to_string(i), 10);
+    }
+
+    if (COUNTER != 110 || bounded.cached_topics() > 2)
+    {
+        std::cout << "topic router cache bound test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test12()
+{
+    // Testing flattened signal-to-signal chains
+
+    std::cout << std::endl;
+
+    slib::signal<int(int)> root, middle, leaf_signal;
+    slib::slot<int(int)> slots[4];
+    for (auto& slt : slots)
+    {
+        slt.bind<counter_function>();
+    }
+
+    root.set_flattening(true);
+    slib::connect(root, slots[0]);
+    slib::connect(root, middle);
+    slib::connect(middle, slots[1]);
+    slib::connect(middle, leaf_signal);
+    slib::connect(leaf_signal, slots[2]);
+
+    COUNTER = 0;
+    root(1);
+    if (COUNTER != 3)
+    {
+        std::cout << "flattened emit test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Any change in the chain must invalidate root's cache
+    slib::connect(leaf_signal, slots[3]);
+    COUNTER = 0;
+    root(1);
+    if (COUNTER != 4)
+    {
+        std::cout << "flattened cache invalidation test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    slib::disconnect(middle, slots[1]);
+    leaf_signal.disconnect(slots[2]);
+    COUNTER = 0;
+    root(1);
+    if (COUNTER != 2)
+    {
+        std::cout << "flattened cache invalidation test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Destroyed signal of the chain must disappear from cache
+    {
+        slib::signal<int(int)> temporary;
+        slib::connect(middle, temporary);
+        slib::connect(temporary, slots[1]);
+        COUNTER = 0;
+        root(1);
+        if (COUNTER != 3)
+        {
+            std::cout << "flattened temporary signal test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    COUNTER = 0;
+    root(1);
+    if (COUNTER != 2)
+    {
+        std::cout << "flattened destroyed signal test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Changes of unrelated chains must not affect the cache, changes of downstream signals must
+    slib::signal<int(int)> other, other_leaf;
+    slib::connect(other, other_leaf);
+    other_leaf.block();
+    leaf_signal.block();
+    COUNTER = 0;
+    root(1);
+    leaf_signal.unblock();
+    other_leaf.unblock();
+    root(1);
+    if (COUNTER != 3)
+    {
+        std::cout << "flattened blocked signal test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test13()
+{
+    // Testing cycle detection in signal-to-signal connections
+
+    std::cout << std::endl;
+
+    slib::signal<int(int)> a, b, c;
+    slib::slot<int(int)> slt;
+    slt.bind<counter_function>();
+
+    slib::connect(a, b);
+    slib::connect(b, c);
+    slib::connect(c, slt);
+
+    // c -> a and a -> a would create cycles
+    if (!slib::connect(c, a).empty() || !slib::connect(a, a).empty() || !a.connect(slt).connected())
+    {
+        std::cout << "cycle reject test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    COUNTER = 0;
+    a(1);
+    if (COUNTER != 2)
+    {
+        std::cout << "COUNTER != 2 // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Allowed cycle is traversed at most once
+    c.set_cycle_policy(slib::cycle_policy::allow_guarded);
+    if (slib::connect(c, a).empty())
+    {
+        std::cout << "cycle allow test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    COUNTER = 0;
+    a(1);
+    if (COUNTER != 4)
+    {
+        std::cout << "guarded cycle emit test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Guard is released by exception thrown from a slot inside guarded cycle
+    slib::slot<int(int)> thrower;
+    thrower.bind<throwing_function>();
+    c.connect(thrower);
+    bool thrown = false;
+    try
+    {
+        a(1);
+    }
+    catch (int)
+    {
+        thrown = true;
+    }
+
+    c.disconnect(thrower);
+    COUNTER = 0;
+    a(1);
+    if (!thrown || COUNTER != 4)
+    {
+        std::cout << "guarded cycle exception test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Disconnection of guarded connection removes the guard, and a cycle can not be closed again without it
+    c.set_cycle_policy(slib::cycle_policy::reject);
+    c.disconnect(a.to_slot());
+    COUNTER = 0;
+    a(1);
+    if (COUNTER != 2 || !slib::connect(c, a).empty())
+    {
+        std::cout << "guarded cycle disconnect test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Removed connection does not close a cycle any more
+    a.disconnect(b.to_slot());
+    if (slib::connect(c, a).empty() || !slib::connect(a, b).empty())
+    {
+        std::cout << "cycle after disconnect test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Connections against current order of signals: w -> x reorders signals, y -> z closes a cycle
+    slib::signal<int(int)> x, y, z, w;
+    slib::connect(x, y);
+    slib::connect(z, w);
+    if (slib::connect(w, x).empty() || !slib::connect(y, z).empty() || slib::connect(z, y).empty())
+    {
+        std::cout << "cycle reorder test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test14()
+{
+    // Testing blocking of signals and connections
+
+    std::cout << std::endl;
+
+    slib::signal<int(int)> sgnl, chained;
+    slib::slot<int(int)> slots[3];
+    for (auto& slt : slots)
+    {
+        slt.bind<counter_function>();
+    }
+
+    slib::connection first = slib::connect(sgnl, slots[0]);
+    slib::connect(sgnl, slots[1]);
+    slib::connect(sgnl, chained);
+    slib::connect(chained, slots[2]);
+
+    // Blocked signal does nothing, blocks are counted
+    COUNTER = 0;
+    {
+        slib::scoped_block<slib::signal<int(int)> > block(sgnl);
+        sgnl.block();
+        sgnl(1);
+        sgnl.unblock();
+        sgnl(1);
+    }
+    sgnl(10);
+    if (COUNTER != 30 || sgnl.blocked())
+    {
+        std::cout << "signal block test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Blocked connection is skipped, blocked downstream signal too
+    first.block();
+    chained.block();
+    COUNTER = 0;
+    sgnl(1);
+    if (COUNTER != 1 || !first.blocked() || !first.connected())
+    {
+        std::cout << "connection block test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // The same with flattened emission
+    sgnl.set_flattening(true);
+    COUNTER = 0;
+    sgnl(1);
+    chained.unblock();
+    sgnl(10);
+    first.unblock();
+    sgnl(100);
+    if (COUNTER != 1 + 20 + 300)
+    {
+        std::cout << "flattened block test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool test15()
+{
+    // Testing connection groups
+
+    std::cout << std::endl;
+
+    slib::signal<int(int)> sgnl1;
+    slib::signal<void(double)> sgnl2;
+    slib::slot<int(int)> slots[3];
+    slib::slot<void(double)> double_slot;
+    for (auto& slt : slots)
+    {
+        slt.bind<counter_function>();
+    }
+
+    slib::connection outside = slib::connect(sgnl1, slots[2]);
+
+    {
+        slib::connection_group group;
+        group.connect(sgnl1, slots[0]);
+        slib::connection second = group.connect(sgnl1, slots[1]);
+        group.connect(sgnl2, double_slot);
+        if (group.size() != 3)
+        {
+            std::cout << "group size test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        // Connection disconnected by handle leaves the group
+        second.disconnect();
+        if (group.size() != 2)
+        {
+            std::cout << "group leave test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        // Blocking of group does not touch other connections
+        group.block();
+        COUNTER = 0;
+        sgnl1(1);
+        group.unblock();
+        sgnl1(10);
+        if (COUNTER != 1 + 20)
+        {
+            std::cout << "group block test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        // Group-wide disconnect
+        group.disconnect();
+        if (!group.empty() || sgnl2.connected() || slots[0].connected() || !outside.connected())
+        {
+            std::cout << "group disconnect test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        // Destructor disconnects the rest
+        group.add(slib::connect(sgnl1, slots[1]));
+    }
+
+    {
+        // Groups larger than one batch
+        std::vector<slib::slot<int(int)> > many(slib::connection_group::batch_size * 2 + 3);
+        slib::connection_group group;
+        for (auto& slt : many)
+        {
+            slt.bind<counter_function>();
+            group.connect(sgnl1, slt);
+        }
+
+        group.block();
+        COUNTER = 0;
+        sgnl1(1);
+        group.unblock();
+        sgnl1(1);
+        if (COUNTER != 1 + static_cast<int>(many.size()) + 1)
+        {
+            std::cout << "large group block test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        group.disconnect();
+        for (auto& slt : many)
+        {
+            if (slt.connected())
+            {
+                std::cout << "large group disconnect test failed. // LINE = " << __LINE__ << std::endl;
+                return false;
+            }
+        }
+    }
+
+    if (slots[1].connected() || !slots[2].connected())
+    {
+        std::cout << "group destructor test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+struct reentrant_receiver
+{
+    int                                           index;
+    const slib::signal<int(int)>*                  sgnl;
+    slib::slot<int(int)>*                          self;
+    slib::slot<int(int)>*                        victim;
+    std::unique_ptr<slib::slot<int(int)> >* destroyed;
+
+    int receive(int)
+    {
+        ORDER.push_back(index);
+
+        if (self != nullptr)
+        {
+            sgnl->disconnect(*self);
+        }
+
+        if (victim != nullptr)
+        {
+            sgnl->disconnect(*victim);
+        }
+
+        if (destroyed != nullptr)
+        {
+            destroyed->reset();
+        }
+
+        return index;
+    }
+};
+
+struct signal_destroyer
+{
+    std::unique_ptr<slib::signal<int(int)> >* sgnl;
+    bool                                    nested;
+
+    int receive(int _value)
+    {
+        ORDER.push_back(-1);
+
+        if (nested)
+        {
+            nested = false;
+            (**sgnl)(_value); // signal is destroyed by the nested emission
+        }
+        else
+        {
+            sgnl->reset();
+        }
+
+        return 0;
+    }
+};
+
+bool test16()
+{
+    // Testing disconnection and destruction of slots and signals from inside emission
+
+    std::cout << std::endl;
+
+    const int number = 6;
+
+    for (int mode = 0; mode < 4; ++mode)
+    {
+        const bool threadsafe = mode == 1;
+
+        slib::signal<int(int)> sgnl(threadsafe), chained(threadsafe);
+        slib::connect(sgnl, chained);
+        if (mode == 2)
+        {
+            sgnl.set_flattening(true);
+        }
+        else if (mode == 3)
+        {
+            chained.enable_profiling();
+        }
+
+        reentrant_receiver receivers[number];
+        slib::slot<int(int)> slots[number];
+        std::unique_ptr<slib::slot<int(int)> > heap_slot(new slib::slot<int(int)>(threadsafe));
+        for (int i = 0; i < number; ++i)
+        {
+            receivers[i] = reentrant_receiver {i, &chained, nullptr, nullptr, nullptr};
+            slib::slot<int(int)>& slt = i == 4 ? *heap_slot : slots[i];
+            slt.set_threadsafe(threadsafe);
+            slt.BIND(reentrant_receiver, &receivers[i], receive);
+            slib::connect(chained, slt);
+        }
+
+        receivers[0].self = &slots[0];      // disconnects itself
+        receivers[1].victim = &slots[2];    // disconnects the next slot
+        receivers[3].destroyed = &heap_slot; // destroys the next slot
+
+        ORDER.clear();
+        sgnl(1);
+        sgnl(1);
+
+        const std::vector<int> expected = {0, 1, 3, 5, 1, 3, 5};
+        if (ORDER != expected)
+        {
+            std::cout << "reentrant disconnect test failed for mode " << mode << ". // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        // Slot destroys the emitting signal (directly or from nested emission of the same signal)
+        for (int nested = 0; nested < 2; ++nested)
+        {
+            std::unique_ptr<slib::signal<int(int)> > victim(new slib::signal<int(int)>(threadsafe));
+            slib::signal<int(int)> downstream(threadsafe);
+            signal_destroyer destroyer = {&victim, nested != 0};
+
+            slib::slot<int(int)> before, destroying, after;
+            before.BIND(reentrant_receiver, &receivers[0], receive);
+            destroying.BIND(signal_destroyer, &destroyer, receive);
+            after.BIND(reentrant_receiver, &receivers[5], receive);
+            receivers[0].self = nullptr;
+
+            slib::connect(*victim, before);
+            slib::connect(*victim, downstream);
+            slib::connect(downstream, destroying);
+            slib::connect(*victim, after);
+            if (mode == 2)
+            {
+                victim->set_flattening(true);
+            }
+            else if (mode == 3)
+            {
+                victim->enable_profiling();
+            }
+
+            ORDER.clear();
+            (*victim)(1);
+
+            const std::vector<int> destroyed = nested != 0 ? std::vector<int> {0, -1, 0, -1} : std::vector<int> {0, -1};
+            if (victim || ORDER != destroyed || before.connected() || downstream.to_slot().connected() || after.connected())
+            {
+                std::cout << "signal destruction from slot test failed for mode " << mode << ". // LINE = " << __LINE__ << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+std::atomic<int> PARALLEL_SUM(0);
+
+void parallel_receiver(std::string _text, int _value)
+{
+    PARALLEL_SUM += static_cast<int>(_text.size()) * _value;
+}
+
+bool test17()
+{
+    // Testing parallel emission
+
+    std::cout << std::endl;
+
+    const int number = 100;
+
+    slib::util::thread_pool pool(3);
+    slib::signal<void(std::string, int)> sgnl(true);
+    slib::slot<void(std::string, int)> slots[number];
+    slib::connection handles[number];
+    for (int i = 0; i < number; ++i)
+    {
+        slots[i].set_threadsafe(true);
+        slots[i].bind<parallel_receiver>();
+        handles[i] = slib::connect(sgnl, slots[i]);
+    }
+
+    // Every slot gets the same (not moved) argument
+    PARALLEL_SUM = 0;
+    sgnl.emit_parallel(pool, std::string("abc"), 2);
+    if (PARALLEL_SUM != number * 3 * 2)
+    {
+        std::cout << "parallel emit test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Blocked connections and blocked signal are respected
+    handles[7].block();
+    handles[42].block();
+    PARALLEL_SUM = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        sgnl.emit_parallel(pool, std::string("a"), 1);
+    }
+    sgnl.block();
+    sgnl.emit_parallel(pool, std::string("a"), 1);
+    sgnl.unblock();
+    if (PARALLEL_SUM != (number - 2) * 10)
+    {
+        std::cout << "parallel block test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Less slots than pool threads
+    slib::signal<void(std::string, int)> small_signal(true);
+    slib::connect(small_signal, slots[0]);
+    PARALLEL_SUM = 0;
+    small_signal.emit_parallel(pool, std::string("a"), 5);
+    if (PARALLEL_SUM != 5)
+    {
+        std::cout << "parallel small emit test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+slib::util::thread_pool* SPAWN_POOL = nullptr;
+std::atomic<int> SPAWN_LEAVES(0);
+
+void spawn_tasks(int _depth)
+{
+    if (_depth == 0)
+    {
+        ++SPAWN_LEAVES;
+        return;
+    }
+
+    // tasks posted by workers go to their own deques and are stolen by other workers
+    slib::delegate<void(int)> child;
+    child.bind<spawn_tasks>();
+    SPAWN_POOL->post(child, _depth - 1);
+    SPAWN_POOL->post(child, _depth - 1);
+}
+
+template <class T>
+bool wait_for(const std::atomic<T>& _value, T _expected)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (_value != _expected)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+
+        std::this_thread::yield();
+    }
+
+    return true;
+}
+
+bool test18()
+{
+    // Testing asynchronous emission and work-stealing pool
+
+    std::cout << std::endl;
+
+    const int number = 10;
+    const int emits = 100;
+
+    slib::util::thread_pool pool(2);
+    slib::signal<void(std::string, int)> sgnl(true);
+    slib::slot<void(std::string, int)> slots[number];
+    for (auto& slt : slots)
+    {
+        slt.set_threadsafe(true);
+        slt.bind<parallel_receiver>();
+        slib::connect(sgnl, slt);
+    }
+
+    PARALLEL_SUM = 0;
+    for (int i = 0; i < emits; ++i)
+    {
+        sgnl.emit_async(pool, std::string("ab"), 1);
+    }
+
+    if (!wait_for(PARALLEL_SUM, number * emits * 2))
+    {
+        std::cout << "async emit test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Recursive task spawning
+    SPAWN_POOL = &pool;
+    SPAWN_LEAVES = 0;
+    slib::delegate<void(int)> root;
+    root.bind<spawn_tasks>();
+    pool.post(root, 12);
+
+    if (!wait_for(SPAWN_LEAVES, 1 << 12))
+    {
+        std::cout << "work stealing test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+std::vector<std::thread::id> AFFINE_THREADS;
+std::atomic<int> AFFINE_PLAIN_SUM(0);
+
+void affine_receiver(int)
+{
+    AFFINE_THREADS.push_back(std::this_thread::get_id());
+}
+
+void affine_plain_receiver(int _value)
+{
+    AFFINE_PLAIN_SUM += _value;
+}
+
+bool test19()
+{
+    // Testing thread-affine slots
+
+    std::cout << std::endl;
+
+    slib::util::dispatcher owner;
+    slib::signal<void(int)> sgnl(true);
+    slib::slot<void(int)> affine(true), plain(true);
+    affine.bind<affine_receiver>();
+    plain.bind<affine_plain_receiver>();
+    affine.set_affinity(&owner);
+    slib::connect(sgnl, affine);
+    slib::connect(sgnl, plain);
+
+    // Emission on the owner thread invokes slot directly
+    AFFINE_THREADS.clear();
+    AFFINE_PLAIN_SUM = 0;
+    sgnl(1);
+    if (AFFINE_THREADS.size() != 1 || !owner.empty())
+    {
+        std::cout << "affine direct invocation test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Emission on another thread queues invocation, ordinary slot is invoked immediately
+    std::thread emitter([&sgnl] { sgnl(2); sgnl(3); });
+    emitter.join();
+    if (AFFINE_THREADS.size() != 1 || AFFINE_PLAIN_SUM != 6 || owner.process() != 2 || AFFINE_THREADS.size() != 3)
+    {
+        std::cout << "affine queued invocation test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    for (auto id : AFFINE_THREADS)
+    {
+        if (id != std::this_thread::get_id())
+        {
+            std::cout << "affine owner thread test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    // Affinity is removed from existing connection
+    affine.set_affinity(nullptr);
+    std::thread emitter2([&sgnl] { sgnl(4); });
+    emitter2.join();
+    if (AFFINE_THREADS.size() != 4 || !owner.empty())
+    {
+        std::cout << "affine reset test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Flattened signal-to-signal chain respects affinity of it's leaves
+    slib::signal<void(int)> root, middle;
+    root.set_flattening(true);
+    slib::connect(root, middle.to_slot());
+    affine.set_affinity(&owner);
+    slib::connect(middle, affine);
+    AFFINE_THREADS.clear();
+    std::thread emitter3([&root] { root(5); });
+    emitter3.join();
+    if (!AFFINE_THREADS.empty() || owner.wait(std::chrono::seconds(10)) != 1 || AFFINE_THREADS.size() != 1)
+    {
+        std::cout << "affine flattening test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+std::vector<int> QUEUED_VALUES;
+
+void queued_receiver(int _value)
+{
+    QUEUED_VALUES.push_back(_value);
+}
+
+bool test20()
+{
+    // Testing bounded queues of thread-affine slots
+
+    std::cout << std::endl;
+
+    struct policy_case
+    {
+        slib::overflow_policy policy;
+        std::vector<int>    expected;
+        unsigned long long   dropped;
+        unsigned long long coalesced;
+    };
+
+    const policy_case cases[] = {
+        {slib::overflow_policy::drop_newest, {0, 1, 2, 3}, 6, 0},
+        {slib::overflow_policy::drop_oldest, {6, 7, 8, 9}, 6, 0},
+        {slib::overflow_policy::coalesce,    {0, 1, 2, 9}, 0, 6}
+    };
+
+    slib::util::dispatcher owner;
+    slib::signal<void(int)> sgnl(true);
+
+    for (const auto& c : cases)
+    {
+        slib::slot<void(int)> slt(true);
+        slt.bind<queued_receiver>();
+        slt.set_affinity(&owner, 4, c.policy);
+        slib::connect(sgnl, slt);
+
+        QUEUED_VALUES.clear();
+        std::thread emitter([&sgnl] { for (int i = 0; i < 10; ++i) sgnl(i); });
+        emitter.join();
+
+        const auto stats = slt.queue_statistics();
+        if (stats.size != 4 || stats.dropped != c.dropped || stats.coalesced != c.coalesced)
+        {
+            std::cout << "queue counters test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        owner.process();
+        if (QUEUED_VALUES != c.expected || slt.queue_statistics().delivered != 4)
+        {
+            std::cout << "queue overflow policy test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    // Blocking policy delivers everything in order
+    const int number = 1000;
+    slib::slot<void(int)> slt(true);
+    slt.bind<queued_receiver>();
+    slt.set_affinity(&owner, 8, slib::overflow_policy::block);
+    slib::connect(sgnl, slt);
+
+    QUEUED_VALUES.clear();
+    std::thread emitter([&sgnl] { for (int i = 0; i < number; ++i) sgnl(i); });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (QUEUED_VALUES.size() != number && std::chrono::steady_clock::now() < deadline)
+    {
+        owner.wait(std::chrono::milliseconds(10));
+    }
+    emitter.join();
+
+    for (int i = 0; i < number; ++i)
+    {
+        if (QUEUED_VALUES.size() != number || QUEUED_VALUES[i] != i)
+        {
+            std::cout << "queue block policy test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    if (slt.queue_statistics().dropped != 0 || slt.queue_statistics().delivered != number)
+    {
+        std::cout << "queue block counters test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Emitter waiting for full queue does not hold signal's mutex: owner thread can emit the same signal
+    slib::slot<void(int)> single(true);
+    single.bind<queued_receiver>();
+    single.set_affinity(&owner, 1, slib::overflow_policy::block);
+    slib::signal<void(int)> shared(true);
+    slib::connect(shared, single);
+
+    QUEUED_VALUES.clear();
+    std::thread waiting([&shared] { shared(1); shared(2); });
+    const auto waits_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (single.queue_statistics().waits == 0 && std::chrono::steady_clock::now() < waits_deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    shared(3); // invoked directly on owner thread
+    owner.process();
+    waiting.join();
+    owner.process();
+
+    const std::vector<int> expected = {3, 1, 2};
+    if (QUEUED_VALUES != expected || single.queue_statistics().waits != 1 || single.queue_statistics().delivered != 2)
+    {
+        std::cout << "queue block deadlock test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> COALESCED_VALUES;
+
+void coalesced_receiver(const std::string& _value)
+{
+    COALESCED_VALUES.push_back(_value);
+}
+
+bool test21()
+{
+    // Testing coalescing signal
+
+    std::cout << std::endl;
+
+    slib::coalescing_signal<void(const std::string&)> sgnl;
+    slib::slot<void(const std::string&)> slt;
+    slt.bind<coalesced_receiver>();
+    sgnl.connect(slt);
+
+    // Explicit flush delivers only the latest value
+    COALESCED_VALUES.clear();
+    for (int i = 0; i < 100; ++i)
+    {
+        sgnl(std::to_string(i));
+    }
+
+    if (!COALESCED_VALUES.empty() || !sgnl.flush() || sgnl.flush() || COALESCED_VALUES != std::vector<std::string> {"99"} ||
+        sgnl.coalesced() != 99)
+    {
+        std::cout << "coalescing flush test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Dispatcher delivers once per iteration
+    slib::util::dispatcher loop;
+    sgnl.set_dispatcher(&loop);
+    COALESCED_VALUES.clear();
+    sgnl(std::string("a"));
+    sgnl(std::string("b"));
+    if (loop.process() != 1 || loop.process() != 0 || sgnl.pending())
+    {
+        std::cout << "coalescing dispatcher test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    sgnl(std::string("c"));
+    loop.process();
+    if (COALESCED_VALUES != std::vector<std::string> {"b", "c"})
+    {
+        std::cout << "coalescing dispatcher test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    // Time window delivers pending emission after it has expired
+    sgnl.set_dispatcher(nullptr);
+    sgnl.set_window(std::chrono::milliseconds(20));
+    COALESCED_VALUES.clear();
+    sgnl(std::string("x"));
+    sgnl(std::string("y"));
+    if (sgnl.poll() || !COALESCED_VALUES.empty())
+    {
+        std::cout << "coalescing window test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    sgnl(std::string("z")); // window has expired: delivered immediately
+    if (COALESCED_VALUES != std::vector<std::string> {"z"} || sgnl.pending())
+    {
+        std::cout << "coalescing window test failed. // LINE = " << __LINE__ << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+struct test_timer : public slib::util::timer_node
+{
+    slib::util::timer_wheel*            wheel;
+    slib::util::timer_wheel::clock_type::time_point expected;
+    int                                 fired;
+
+    test_timer() : slib::util::timer_node(&test_timer::expire), wheel(nullptr), fired(0)
+    {
+    }
+
+    static void expire(slib::util::timer_node* _timer)
+    {
+        test_timer* that = static_cast<test_timer*>(_timer);
+        if (that->wheel->time() == that->expected)
+        {
+            ++that->fired;
+        }
+        else
+        {
+            that->fired = -1000; // expired at wrong time
+        }
+    }
+};
+
+std::vector<int> RATE_LIMITED_VALUES;
+
+void rate_limited_receiver(int _value)
+{
+    RATE_LIMITED_VALUES.push_back(_value);
+}
+
+bool test22()
+{
+    // Testing timer wheel, throttled and debounced signals
+
+    std::cout << std::endl;
+
+    typedef slib::util::timer_wheel::clock_type clock_type;
+
+    // Timers of all levels expire exactly at their ticks (time is driven manually)
+    {
+        slib::util::timer_wheel wheel(std::chrono::milliseconds(1));
+        const clock_type::time_point start = wheel.time();
+
+        const int number = 2000;
+        std::vector<test_timer> timers(number);
+        for (int i = 0; i < number; ++i)
+        {
+            const long long delay = i % 100 == 0 ? 20000000LL + i : 1 + (i * 7919LL) % 300000;
+            timers[i].wheel = &wheel;
+            timers[i].expected = start + std::chrono::milliseconds(delay);
+            wheel.schedule(&timers[i], timers[i].expected);
+        }
+
+        for (int i = 0; i < number; i += 10)
+        {
+            wheel.cancel(&timers[i]);
+        }
+
+        size_t expired = 0;
+        for (long long t = 0; t <= 20003000LL; t += 1 + t / 7)
+        {
+            expired += wheel.advance(start + std::chrono::milliseconds(t));
+        }
+        expired += wheel.advance(start + std::chrono::milliseconds(20003000LL));
+
+        for (int i = 0; i < number; ++i)
+        {
+            if (timers[i].fired != (i % 10 == 0 ? 0 : 1))
+            {
+                std::cout << "timer wheel test failed. // LINE = " << __LINE__ << std::endl;
+                return false;
+            }
+        }
+
+        if (expired != number - number / 10 || wheel.size() != 0)
+        {
+            std::cout << "timer wheel counters test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    slib::util::timer_wheel wheel(std::chrono::milliseconds(1));
+    slib::slot<void(int)> slt;
+    slt.bind<rate_limited_receiver>();
+
+    // Throttle: leading emission is delivered immediately, the latest one - at the end of interval
+    {
+        slib::signal<void(int)> source;
+        slib::throttled_signal<void(int)> throttled(wheel, std::chrono::milliseconds(200));
+        slib::connect(source, throttled.input());
+        throttled.connect(slt);
+
+        RATE_LIMITED_VALUES.clear();
+        for (int i = 0; i < 10; ++i)
+        {
+            source(i);
+        }
+
+        wheel.advance();
+        if (RATE_LIMITED_VALUES != std::vector<int> {0} || !throttled.pending() || throttled.suppressed() != 8)
+        {
+            std::cout << "throttle leading edge test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        if (wheel.advance() != 1 || RATE_LIMITED_VALUES != std::vector<int> {0, 9} || throttled.pending())
+        {
+            std::cout << "throttle trailing edge test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    // Debounce: only the latest emission is delivered after quiet period
+    {
+        slib::debounced_signal<void(int)> debounced(wheel, std::chrono::milliseconds(100));
+        debounced.connect(slt);
+
+        RATE_LIMITED_VALUES.clear();
+        debounced(1);
+        debounced(2);
+        wheel.advance();
+        if (!RATE_LIMITED_VALUES.empty())
+        {
+            std::cout << "debounce test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        wheel.advance();
+        if (RATE_LIMITED_VALUES != std::vector<int> {2} || debounced.pending() || wheel.size() != 0)
+        {
+            std::cout << "debounce delivery test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+typedef slib::timer_scheduler::clock_type::time_point timer_time;
+
+std::atomic<int> TIMER_TICKS(0);
+std::vector<timer_time> TIMER_TIMES;
+std::thread::id TIMER_THREAD;
+
+void timer_tick()
+{
+    TIMER_THREAD = std::this_thread::get_id(); // published by TIMER_TICKS increment
+    ++TIMER_TICKS;
+}
+
+void timer_expired(timer_time _time)
+{
+    TIMER_TIMES.push_back(_time);
+    TIMER_THREAD = std::this_thread::get_id();
+}
+
+std::atomic<int> SCHEDULED_VALUE(0);
+std::thread::id SCHEDULED_THREAD;
+
+void scheduled_receiver(int _value)
+{
+    SCHEDULED_THREAD = std::this_thread::get_id(); // published by SCHEDULED_VALUE assignment
+    SCHEDULED_VALUE = _value;
+}
+
+bool test23()
+{
+    // Testing timer signals
+
+    std::cout << std::endl;
+
+    slib::slot<void()> tick_slot;
+    tick_slot.bind<timer_tick>();
+
+    slib::slot<void(timer_time)> time_slot;
+    time_slot.bind<timer_expired>();
+
+    // Polling: periodic timer expires every period, stopped timer does not expire
+    {
+        slib::timer_scheduler scheduler(std::chrono::milliseconds(1));
+        slib::timer_signal<> periodic(scheduler);
+        periodic.connect(tick_slot);
+
+        TIMER_TICKS = 0;
+        const timer_time periodic_started = slib::timer_scheduler::clock_type::now();
+        periodic.start(std::chrono::milliseconds(20));
+        std::this_thread::sleep_for(std::chrono::milliseconds(110));
+
+        // Wheel is advanced to fixed time, so oversleeping does not add expiries
+        if (scheduler.poll(periodic_started + std::chrono::milliseconds(110)) != 5 || TIMER_TICKS != 5 || !periodic.active())
+        {
+            std::cout << "periodic timer test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        periodic.stop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        if (scheduler.poll() != 0 || TIMER_TICKS != 5 || periodic.active() || scheduler.wheel().size() != 0)
+        {
+            std::cout << "stopped timer test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        // Single shot timer emits it's due time
+        slib::timer_signal<void(timer_time)> once(scheduler);
+        once.connect(time_slot);
+
+        TIMER_TIMES.clear();
+        const timer_time started = slib::timer_scheduler::clock_type::now();
+        once.start_once(std::chrono::milliseconds(5));
+        if (scheduler.next_expiry() < started + std::chrono::milliseconds(5))
+        {
+            std::cout << "next expiry test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        scheduler.poll();
+        scheduler.poll();
+        if (TIMER_TIMES.size() != 1 || TIMER_TIMES[0] < started + std::chrono::milliseconds(5) || TIMER_TIMES[0] > started + std::chrono::milliseconds(20) || once.active())
+        {
+            std::cout << "single shot timer test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    // Scheduler thread: timer without dispatcher expires on scheduler thread, timer with dispatcher - on owner thread
+    {
+        slib::timer_scheduler scheduler(std::chrono::milliseconds(1), true);
+        slib::util::dispatcher owner;
+
+        slib::timer_signal<> worker_timer(scheduler, true);
+        worker_timer.connect(tick_slot);
+
+        slib::timer_signal<void(timer_time)> owner_timer(scheduler, true);
+        owner_timer.connect(time_slot);
+        owner_timer.set_dispatcher(&owner);
+
+        if (!scheduler.start())
+        {
+            std::cout << "scheduler start test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        TIMER_TICKS = 0;
+        worker_timer.start_once(std::chrono::milliseconds(10));
+        for (int i = 0; i < 100 && TIMER_TICKS == 0; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        if (TIMER_TICKS != 1 || TIMER_THREAD == std::this_thread::get_id())
+        {
+            std::cout << "scheduler thread test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        TIMER_TIMES.clear();
+        owner_timer.start(std::chrono::milliseconds(5));
+        for (int i = 0; i < 100 && TIMER_TIMES.size() < 3; ++i)
+        {
+            owner.wait(std::chrono::milliseconds(10));
+        }
+
+        owner_timer.stop();
+        scheduler.stop();
+        owner.process();
+
+        if (TIMER_TIMES.size() < 3 || TIMER_THREAD != std::this_thread::get_id())
+        {
+            std::cout << "dispatcher timer test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        for (size_t i = 1; i < TIMER_TIMES.size(); ++i)
+        {
+            if (TIMER_TIMES[i] - TIMER_TIMES[i - 1] < std::chrono::milliseconds(5))
+            {
+                std::cout << "dispatcher timer period test failed. // LINE = " << __LINE__ << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // Rate limiters sharing scheduler's wheel wake sleeping scheduler thread, which delivers their emissions
+    {
+        slib::timer_scheduler scheduler(std::chrono::milliseconds(1), true);
+        scheduler.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20)); // scheduler thread sleeps on empty wheel
+
+        slib::slot<void(int)> receiver;
+        receiver.bind<scheduled_receiver>();
+
+        slib::debounced_signal<void(int)> debounced(scheduler.wheel(), std::chrono::milliseconds(10), true);
+        debounced.connect(receiver);
+
+        SCHEDULED_VALUE = 0;
+        debounced(42);
+        for (int i = 0; i < 100 && SCHEDULED_VALUE == 0; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        if (SCHEDULED_VALUE != 42 || SCHEDULED_THREAD == std::this_thread::get_id() || debounced.pending())
+        {
+            std::cout << "debounced signal on scheduler thread test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        slib::throttled_signal<void(int)> throttled(scheduler.wheel(), std::chrono::milliseconds(50), true);
+        throttled.connect(receiver);
+
+        throttled(1); // leading edge is delivered immediately
+        throttled(2);
+        if (SCHEDULED_VALUE != 1 || SCHEDULED_THREAD != std::this_thread::get_id())
+        {
+            std::cout << "throttled signal leading edge test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        for (int i = 0; i < 100 && SCHEDULED_VALUE == 1; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        if (SCHEDULED_VALUE != 2 || SCHEDULED_THREAD == std::this_thread::get_id() || throttled.pending())
+        {
+            std::cout << "throttled signal trailing edge test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        scheduler.stop();
+    }
+
+    // Rate limiter may be destroyed while scheduler thread delivers it
+    {
+        slib::timer_scheduler scheduler(std::chrono::milliseconds(1), true);
+        scheduler.start();
+
+        for (int i = 0; i < 20; ++i)
+        {
+            slib::debounced_signal<void(int)> debounced(scheduler.wheel(), std::chrono::milliseconds(1), true);
+            debounced(i);
+            std::this_thread::sleep_for(std::chrono::milliseconds(i % 3));
+        }
+
+        scheduler.stop();
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+int FUTURE_CONTINUATION = 0;
+std::atomic<int> FUTURE_EMISSIONS(0);
+
+int future_square(int _value)
+{
+    return _value * _value;
+}
+
+void future_continuation(const int& _result)
+{
+    FUTURE_CONTINUATION = _result;
+}
+
+void future_emitted(int _value)
+{
+    FUTURE_EMISSIONS += _value;
+}
+
+bool test24()
+{
+    // Testing futures of queued invocations
+
+    std::cout << std::endl;
+
+    slib::slot<int(int)> square;
+    square.bind<future_square>();
+
+    // Invocation on thread pool
+    {
+        slib::util::thread_pool pool(2);
+
+        std::vector<slib::future<int> > results;
+        for (int i = 0; i < 100; ++i)
+        {
+            results.push_back(square.post(pool, i));
+        }
+
+        for (int i = 0; i < 100; ++i)
+        {
+            slib::future<int> copy = results[i];
+            if (copy.get() != i * i || !results[i].ready())
+            {
+                std::cout << "thread pool future test failed. // LINE = " << __LINE__ << std::endl;
+                return false;
+            }
+        }
+
+        slib::signal<void(int)> sig;
+        slib::slot<void(int)> emitted;
+        emitted.bind<future_emitted>();
+        sig.connect(emitted);
+        sig.connect(emitted);
+
+        FUTURE_EMISSIONS = 0;
+        slib::future<void> done = sig.post(pool, 5);
+        done.wait();
+        if (FUTURE_EMISSIONS != 10 || !done.try_get())
+        {
+            std::cout << "signal post test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        // Exception of invoked slot completes the future and is rethrown by get(), continuation is skipped
+        slib::slot<int(int)> thrower;
+        thrower.bind<throwing_function>();
+
+        FUTURE_CONTINUATION = 0;
+        slib::delegate<void(const int&)> continuation;
+        continuation.bind<future_continuation>();
+
+        for (int i = 1; i <= 100; ++i)
+        {
+            slib::future<int> failed = thrower.post(pool, i);
+            failed.then(continuation);
+
+            int thrown = 0;
+            try
+            {
+                failed.get();
+            }
+            catch (int _value)
+            {
+                thrown = _value;
+            }
+
+            if (thrown != i || !failed.ready() || FUTURE_CONTINUATION != 0)
+            {
+                std::cout << "throwing future test failed. // LINE = " << __LINE__ << std::endl;
+                return false;
+            }
+        }
+
+        int thrown = 0;
+        slib::future<int> immediate = thrower.invoke_async(7);
+        try
+        {
+            int result = 0;
+            immediate.try_get(result);
+        }
+        catch (int _value)
+        {
+            thrown = _value;
+        }
+
+        immediate.then(continuation);
+        if (thrown != 7 || FUTURE_CONTINUATION != 0)
+        {
+            std::cout << "immediate throwing future test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    // Invocation on owner thread of thread-affine slot
+    {
+        slib::util::dispatcher owner;
+        square.set_affinity(&owner);
+
+        slib::future<int> immediate = square.invoke_async(4);
+        int result = 0;
+        if (!immediate.try_get(result) || result != 16)
+        {
+            std::cout << "owner thread future test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        slib::future<int> queued;
+        std::thread worker([&square, &queued]() { queued = square.invoke_async(3); });
+        worker.join();
+
+        FUTURE_CONTINUATION = 0;
+        slib::delegate<void(const int&)> continuation;
+        continuation.bind<future_continuation>();
+        queued.then(continuation);
+
+        if (queued.ready() || queued.try_get(result) || queued.wait_for(std::chrono::milliseconds(1)) || FUTURE_CONTINUATION != 0)
+        {
+            std::cout << "queued future test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        owner.process();
+        if (!queued.try_get(result) || result != 9 || FUTURE_CONTINUATION != 9)
+        {
+            std::cout << "queued future result test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+
+        // continuation of finished invocation is invoked immediately
+        FUTURE_CONTINUATION = 0;
+        immediate.then(continuation);
+        square.set_affinity(nullptr);
+
+        if (FUTURE_CONTINUATION != 16)
+        {
+            std::cout << "ready future continuation test failed. // LINE = " << __LINE__ << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 
@@ -174,12 +2548,34 @@ typedef bool(*pTest)();
 
 const pTest tests[] = {
     test1,
-    test2
+    test2,
+    test3,
+    test4,
+    test5,
+    test6,
+    test7,
+    test8,
+    test9,
+    test10,
+    test11,
+    test12,
+    test13,
+    test14,
+    test15,
+    test16,
+    test17,
+    test18,
+    test19,
+    test20,
+    test21,
+    test22,
+    test23,
+    test24
 };
 
 //////////////////////////////////////////////////////////////////////////
 
-int main()
+int main(int argc, char* argv[])
 {
     std::cout << "Begin testing...\n";
 
@@ -206,10 +2602,15 @@ int main()
         std::cout << std::endl;
     }
 
-    std::cout << "Testing complete.\nInput something to exit: ";
+    std::cout << "Testing complete.\n";
 
-    char c = 0;
-    std::cin >> c;
+    // Interactive run waits for input, "--no-wait" is used by ctest
+    if (argc < 2 || std::string(argv[1]) != "--no-wait")
+    {
+        std::cout << "Input something to exit: ";
+        char c = 0;
+        std::cin >> c;
+    }
 
-    return 0;
+    return result;
 }